@@ -29,6 +29,12 @@
 // second option is used.
 #define __BVH_DIVISION_BY_GEOMETRIC_CENTER__
 
+// The shading and sampling code evaluates pow, exp, sin and cos by the
+// standard functions. To use the faster polynomial approximations instead,
+// define __FAST_SHADING_MATH__, see utility/shading_math.hpp for their
+// accuracy. "make fastmath" builds with them for comparison.
+//#define __FAST_SHADING_MATH__
+
 //--------------------------------------------------------------------------//
 // configurable variables
 //--------------------------------------------------------------------------//
@@ -36,12 +42,37 @@
 #define AIR_REFRACTION_INDEX 1.f
 #define RAY_TRANSLATION_EPSILON 0.001f
 #define DEFAULT_SHADOW_RAY_EPSILON "0.001"
+#define SHADOW_RAY_BATCH_SIZE 4096 // per thread, when the shadow rays are batched, see <ShadowRays>
+#define WAVEFRONT_BATCH_SIZE 64 // pixels traced together per thread, see <RenderingOrder>
 #define DEFAULT_BACKGROUND_COLOR "0 0 0"
 #define DEFAULT_MAXRECURSIONDEPTH "1"
+#define DEFAULT_RUSSIAN_ROULETTE_DEPTH "3" // bounces before russian roulette, path tracing only
 #define DEFAULT_SHADING_MODE ShadingMode::FLAT
 #define BACKFACE_CULLING
 //#define SEEDED_RANDOMIZATION
 #define DEFAULT_RANDOM_FACTOR RandomFactor::UNIFORM
 #define SPHERE_UNIFORM_SAMPLING_PROP (M_1_PI * 0.5f) // const for sphere
-//#define ENV_MAP_SHADOW_CHECK
+#define DEFAULT_ENV_MAP_SHADOW_CHECK false // occlusion of the environment light samples, see <ShadowCheck>
+
+// checkpointing, see RenderCheckpoint
+#define CHECKPOINT_FILE_EXTENSION ".ckpt"
+#define DEFAULT_CHECKPOINT_INTERVAL 300 // seconds
+#define CHECKPOINT_RANDOM_SEED 1
+#define CHECKPOINT_CHECK_PERIOD 256 // recorded pixels between the checks of the interval
+
+// partial rendering, see PartialImage
+#define PARTIAL_IMAGE_FILE_EXTENSION ".part"
+#define DEFAULT_TILE_SIZE 64
+
+// distributed rendering, see Scene::coordinateRenderWorkers
+#define TILE_STALL_REPORT_INTERVAL 60 // seconds a tile of a worker takes before it is reported
+#define RENDER_MESSAGE_TIMEOUT 10 // seconds a message of a worker takes to arrive once it begins
+#define WORKER_RESPAWN_LIMIT 3 // times a dead worker is replaced by a new one
+
+// caching the loaded meshes, see SceneCache
+#define SCENE_CACHE_FILE_EXTENSION ".rtcache"
+
+// the tiled images of the textures, see TextureCache
+#define TEXTURE_CACHE_FILE_EXTENSION ".rttex"
+#define TEXTURE_TILE_SIZE 64 // texels of the side of a tile
 #endif
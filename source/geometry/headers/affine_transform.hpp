@@ -0,0 +1,114 @@
+#ifndef __AFFINE_TRANSFORM_H__
+#define __AFFINE_TRANSFORM_H__
+
+#include "position3.hpp"
+#include "vector3.hpp"
+#include "ray.hpp"
+#include "matrix4.hpp"
+
+// an affine transformation, the first three rows of its 4x4 matrix, the last
+// .. row is always (0, 0, 0, 1)
+class AffineTransform
+{
+    private:
+        float m[3][4];
+
+    public:
+        // identity
+        AffineTransform()
+            : m{ { 1.f, 0.f, 0.f, 0.f },
+                 { 0.f, 1.f, 0.f, 0.f },
+                 { 0.f, 0.f, 1.f, 0.f } } {}
+
+        AffineTransform(const Matrix4 & matrix)
+        {
+            for(int i = 0; i < 3; i++)
+                for(int j = 0; j < 4; j++)
+                    m[i][j] = matrix.getEl(i, j);
+        }
+
+        float getEl(int row, int column) const { return m[row][column]; }
+
+        Position3 operator*(const Position3 & rhs) const
+        {
+            float x = rhs.getX(), y = rhs.getY(), z = rhs.getZ();
+
+            return Position3(
+                m[0][0] * x + m[0][1] * y + m[0][2] * z + m[0][3],
+                m[1][0] * x + m[1][1] * y + m[1][2] * z + m[1][3],
+                m[2][0] * x + m[2][1] * y + m[2][2] * z + m[2][3]
+            );
+        }
+
+        Vector3 operator*(const Vector3 & rhs) const
+        {
+            float x = rhs.getX(), y = rhs.getY(), z = rhs.getZ();
+
+            return Vector3(
+                m[0][0] * x + m[0][1] * y + m[0][2] * z,
+                m[1][0] * x + m[1][1] * y + m[1][2] * z,
+                m[2][0] * x + m[2][1] * y + m[2][2] * z
+            );
+        }
+
+        // the direction is not normalized, so that a point of the ray has the
+        // .. same parameter t before and after the transformation
+        Ray operator*(const Ray & rhs) const
+        {
+            Ray result = rhs;
+
+            result.setOrigin(*this * rhs.getOrigin());
+            result.setUnnormalizedDirection(*this * rhs.getDirection());
+
+            return result;
+        }
+
+        // rhs is applied first
+        AffineTransform operator*(const AffineTransform & rhs) const
+        {
+            AffineTransform result;
+
+            for(int i = 0; i < 3; i++)
+            {
+                for(int j = 0; j < 4; j++)
+                {
+                    result.m[i][j] =
+                        m[i][0] * rhs.m[0][j] +
+                        m[i][1] * rhs.m[1][j] +
+                        m[i][2] * rhs.m[2][j] +
+                        (j == 3 ? m[i][3] : 0.f);
+                }
+            }
+
+            return result;
+        }
+
+        // transpose of the linear part, without translation
+        AffineTransform getLinearTranspose() const
+        {
+            AffineTransform result;
+
+            for(int i = 0; i < 3; i++)
+                for(int j = 0; j < 3; j++)
+                    result.m[i][j] = m[j][i];
+
+            return result;
+        }
+
+        float getLinearDeterminant() const
+        {
+            return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+                 - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+                 + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+        }
+
+        // translation applied after this transformation
+        void translate(const Vector3 & translation)
+        {
+            m[0][3] += translation.getX();
+            m[1][3] += translation.getY();
+            m[2][3] += translation.getZ();
+        }
+};
+
+#endif
@@ -55,7 +55,29 @@ class AreaLight : public Light
             return PointLight(randomPositionInsideArea, attenuatedIntensity);
         }
 
-        virtual IncidentLight getIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const;
+        virtual IncidentLight sampleIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const;
+
+        // emitted from both sides, attenuated by the angle made with normal
+        virtual float getPower() const { return 2 * M_PI * this->intensity.getAverage(); }
+        virtual bool getBounds(Position3& minPosition, Position3& maxPosition) const
+        {
+            Position3 corners[4] = {
+                this->position,
+                this->position + edgeVectors[0],
+                this->position + edgeVectors[1],
+                this->position + edgeVectors[0] + edgeVectors[1]
+            };
+
+            minPosition = maxPosition = corners[0];
+
+            for(int i = 1; i < 4; i++)
+            {
+                minPosition = Position3::generateMinPosition(minPosition, corners[i]);
+                maxPosition = Position3::generateMaxPosition(maxPosition, corners[i]);
+            }
+
+            return true;
+        }
 };
 
 #endif
\ No newline at end of file
@@ -9,22 +9,37 @@
 #include "transformation.hpp"
 
 #include <vector>
+#include <cstdint>
 
 // bounding volume
 class BoundingVolume : public Shape
 {
+    friend class CompiledBVH;
+
     private:
         Shape *leftNode, *rightNode;
 
         // to be improved by making use of shared_ptr
         bool ownsChildren = false;
         
+        // leftSizes, if given, records the number of shapes of the left node
+        // .. of each bounding volume, in preorder
         static Shape* createBoundingVolumeHiearchy(
             std::vector<Shape*> &shapes,  // surfaces
             int firstInd, int numOfSurfaces,  // indices of first and last, used to determine the surfaces to consider
-            Axis divisionAxis
+            Axis divisionAxis,
+            std::vector<int32_t>* leftSizes
+        );
+
+        static Shape* createBoundingVolumeHiearchy(
+            std::vector<Shape*> &shapes,
+            int firstInd, int numOfShapes,
+            const int32_t* &leftSizes, const int32_t* leftSizesEnd
         );
 
+        // a bounding volume enclosing the nodes, at least one of which is given
+        static BoundingVolume* createParentOf(Shape* leftNode, Shape* rightNode);
+
         static Axis nextDivisionAxis(Axis currentAxis);
 
         static int partitionShapesIntoTwo(
@@ -45,13 +60,26 @@ class BoundingVolume : public Shape
         // returned pointer of the method and, somehow, copying it
         static Shape* createBoundingVolumeHiearchy(std::vector<Shape*> &shapes);
 
+        // leaves the shapes in the order of the leaves and returns the layout
+        // .. of the hiearchy in leftSizes, see SceneCache
+        static Shape* createBoundingVolumeHiearchy(std::vector<Shape*> &shapes, std::vector<int32_t> &leftSizes);
+
+        // the hiearchy of the given layout, the shapes are in the order of
+        // .. its leaves
+        static Shape* createBoundingVolumeHiearchy(std::vector<Shape*> &shapes, const int32_t* leftSizes, int numberOfSplits);
+
         static BoundingVolume* makeInstanceOf(BoundingVolume* toBeInstanced);
         
         bool hit(const Ray & ray, HitInfo & hitInfo, bool backfaceCulling, bool opaqueSearch) const;
 
+        // stops at the first child occluding the ray
+        bool isOccluding(const Ray & ray, float maxT, bool backfaceCulling) const;
+
         virtual ~BoundingVolume();
 
         virtual Position3 getUniformPoint() const;
+
+        virtual void appendTriangleVertices(std::vector<Position3>& vertices) const;
         
 };
 
@@ -3,9 +3,9 @@
 
 #include "light.hpp"
 #include "vector3.hpp"
+#include "../../image/color.hpp"
 
 class Ray;
-class Color;
 struct HitInfo;
 
 class BRDF
@@ -20,26 +20,48 @@ class BRDF
             BLINNPHONG_MODIFIED,
             TORRANCE_SPARROW
         };
-    
+
+        // reflected light of an incident light, each mode (and normalization)
+        // .. has its own kernel, selected when the mode is set
+        typedef Color (*Kernel)(const Ray & ray, const HitInfo & hitInfo, const IncidentLight& incidentLight);
+
+        // reflected light of count incident lights at the same hit
+        typedef void (*BatchKernel)(const Ray & ray, const HitInfo & hitInfo, const IncidentLight* incidentLights, Color* colors, int count);
+
+    BRDF() { selectKernels(); }
+
     void setExponent(float exponent) { this->exponent = exponent; }
     float getExponent() const { return this->exponent; }
 
     void setRefractiveIndex(float refractiveIndex) { this->refractiveIndex = refractiveIndex; }
     float getRefractiveIndex() const { return this->refractiveIndex; }
     
-    void setNormalized(bool normalized) { this->normalized = normalized; }
+    void setNormalized(bool normalized) { this->normalized = normalized; selectKernels(); }
     bool isNormalized() const { return this->normalized; }
 
-    void setMode(Mode mode) { this->mode = mode; }
+    void setMode(Mode mode) { this->mode = mode; selectKernels(); }
     Mode getMode() const { return this->mode; }
 
-    Color computeReflectedLight(const Ray & ray, const HitInfo & hitInfo, const IncidentLight& incidentLight) const;
+    Color computeReflectedLight(const Ray & ray, const HitInfo & hitInfo, const IncidentLight& incidentLight) const
+    {
+        return this->kernel(ray, hitInfo, incidentLight);
+    }
+
+    void computeReflectedLight(const Ray & ray, const HitInfo & hitInfo, const IncidentLight* incidentLights, Color* colors, int count) const
+    {
+        this->batchKernel(ray, hitInfo, incidentLights, colors, count);
+    }
 
     private:
         float exponent;
         float refractiveIndex; // applicable only if TorranceSparrow - search for a better design choice
         bool normalized = false;
-        Mode mode;
+        Mode mode = DEFAULT;
+
+        Kernel kernel;
+        BatchKernel batchKernel;
+
+        void selectKernels();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,164 @@
+#ifndef __COMPILED_BVH_H__
+#define __COMPILED_BVH_H__
+
+#include "shape.hpp"
+#include "triangle.hpp"
+#include "sphere.hpp"
+#include "material.hpp"
+#include "texture.hpp"
+#include "light.hpp"
+#include "position3.hpp"
+#include "structs.hpp"
+#include "ray.hpp"
+
+#include <cstddef>
+
+// the bounding volume hiearchy of the scene compiled into an arena, a single
+// .. block holding the arrays that are read while rendering, and freed with it
+//
+// The bounding volumes without a transformation or motion blur, e.g. the ones
+// .. of the meshes that are not instanced, are dissolved into the hiearchy, so
+// .. that their shapes are its primitives, and so are the meshes of the light
+// .. meshes. The triangles and the spheres without a transformation or motion
+// .. blur are copied into the arena with their materials and the handles of
+// .. their textures, and are hit without calling the shapes. The rest of the
+// .. shapes, e.g. the instances, are primitives as they are.
+class CompiledBVH
+{
+    public:
+        struct Node
+        {
+            Position3 minPosition, maxPosition;
+
+            // the left child of an inner node is the next node, index is its
+            // .. right child. index of a leaf is its primitive
+            int index;
+
+            // axis along which the children are visited in the order of the
+            // .. ray direction, -1 for a leaf
+            int axis;
+        };
+
+        // the indices are into the arrays of the arena, -1 for none
+        struct Primitive
+        {
+            enum Type
+            {
+                TRIANGLE,
+                SPHERE,
+                SHAPE
+            };
+
+            Type type;
+
+            // into the triangles, the spheres or the shapes, by the type
+            int index;
+
+            // of the triangle or the sphere itself
+            int material;
+
+            // material of the dissolved bounding volume enclosing the shape,
+            // .. if any, which replaces the material of its hits
+            int overridingMaterial;
+
+            // of the triangle or the sphere
+            int texture;
+
+            // the light the hits are on, which is not opaque
+            int light;
+        };
+
+        struct TextureHandle
+        {
+            const ImageTexture* imageTexture;
+            const PerlinTexture* perlinTexture;
+        };
+
+        struct LightRecord
+        {
+            Vector3 radiance;
+            const Light* light;
+        };
+
+        // the arrays of a hiearchy of triangles alone, e.g. of a mesh, which
+        // .. describe it without the shapes, see SceneCache
+        struct MeshArrays
+        {
+            const Node* nodes;
+            const Primitive* primitives;
+            const CompiledTriangle* triangles;
+
+            int numberOfNodes;
+            int numberOfPrimitives;
+            int numberOfTriangles;
+            int maxDepth;
+        };
+
+    private:
+        // the arrays while they are built, see compile()
+        struct Builder;
+
+        char* arena = nullptr;
+        size_t arenaSize = 0;
+
+        // in the arena, or in place in the memory of the caller, see
+        // .. compileMesh()
+        const Node* nodes = nullptr;
+        const Primitive* primitives = nullptr;
+        const CompiledTriangle* triangles = nullptr;
+        const CompiledSphere* spheres = nullptr;
+        const Material* materials = nullptr;
+        const TextureHandle* textures = nullptr;
+        const LightRecord* lights = nullptr;
+        const Shape* const* shapes = nullptr;
+
+        int numberOfNodes = 0;
+        int numberOfPrimitives = 0;
+        int numberOfTriangles = 0;
+
+        int maxDepth = 0;
+
+        // appends the nodes of the shape, returns the index of its first node
+        static int compileNode(Builder& builder, const Shape* shape, int material, int light, int depth);
+
+        static int addMaterial(Builder& builder, const Material* material);
+        static int addTexture(Builder& builder, const ImageTexture* imageTexture, const PerlinTexture* perlinTexture);
+
+        void clear();
+
+    public:
+        CompiledBVH() { }
+        ~CompiledBVH() { clear(); }
+
+        // the arena is freed by the one holding it
+        CompiledBVH(const CompiledBVH&) = delete;
+        CompiledBVH& operator=(const CompiledBVH&) = delete;
+
+        void compile(const Shape* root);
+
+        // the hiearchy of the arrays of a mesh, which are read in place and
+        // .. kept by the caller, e.g. mapped from the scene cache. the arena
+        // .. holds the material and the texture of its triangles, which are
+        // .. the ones of the compiled mesh the arrays are of, if it had them
+        void compileMesh(const MeshArrays& mesh, const Material* material, const Texture* texture);
+
+        bool isEmpty() const { return this->numberOfNodes == 0; }
+        int getNumberOfNodes() const { return this->numberOfNodes; }
+        int getNumberOfPrimitives() const { return this->numberOfPrimitives; }
+
+        // whether the primitives are the triangles alone, in their order, so
+        // .. that the hiearchy is described by its mesh arrays
+        bool isTriangleMesh() const { return this->numberOfTriangles == this->numberOfPrimitives; }
+        MeshArrays getMeshArrays() const;
+
+        // in bytes, of the arena
+        size_t getSize() const { return this->arenaSize; }
+
+        // the closest hit of the ray
+        bool hit(const Ray & ray, HitInfo & hitInfo, bool backfaceCulling, bool opaqueSearch) const;
+
+        // whether the ray hits any opaque primitive closer than maxT
+        bool isOccluding(const Ray & ray, float maxT, bool backfaceCulling) const;
+};
+
+#endif
@@ -27,4 +27,30 @@ enum RandomFactor
     IMPORTANCE
 };
 
+// how the lights to sample at a hit are chosen, see LightSampler
+enum LightSampling
+{
+    ALL_LIGHTS,
+    POWER_LIGHT_SAMPLING,
+    BVH_LIGHT_SAMPLING
+};
+
+// order in which the paths of the pixels are traced
+//  - DEPTH_FIRST: each path to its end, one after another
+//  - WAVEFRONT: the paths of a batch of pixels together, a bounce at a time
+enum RenderingOrder
+{
+    DEPTH_FIRST,
+    WAVEFRONT
+};
+
+// kind of a bounce on a path, each kind has its own depth limit
+enum BounceType
+{
+    DIFFUSE_BOUNCE,
+    SPECULAR_BOUNCE,
+    TRANSMISSION_BOUNCE,
+    NUMBER_OF_BOUNCE_TYPES
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,135 @@
+#ifndef __GEOMETRY_CACHE_H__
+#define __GEOMETRY_CACHE_H__
+
+#include "shape.hpp"
+#include "enums.hpp"
+#include "texture.hpp"
+#include "compiled_bvh.hpp"
+#include "../../utility/scene_cache.hpp"
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+
+// the triangles of a cached mesh, in the order of the leaves of its hiearchy
+std::vector<Shape*> createCachedMeshTriangles(const SceneCache::Mesh& mesh, ShadingMode shadingMode, const Texture* texture);
+
+// Meshes loaded out of core, while rendering, see --out-of-core.
+//
+// A mesh is in the hiearchy of the scene only by its bounds, see LazyMesh.
+// .. Its compiled hiearchy is read in place from the mapped scene cache the
+// .. first time a ray enters the bounds, and the meshes are evicted, the least
+// .. recently used first, once the loaded ones take more memory than the
+// .. budget, by which their pages are dropped. The instances of a mesh share
+// .. it.
+//
+// A mesh is held by a Pin while a ray is traced through it, and is not deleted
+// .. while it is held: its eviction is undone instead, so that the budget may
+// .. be exceeded by the meshes in use. Holding a loaded mesh takes no lock.
+class GeometryCache
+{
+    public:
+        // the compiled hiearchy of a loaded mesh, over the scene cache
+        struct Geometry
+        {
+            CompiledBVH compiledBVH;
+
+            // of its arrays in the scene cache and its arena
+            size_t size = 0;
+        };
+
+    private:
+        struct Entry
+        {
+            int cachedMeshIndex;
+
+            // of the scene, with the material of each triangle if it is set
+            const Texture* texture = nullptr;
+            const Material* material = nullptr;
+
+            std::atomic<const Geometry*> geometry{ nullptr };
+
+            // the pins holding the mesh, and the ones finding it loaded
+            std::atomic<int> numberOfUsers{ 0 };
+            std::atomic<uint64_t> numberOfHits{ 0 };
+
+            // the clock when it was last used
+            std::atomic<uint64_t> lastUse{ 0 };
+
+            // the mesh is loaded by one thread, the others wait for it
+            std::mutex loadingMutex;
+        };
+
+        SceneCache sceneCache;
+        size_t budget;
+
+        // a deque, so that the entries are not moved when one is added
+        std::deque<Entry> entries;
+
+        // advanced by every load, so that the meshes used since the last load
+        // .. are the most recently used ones
+        std::atomic<uint64_t> clock{ 0 };
+
+        // the rest are guarded by the mutex
+        std::mutex mutex;
+        std::vector<Entry*> loadedEntries;
+        size_t loadedSize = 0;
+        size_t peakLoadedSize = 0;
+        uint64_t numberOfMisses = 0;
+        uint64_t numberOfEvictions = 0;
+
+        // loads the mesh unless another thread has loaded it meanwhile
+        const Geometry* load(Entry& entry);
+        Geometry* createGeometry(Entry& entry);
+
+        // evicts the least recently used meshes, except the given one, while
+        // .. the loaded ones are over the budget. called with the mutex locked
+        void evict(const Entry* keptEntry);
+
+    public:
+        // holds the geometry of a mesh, loading it if it is not loaded
+        class Pin
+        {
+            private:
+                Entry& entry;
+                const Geometry* geometry;
+
+            public:
+                Pin(GeometryCache& geometryCache, int meshIndex);
+                Pin(const Pin&) = delete;
+                Pin& operator=(const Pin&) = delete;
+                ~Pin() { entry.numberOfUsers--; }
+
+                const Geometry* operator->() const { return this->geometry; }
+        };
+
+        // the budget is in bytes
+        explicit GeometryCache(size_t budget);
+        GeometryCache(const GeometryCache&) = delete;
+        GeometryCache& operator=(const GeometryCache&) = delete;
+        ~GeometryCache();
+
+        // a mesh of the scene cache, returns the index of the mesh in the
+        // .. geometry cache
+        int addMesh(int cachedMeshIndex, const Texture* texture, const Material& material);
+
+        // maps the scene cache the meshes are loaded from, once it is written
+        void open(const std::string& sceneFilePath, uint64_t key);
+
+        int getNumberOfMeshes() const { return this->entries.size(); }
+
+        // the mesh as it is in the scene cache, which is mapped while the
+        // .. meshes are loaded
+        const SceneCache::Mesh& getCachedMesh(int meshIndex) const { return this->sceneCache.getMesh(this->entries[meshIndex].cachedMeshIndex); }
+        size_t getBudget() const { return this->budget; }
+
+        // hits, misses, evictions and the memory of the loaded meshes
+        void printStatistics(std::ostream& stream);
+};
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef __LAZY_MESH_H__
+#define __LAZY_MESH_H__
+
+#include "shape.hpp"
+#include "geometry_cache.hpp"
+#include "position3.hpp"
+#include "ray.hpp"
+#include "structs.hpp"
+
+// a mesh loaded out of core, of which only the bounds are kept. its triangles
+// .. are loaded by the geometry cache once a ray enters the bounds, and they
+// .. are shared by the instances of the mesh, see GeometryCache
+class LazyMesh : public Shape
+{
+    private:
+        GeometryCache* geometryCache;
+        int meshIndex;
+
+    public:
+        // the bounds of the triangles, before the transformation of the mesh
+        LazyMesh(GeometryCache* geometryCache, int meshIndex, const Position3& minPosition, const Position3& maxPosition)
+            : geometryCache(geometryCache), meshIndex(meshIndex)
+        {
+            this->minPosition = minPosition;
+            this->maxPosition = maxPosition;
+        }
+
+        bool hit(const Ray & ray, HitInfo & hitInfo, bool backfaceCulling, bool opaqueSearch) const;
+
+        bool isOccluding(const Ray & ray, float maxT, bool backfaceCulling) const;
+
+        virtual Position3 getUniformPoint() const;
+};
+
+#endif
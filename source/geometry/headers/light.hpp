@@ -5,19 +5,65 @@
 #include "position3.hpp"
 
 class Scene;
+class Ray;
 struct HitInfo;
 
 struct IncidentLight {
     bool inShadow;
     Vector3 intensity;
     Vector3 hitToLightDirection;
+
+    // probability density (per solid angle) of sampling hitToLightDirection
+    // .. 0 for the lights that cannot be hit by a ray, e.g. point lights
+    // .. if positive, intensity is the radiance divided by pdf
+    float pdf = 0.f;
+
+    // the light is in shadow if the shadow ray hits an opaque shape before
+    // .. shadowRayMaxT, see Light::sampleIncidentLight
+    bool hasShadowRay = false;
+    Position3 shadowRayOrigin;
+    Vector3 shadowRayDirection;
+    float shadowRayTime = 0.f;
+    float shadowRayMaxT = 0.f;
+    bool shadowRayBackfaceCulling = false;
+
+    void setShadowRay(const Ray& shadowRay, float maxT, bool backfaceCulling);
+    Ray getShadowRay() const;
 };
 
 class Light
 {
+    private:
+        int index = -1;
+
     public:
         // Compute light incident to position. Shadow check is also done by considering the scene.
-        virtual IncidentLight getIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const = 0;
+        IncidentLight getIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const;
+
+        // Same as getIncidentLight, except that the shadow ray is left to the caller,
+        // .. so that the shadow rays can be traced together, see ShadowRayQueue
+        virtual IncidentLight sampleIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const = 0;
+
+        // Shadow check of the incident light
+        static void traceShadowRay(const Scene& scene, IncidentLight& incidentLight);
+
+        // Estimated power emitted by the light, used to choose the lights to sample
+        // .. in scenes with many lights. Only the ratios among the lights matter.
+        virtual float getPower() const { return 0.f; }
+
+        // Bounds of the light, false if it is infinitely far away, e.g. directional
+        // .. lights, which are not chosen among the others but always sampled.
+        virtual bool getBounds(Position3& minPosition, Position3& maxPosition) const { return false; }
+
+        // Index of the light in the scene's lights. Object lights are placed into the
+        // .. bounding volume hiearchy as separate instances, which share the index.
+        int getIndex() const { return this->index; }
+        void setIndex(int index) { this->index = index; }
+
+        // Probability density (per solid angle) of getIncidentLight sampling the direction
+        // .. from hitInfo, which is known to hit the light at lightHitInfo.
+        // Used to weight the light found by path tracing rays (multiple importance sampling).
+        virtual float getPdf(const HitInfo& hitInfo, const Vector3& direction, const HitInfo& lightHitInfo) const { return 0.f; }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,76 @@
+#ifndef __LIGHT_SAMPLER_H__
+#define __LIGHT_SAMPLER_H__
+
+#include "light.hpp"
+#include "position3.hpp"
+#include "vector3.hpp"
+#include "enums.hpp"
+#include "../../utility/alias_table.hpp"
+#include <vector>
+
+// a light chosen to be sampled, with the probability of choosing it
+struct LightSelection
+{
+    const Light* light = nullptr;
+    float probability = 0.f;
+};
+
+// chooses the light to sample at a hit among the lights of the scene, so that
+// .. the cost of a hit does not grow with the number of lights
+//  - POWER_LIGHT_SAMPLING: by the power of the lights (alias table)
+//  - BVH_LIGHT_SAMPLING: by the power and the distance of the lights, estimated
+// ..   for the groups of lights in a bounding volume hiearchy of the lights
+// the lights infinitely far away are not chosen among the others, they are
+// .. always sampled
+class LightSampler
+{
+    private:
+        // node of the light bounding volume hiearchy
+        struct Node
+        {
+            Position3 minPosition, maxPosition;
+            float power = 0.f;
+
+            int left = -1, right = -1, parent = -1;
+            int light = -1; // index in the scene's lights for the leaves
+        };
+
+        LightSampling mode = ALL_LIGHTS;
+
+        std::vector<const Light*> lights;           // by the index in the scene
+        std::vector<const Light*> unboundedLights;  // always sampled
+
+        // POWER_LIGHT_SAMPLING
+        std::vector<int> boundedLights;             // scene indices of the table entries
+        std::vector<int> tableIndexOfLight;         // -1 for the unbounded lights
+        AliasTable powerTable;
+
+        // BVH_LIGHT_SAMPLING
+        std::vector<Node> nodes;                    // root is the first one
+        std::vector<int> leafOfLight;               // -1 for the unbounded lights
+
+        int buildNode(std::vector<int>& lightIndices, const std::vector<Position3>& centers, int first, int count, int parent);
+
+        // estimated contribution of the lights in the node to the hit
+        float getImportance(const Node& node, const Position3& position, const Vector3& normal) const;
+
+        // probability of choosing the child at the node at the hit
+        float getChildProbability(int child, const Position3& position, const Vector3& normal) const;
+
+    public:
+        void build(const std::vector<Light*>& sceneLights, LightSampling mode);
+
+        const std::vector<const Light*>& getUnboundedLights() const { return this->unboundedLights; }
+
+        // chooses one of the bounded lights, u is uniform in [0, 1)
+        // .. false if none of them can illuminate the hit
+        bool sample(const Position3& position, const Vector3& normal, float u, LightSelection& selection) const;
+
+        // probability of sample() choosing the light, 1 for the unbounded lights
+        float getProbability(const Light* light, const Position3& position, const Vector3& normal) const;
+
+        // whether the light is not chosen but sampled at every hit
+        bool isAlwaysSampled(const Light* light) const;
+};
+
+#endif
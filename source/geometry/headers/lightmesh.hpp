@@ -3,13 +3,28 @@
 
 #include "shape.hpp"
 #include "boundingvolume.hpp"
+#include "../../utility/alias_table.hpp"
 #include <iostream>
+#include <vector>
+#include <cmath>
 
 class LightMesh: public Light, public Shape
 {
+    friend class CompiledBVH;
+
     private:
         Vector3 radiance;
         BoundingVolume* mesh = nullptr;
+
+        // triangles of the mesh, three vertices each, and the table choosing
+        // .. them by their area, so that a point is sampled in constant time
+        std::vector<Position3> triangleVertices;
+        AliasTable triangleTable;
+
+        void buildTriangleTable();
+
+        // uniform point on the mesh, with the normal of its triangle
+        Position3 sampleTriangle(Vector3& normal) const;
     public:
         LightMesh(BoundingVolume* mesh, Vector3 radiance)
             : radiance(radiance)
@@ -21,6 +36,8 @@ class LightMesh: public Light, public Shape
                 this->minPosition = this->mesh->getMinPosition();
                 this->maxPosition = this->mesh->getMaxPosition();
             }
+
+            buildTriangleTable();
         }
         
         LightMesh(const LightMesh& rhs)
@@ -33,7 +50,8 @@ class LightMesh: public Light, public Shape
                 this->minPosition = this->mesh->getMinPosition();
                 this->maxPosition = this->mesh->getMaxPosition();
             }
-                
+
+            buildTriangleTable();
         }
 
         LightMesh& operator=(const LightMesh& rhs)
@@ -55,18 +73,32 @@ class LightMesh: public Light, public Shape
                 this->minPosition = this->mesh->getMinPosition();
                 this->maxPosition = this->mesh->getMaxPosition();
             }
-                
+
+            buildTriangleTable();
+
+            return *this;
         }
 
         ~LightMesh() { if(mesh) delete mesh; }
 
-        virtual IncidentLight getIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const;
+        virtual IncidentLight sampleIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const;
+
+        virtual float getPdf(const HitInfo& hitInfo, const Vector3& direction, const HitInfo& lightHitInfo) const;
+
+        // emitted from both sides of the mesh
+        virtual float getPower() const { return 2 * M_PI * this->area * this->radiance.getAverage(); }
+        virtual bool getBounds(Position3& minPosition, Position3& maxPosition) const
+        {
+            minPosition = this->minPosition;
+            maxPosition = this->maxPosition;
+            return true;
+        }
 
         // Decorator
         virtual bool hit(const Ray& ray, HitInfo & hitInfo, bool backfaceCulling, bool opaqueSearch) const;
 
         void setRadiance(const Vector3& radiance) { this->radiance = radiance; }
-        void setMesh(BoundingVolume* mesh) { this->mesh = mesh; }
+        void setMesh(BoundingVolume* mesh) { this->mesh = mesh; buildTriangleTable(); }
 
         virtual Position3 getUniformPoint() const;
 };
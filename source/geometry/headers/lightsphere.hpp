@@ -7,15 +7,32 @@
 #include "material.hpp"
 #include "vector3.hpp"
 
+#include <cmath>
+
 class LightSphere: public Light, public Sphere
 {
+    friend class CompiledBVH;
+
     private:
         Vector3 radiance;
+
+        // center and radius after the transformations, at the time
+        void getWorldSphere(float time, Position3& center, float& radius) const;
     public:
         LightSphere(const Sphere& sphere, const Vector3& radiance)
             : Sphere(sphere), radiance(radiance) {}
 
-        virtual IncidentLight getIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const;
+        virtual IncidentLight sampleIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const;
+
+        virtual float getPdf(const HitInfo& hitInfo, const Vector3& direction, const HitInfo& lightHitInfo) const;
+
+        virtual float getPower() const { return 4 * M_PI * M_PI * pow(this->getRadius(), 2) * this->radiance.getAverage(); }
+        virtual bool getBounds(Position3& minPosition, Position3& maxPosition) const
+        {
+            minPosition = this->minPosition;
+            maxPosition = this->maxPosition;
+            return true;
+        }
 
         // Decorator for the method Sphere.hit
         virtual bool hit(const Ray& ray, HitInfo & hitInfo, bool backfaceCulling, bool opaqueSearch) const;
@@ -21,7 +21,10 @@ class Material
     public:
         Material() : phongExponent(0.f), refractionIndex(1.f), roughness(0.f) { brdf.setMode(BRDF::Mode::DEFAULT); }
 
-        BRDF getBRDF() const;
+        // material of the hits on the shapes without one
+        static const Material DEFAULT_MATERIAL;
+
+        const BRDF& getBRDF() const;
         Vector3 getAmbient() const;
         Vector3 getDiffuse() const;
         Vector3 getSpecular() const;
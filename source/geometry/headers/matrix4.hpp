@@ -175,6 +175,11 @@ class Matrix4
         {
             return matrixArray[ind1][ind2];
         }
+
+        float getEl(int ind1, int ind2) const
+        {
+            return matrixArray[ind1][ind2];
+        }
 /*
         const float* operator[](int rowIndex) const
         {
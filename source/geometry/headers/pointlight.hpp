@@ -5,6 +5,8 @@
 #include "position3.hpp"
 #include "vector3.hpp"
 
+#include <cmath>
+
 class Scene;
 
 class PointLight : public Light
@@ -22,7 +24,14 @@ class PointLight : public Light
         void setPosition(const Position3& position) { this->position = position; }
         void setIntensity(const Vector3& intensity) { this->intensity = intensity; }
 
-        virtual IncidentLight getIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const;
+        virtual IncidentLight sampleIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const;
+
+        virtual float getPower() const { return 4 * M_PI * this->intensity.getAverage(); }
+        virtual bool getBounds(Position3& minPosition, Position3& maxPosition) const
+        {
+            minPosition = maxPosition = this->position;
+            return true;
+        }
 };
 
 
@@ -9,40 +9,67 @@ class Position3
         float x, y, z;
         
     public:
-        Position3(float x, float y, float z)
+        constexpr Position3(float x, float y, float z)
             : x(x), y(y), z(z) {}
 
-        Position3()
+        constexpr Position3()
             : x(0.f), y(0.f), z(0.f) {}
 
-        Position3(float xyz)
+        constexpr Position3(float xyz)
             : x(xyz), y(xyz), z(xyz) {}
         
-        float getX() const;
-        float getY() const;
-        float getZ() const;
+        constexpr float getX() const { return x; }
+        constexpr float getY() const { return y; }
+        constexpr float getZ() const { return z; }
         
-        void setX(float x);
-        void setY(float y);
-        void setZ(float z);
+        void setX(float x) { this->x = x; }
+        void setY(float y) { this->y = y; }
+        void setZ(float z) { this->z = z; }
         
         // substraction of two points yields a vector
-        Vector3 operator-(const Position3 & rhs) const;
+        constexpr Vector3 operator-(const Position3 & rhs) const
+        {
+            return Vector3(x - rhs.x, y - rhs.y, z - rhs.z);
+        }
 
         // addition of Position3 with a Vector3 yields displacement and returns a new Position3
-        Position3 operator+(const Vector3 & rhs) const;
+        constexpr Position3 operator+(const Vector3 & rhs) const
+        {
+            return Position3(x + rhs.getX(), y + rhs.getY(), z + rhs.getZ());
+        }
         
         // a vector from this to rhs
-        Vector3 to(const Position3 & rhs) const;
+        constexpr Vector3 to(const Position3 & rhs) const
+        {
+            return rhs - *this;
+        }
         
-        float distanceSquare(const Position3 & rhs) const;
+        constexpr float distanceSquare(const Position3 & rhs) const
+        {
+            return (x - rhs.x) * (x - rhs.x) + (y - rhs.y) * (y - rhs.y) + (z - rhs.z) * (z - rhs.z);
+        }
 
-        static Position3 generateMinPosition(const Position3 & p1, const Position3 & p2);
-        static Position3 generateMaxPosition(const Position3 & p1, const Position3 & p2);
+        static constexpr Position3 generateMinPosition(const Position3 & p1, const Position3 & p2)
+        {
+            return Position3(
+                p1.x < p2.x ? p1.x : p2.x,
+                p1.y < p2.y ? p1.y : p2.y,
+                p1.z < p2.z ? p1.z : p2.z
+            );
+        }
 
-        static bool compareLTX(const Position3 & lhs, const Position3 & rhs);
-        static bool compareLTY(const Position3 & lhs, const Position3 & rhs);
-        static bool compareLTZ(const Position3 & lhs, const Position3 & rhs);
+        static constexpr Position3 generateMaxPosition(const Position3 & p1, const Position3 & p2)
+        {
+            return Position3(
+                p1.x > p2.x ? p1.x : p2.x,
+                p1.y > p2.y ? p1.y : p2.y,
+                p1.z > p2.z ? p1.z : p2.z
+            );
+        }
+
+        static constexpr bool compareLTX(const Position3 & lhs, const Position3 & rhs) { return lhs.x < rhs.x; }
+        static constexpr bool compareLTY(const Position3 & lhs, const Position3 & rhs) { return lhs.y < rhs.y; }
+        static constexpr bool compareLTZ(const Position3 & lhs, const Position3 & rhs) { return lhs.z < rhs.z; }
 };
 
 #endif
\ No newline at end of file
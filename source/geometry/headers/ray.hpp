@@ -31,6 +31,9 @@ class Ray
         
         void setOrigin(Position3 position) { this->origin = position; }
         void setDirection(Vector3 direction) { this->direction = direction.normalize(); }
+        // the direction is kept as it is, e.g. for the rays transformed to the
+        // .. space of a shape, whose hits keep their parameters t
+        void setUnnormalizedDirection(Vector3 direction) { this->direction = direction; }
         void setWeight(float weight) { this->weight = weight; }
         void setTimeCreated(float timeCreated) { this->timeCreated = timeCreated; }
         
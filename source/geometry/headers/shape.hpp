@@ -16,8 +16,10 @@ class Shape
         // A shape may cover the material - or not. Before delivering its
         // .. material to top, it is better to think if there is valuable
         // .. information inside material!
+        // the material is one of the scene's materials, which are kept in a
+        // .. table for the lifetime of the shapes
         bool hasMaterial = false;
-        Material material;
+        const Material* material = nullptr;
 
         Position3 minPosition, maxPosition;
 
@@ -29,14 +31,12 @@ class Shape
 
         std::vector<Position3> getAllVertices() const;
 
-        Ray applyShapeTransformation(const Ray & originalRay) const;
-        
         Ray transformRayForIntersection(const Ray & originalRay) const;
         void transformHitInfoAfterIntersection(const Ray & originalRay, HitInfo & hitInfo) const;
 
         Shape() {}
 
-        Shape(const Material& material) : material(material), hasMaterial(true) { }
+        Shape(const Material& material) : material(&material), hasMaterial(true) { }
 
         // To be used as weights for making uniform selections among shapes
         float area = 0.f;
@@ -44,15 +44,23 @@ class Shape
         void setMaterial(const Material& material)
         {
             this->hasMaterial = true;
-            this->material = material;
+            this->material = &material;
         }
 
         virtual float getArea() const { return this->area; }
 
         virtual bool hit(const Ray& ray, HitInfo & hitInfo, bool backfaceCulling, bool opaqueSearch) const = 0;
 
+        // whether the ray hits any opaque part of the shape closer than maxT,
+        // .. not necessarily the closest one
+        virtual bool isOccluding(const Ray& ray, float maxT, bool backfaceCulling) const;
+
         virtual Position3 getUniformPoint() const = 0;
 
+        // appends the vertices of the triangles under the shape, three per
+        // .. triangle, with the transformations of the shape applied
+        virtual void appendTriangleVertices(std::vector<Position3>& vertices) const { }
+
         // destructor
         virtual ~Shape() { };
 
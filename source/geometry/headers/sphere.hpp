@@ -6,31 +6,53 @@
 #include "structs.hpp"
 #include "ray.hpp"
 
+// the data a sphere is hit by, see CompiledTriangle
+struct CompiledSphere
+{
+    Position3 center;
+    float radius;
+
+    float discriminant(const Ray & ray) const;
+
+    // the distance of the closest hit in front of the ray, isGrazing if the
+    // .. ray touches the sphere at a single point
+    bool intersect(const Ray & ray, float & t, bool & isGrazing) const;
+
+    // fills the hit found by intersect, the material and the textures are
+    // .. optional
+    void shade(
+        const Ray & ray, float t, bool isGrazing,
+        const Material * material, const ImageTexture * imageTexture, const PerlinTexture * perlinTexture,
+        HitInfo & hitInfo
+    ) const;
+};
+
 class Sphere : public Surface
 {
+    friend class CompiledBVH;
+
     private:
-        Position3 center;
-        float radius;
+        CompiledSphere compiled;
         
     public:
-        Position3 getCenter() const { return this->center; }
-        float getRadius() const { return this->radius; }
+        Position3 getCenter() const { return this->compiled.center; }
+        float getRadius() const { return this->compiled.radius; }
         
         Sphere(Position3 center, float radius, const Material & material)
-            : Surface(material), center(center), radius(radius) 
+            : Surface(material), compiled{ center, radius }
         {
             // minPosition
             this->minPosition = Position3(
-                this->center.getX() - radius,
-                this->center.getY() - radius,
-                this->center.getZ() - radius
+                center.getX() - radius,
+                center.getY() - radius,
+                center.getZ() - radius
             );
 
             // maxPosition
             this->maxPosition = Position3(
-                this->center.getX() + radius,
-                this->center.getY() + radius,
-                this->center.getZ() + radius
+                center.getX() + radius,
+                center.getY() + radius,
+                center.getZ() + radius
             );
         }
         
@@ -40,7 +62,7 @@ class Sphere : public Surface
        
         bool hit(const Ray & ray, HitInfo & hitInfo, bool backfaceCulling, bool opaqueSearch) const;
 
-        virtual Position3 getUniformPoint() const { return this->center; } // dummy
+        virtual Position3 getUniformPoint() const { return this->compiled.center; } // dummy
 };
 
-#endif
\ No newline at end of file
+#endif
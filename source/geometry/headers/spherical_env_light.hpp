@@ -3,9 +3,11 @@
 
 #include "../../image/image.hpp"
 #include "../../image/color.hpp"
+#include "../../utility/alias_table.hpp"
 #include "vector3.hpp"
 #include "light.hpp"
 #include <string>
+#include <vector>
 
 class Scene;
 struct HitInfo;
@@ -15,13 +17,31 @@ class SphericalEnvLight : public Light
     private:
         Image image;
 
+        // whether the sampled directions are checked for occlusion
+        bool shadowCheck = false;
+
+        // directions are sampled by choosing a texel by its brightness and
+        // .. the solid angle it covers, first its row, then its column
+        AliasTable rowTable;
+        std::vector<AliasTable> columnTables;
+
+        void buildSamplingTables();
+
         Color sampleTexture(float u, float v) const;
+
+        // spherical mapping between the directions and the texture coordinates
+        static void getTextureCoordinates(const Vector3& direction, float& u, float& v);
+        static Vector3 getDirection(float u, float v);
     public:
-        SphericalEnvLight(std::string imagePath) : image(imagePath) { }
+        SphericalEnvLight(std::string imagePath) : image(imagePath) { buildSamplingTables(); }
 
         Color getColor(const Vector3& direction) const;
 
-        virtual IncidentLight getIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const;
+        virtual IncidentLight sampleIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const;
+
+        virtual float getPdf(const HitInfo& hitInfo, const Vector3& direction, const HitInfo& lightHitInfo) const;
+
+        void setShadowCheck(bool shadowCheck) { this->shadowCheck = shadowCheck; }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -4,6 +4,7 @@
 #include "light.hpp"
 #include "position3.hpp"
 #include "vector3.hpp"
+#include "../../utility/shading_math.hpp"
 
 #include <cmath>
 
@@ -63,7 +64,7 @@ class SpotLight : public Light
                 float falloffFactor = (cosTheta - cosCovAngle) / cosDiff;
 
                 // avoid linear drop
-                falloffFactor = pow(falloffFactor, 4);
+                falloffFactor = square(square(falloffFactor));
 
                 return (this->intensity * falloffFactor) / distanceSquare;
             }
@@ -77,7 +78,15 @@ class SpotLight : public Light
             return this->falloffAngle;
         }
 
-        virtual IncidentLight getIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const;
+        virtual IncidentLight sampleIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const;
+
+        // emitted within the coverage cone
+        virtual float getPower() const { return 2 * M_PI * (1 - cosCovAngle) * this->intensity.getAverage(); }
+        virtual bool getBounds(Position3& minPosition, Position3& maxPosition) const
+        {
+            minPosition = maxPosition = this->position;
+            return true;
+        }
 };
 
 #endif
\ No newline at end of file
@@ -33,17 +33,31 @@ struct TextureInfo
     DecalMode decalMode;
 };
 
+class Light;
+
 struct HitInfo
 {
     Vector3 normal;
     Position3 hitPosition;
-    Material material;
+
+    // one of the scene's materials, the diffuse reflectance is the hit's as the
+    // .. textures may change it
+    const Material* material = &Material::DEFAULT_MATERIAL;
+    Vector3 diffuse;
+
     TextureInfo textureInfo;
     float t;
     float time = 0.f;
 
     bool isLight = false;
     Color lightColor;
+    const Light* light = nullptr; // the light hit, if it can be sampled
+
+    void setMaterial(const Material* material)
+    {
+        this->material = material;
+        this->diffuse = material->getDiffuse();
+    }
 };
 
 #endif
\ No newline at end of file
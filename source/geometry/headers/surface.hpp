@@ -17,24 +17,25 @@ class Surface : public Shape
 
         bool hasImageTexture = false;
         bool hasPerlinTexture = false;
-        ImageTexture imageTexture;
-        PerlinTexture perlinTexture;
+        // shared, owned by the scene
+        const ImageTexture* imageTexture = nullptr;
+        const PerlinTexture* perlinTexture = nullptr;
     public:
         // returns true if ray hits the surface and records the hit position
         // .. in hitPosition object
         virtual bool hit(const Ray & ray, HitInfo & hitInfo, bool backfaceCulling, bool opaqueSearch) const = 0;
 
-        void setTexture(Texture* texture)
+        void setTexture(const Texture* texture)
         {
             if(texture->getTextureType() == TextureType::IMAGE)
             {
                 hasImageTexture = true;
-                imageTexture = *((ImageTexture*)texture);
+                imageTexture = (const ImageTexture*)texture;
             }
             else if(texture->getTextureType() == TextureType::PERLIN)
             {
                 hasPerlinTexture = true;
-                perlinTexture = *((PerlinTexture*)texture);
+                perlinTexture = (const PerlinTexture*)texture;
             }
         }
 };
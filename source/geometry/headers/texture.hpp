@@ -4,12 +4,15 @@
 #include "vec3i.hpp"
 #include "vector3.hpp"
 #include "position3.hpp"
-#include "../../image/image.hpp"
+#include "texture_cache.hpp"
 #include "../../image/color.hpp"
 #include "../../utility/random_number_generator.hpp"
+#include "../../utility/shading_math.hpp"
 #include "vec2f.hpp"
 #include "iomethods.hpp"
 #include <string>
+#include <vector>
+#include <algorithm>
 #include <cmath>
 
 enum InterpolationMode
@@ -108,7 +111,8 @@ class PerlinTexture : public Texture
         {
             x = std::abs(x);
 
-            float result =  -6 * pow(x, 5) + 15 * pow(x, 4) + -10 * pow(x, 3) + 1; 
+            // -6x^5 + 15x^4 - 10x^3 + 1
+            float result = x * x * x * (x * (-6 * x + 15) - 10) + 1;
 
             return result;
         }
@@ -186,31 +190,30 @@ class PerlinTexture : public Texture
 class ImageTexture : public Texture
 {
     private:
-        Image image;
+        // shared by the textures of the same image, see TextureCache
+        const TextureCache::TiledImage* image = nullptr;
         InterpolationMode interpMode;
         AppearanceMode appMode;
         float normalizer = 255.f;
+
+        Color getColor(int x, int y) const { return image->getTexel(x, y) / normalizer; }
+        float getGrayscaleColor(int x, int y) const;
     
     public:
-        ImageTexture() : image(0, 0) { }
-
         // getters
-        Color getTexImageColor(int x, int y) const { return image.getColor(x, y); }
+        Color getTexImageColor(int x, int y) const { return getColor(x, y); }
         InterpolationMode getInterpolationMode() const { return interpMode; }
         AppearanceMode getAppearanceMode() const { return appMode; }
         virtual TextureType getTextureType() const { return TextureType::IMAGE; }
 
-        // ref getter
-        const Image& getImage() const { return image; }
+        const TextureCache::TiledImage* getImage() const { return image; }
 
         // setters
-        void setImage(const Image& image) { this->image = image; this->image.setNormalizer(normalizer); }
-        void setImage(const std::string& imageFileName) { this->image = Image(imageFileName); }
+        // the image may be loaded after it is set, and the normalizer as well
+        void setImage(const TextureCache::TiledImage* image) { this->image = image; }
         void setInterpolationMode(const InterpolationMode& interpMode) { this->interpMode = interpMode; }
         void setAppearanceMode(const AppearanceMode& appMode) { this->appMode = appMode; }
-        void setNormalizer(float normalizer) { image.setNormalizer(normalizer); }
-
-        void degammaImage() { image.degamma(); }
+        void setNormalizer(float normalizer) { this->normalizer = normalizer; }
 
         Color getInterpolatedColor(float u, float v) const;
         Vec2f getGradient(float u, float v) const;
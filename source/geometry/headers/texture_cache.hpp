@@ -0,0 +1,191 @@
+#ifndef __TEXTURE_CACHE_H__
+#define __TEXTURE_CACHE_H__
+
+#include "../../image/color.hpp"
+#include "../../config.h"
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+// The images of the textures, each shared by the textures of it and the
+// .. surfaces they are set to.
+//
+// An image is decoded once and converted to tiles of TEXTURE_TILE_SIZE^2
+// .. texels, of 8 bits per channel if the image is of 8 bits, e.g. a png or a
+// .. jpeg, and of half floats otherwise. An 8-bit texel is decoded by a table,
+// .. the degamma of the image if it is degammaed, so that the texels are the
+// .. values the image had as floats.
+//
+// By default, the tiles of the image are kept in memory. Given a budget, see
+// .. --texture-cache, the image is converted to a file of tiles, next to it as
+// .. "<image>" TEXTURE_CACHE_FILE_EXTENSION, which is converted again only
+// .. once the image changes. A tile is read from the
+// .. file the first time one of its texels is looked up, and the ones not used
+// .. recently are evicted, by the clock algorithm, once the loaded ones take
+// .. more memory than the budget.
+//
+// A tile is held while its texel is read, and is not deleted while it is
+// .. held, as the meshes of a GeometryCache.
+class TextureCache
+{
+    public:
+        class TiledImage;
+
+    private:
+        struct Tile
+        {
+            std::atomic<const uint8_t*> texels{ nullptr };
+
+            // the texel lookups reading the tile, and the ones finding it
+            // .. loaded
+            std::atomic<int> numberOfUsers{ 0 };
+            std::atomic<uint64_t> numberOfHits{ 0 };
+
+            // set when it is used, cleared by the clock hand
+            std::atomic<bool> isReferenced{ false };
+
+            // the tile is loaded by one thread, the others wait for it
+            std::mutex loadingMutex;
+
+            const TiledImage* image = nullptr;
+            int index = 0;
+        };
+
+        // holds a tile, loading it if it is not loaded
+        class Pin
+        {
+            private:
+                Tile& tile;
+                const uint8_t* texels;
+
+            public:
+                Pin(TextureCache& textureCache, Tile& tile);
+                Pin(const Pin&) = delete;
+                Pin& operator=(const Pin&) = delete;
+                ~Pin() { tile.numberOfUsers--; }
+
+                const uint8_t* getTexels() const { return this->texels; }
+        };
+
+    public:
+        class TiledImage
+        {
+            friend class TextureCache;
+
+            private:
+                TextureCache* textureCache = nullptr;
+                std::string filePath;
+                bool isDegamma = false;
+
+                int width = 0, height = 0;
+
+                // the texels are either half floats multiplied by the scale,
+                // .. or 8-bit indices to the decoding table
+                bool isHalf = false;
+                float scale = 1.f;
+                float decodingTable[256];
+
+                // in the order of their rows
+                std::unique_ptr<Tile[]> tiles;
+                int numberOfTilesX = 0;
+                int numberOfTiles = 0;
+
+                // the file of the tiles, out of core
+                std::string tileFilePath;
+                int tileFileDescriptor = -1;
+
+                size_t getTexelSize() const { return this->isHalf ? 3 * sizeof(uint16_t) : 3; }
+                size_t getTileSize() const { return TEXTURE_TILE_SIZE * TEXTURE_TILE_SIZE * getTexelSize(); }
+
+                // the tiles of the size of the image
+                void setTiles();
+
+                Color decodeTexel(const uint8_t* texels, int index) const;
+
+                // the tile of the texels of the image, in the order of the rows
+                void copyTile(const std::vector<uint8_t>& texels, int tileX, int tileY, uint8_t* tile) const;
+
+            public:
+                TiledImage() = default;
+                TiledImage(const TiledImage&) = delete;
+                TiledImage& operator=(const TiledImage&) = delete;
+                ~TiledImage();
+
+                int getWidth() const { return this->width; }
+                int getHeight() const { return this->height; }
+
+                // the texel, the coordinates are clamped to the edges. the
+                // .. colors are not normalized, as the ones of the image file
+                Color getTexel(int x, int y) const;
+        };
+
+    private:
+        // the budget is 0 if the tiles are kept in memory
+        size_t budget;
+
+        // a deque, so that the images are not moved when one is added
+        std::deque<TiledImage> images;
+        std::map<std::pair<std::string, bool>, TiledImage*> imagesByFile;
+
+        // the rest are guarded by the mutex, the loaded tiles are the circle
+        // .. the clock hand goes around
+        std::mutex mutex;
+        std::vector<Tile*> loadedTiles;
+        size_t clockHand = 0;
+        size_t loadedSize = 0;
+        size_t peakLoadedSize = 0;
+        uint64_t numberOfMisses = 0;
+        uint64_t numberOfEvictions = 0;
+
+        // decodes the image and converts it to its tiles, kept in memory or
+        // .. written to the file of the tiles
+        void convertImage(TiledImage& image, uint64_t key);
+
+        // opens the file of the tiles, returns false unless it is valid
+        bool openTileFile(TiledImage& image, uint64_t key);
+        void writeTileFile(TiledImage& image, uint64_t key, const std::vector<uint8_t>& texels);
+
+        // loads the tile unless another thread has loaded it meanwhile
+        const uint8_t* load(Tile& tile);
+
+        // evicts the tiles not used since the clock hand has passed them, except
+        // .. the given one, while the loaded ones are over the budget. called
+        // .. with the mutex locked
+        void evict(const Tile* keptTile);
+
+    public:
+        // the budget is in bytes, 0 keeps the tiles in memory
+        explicit TextureCache(size_t budget);
+        TextureCache(const TextureCache&) = delete;
+        TextureCache& operator=(const TextureCache&) = delete;
+
+        // the image of the file, the same one for the textures of the same
+        // .. file and degamma. isAdded is set if it is added now, and it is to
+        // .. be loaded by loadImage()
+        TiledImage* addImage(const std::string& imageFilePath, bool isDegamma, bool& isAdded);
+
+        // decodes the image and converts it, or opens its file of tiles if it
+        // .. is converted already. the images are loaded in parallel
+        void loadImage(TiledImage& image);
+
+        bool isOutOfCore() const { return this->budget > 0; }
+        int getNumberOfImages() const { return this->images.size(); }
+        size_t getBudget() const { return this->budget; }
+
+        // the memory of the tiles kept in memory
+        size_t getSize() const;
+
+        // hits, misses, evictions and the memory of the loaded tiles
+        void printStatistics(std::ostream& stream);
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define __TRANSFORMATION_H__
 
 #include "matrix4.hpp"
+#include "affine_transform.hpp"
 #include "vector3.hpp"
 
 #include <cmath>
@@ -9,51 +10,67 @@
 class Transformation
 {
     protected:
-        Matrix4 transformationMatrix;
-        Matrix4 inverseTransformationMatrix;
-        Matrix4 normalTransformationMatrix;
+        AffineTransform transformationMatrix;
+        AffineTransform inverseTransformationMatrix;
+
+        // transpose of the inverse, for the normals
+        AffineTransform normalTransformationMatrix;
+
+        void set(const AffineTransform & transformationMatrix,
+                 const AffineTransform & inverseTransformationMatrix)
+        {
+            this->transformationMatrix = transformationMatrix;
+            this->inverseTransformationMatrix = inverseTransformationMatrix;
+            this->normalTransformationMatrix = inverseTransformationMatrix.getLinearTranspose();
+        }
         
     public:
     
         // default constructor
         Transformation() { }
         
-        Transformation(const Matrix4 & transformationMatrix,
-                       const Matrix4 & inverseTransformationMatrix)
-            : transformationMatrix(transformationMatrix),
-              inverseTransformationMatrix(inverseTransformationMatrix)
+        Transformation(const AffineTransform & transformationMatrix,
+                       const AffineTransform & inverseTransformationMatrix)
         {
-            normalTransformationMatrix = inverseTransformationMatrix.getTranspose();
+            set(transformationMatrix, inverseTransformationMatrix);
         }
         
-        const Matrix4 & getTransformationMatrix() const
+        const AffineTransform & getTransformationMatrix() const
         {
             return this->transformationMatrix;
         }
         
-        const Matrix4 & getInverseTransformationMatrix() const
+        const AffineTransform & getInverseTransformationMatrix() const
         {
             return this->inverseTransformationMatrix;
         }
         
-        Transformation operator+(const Transformation & rhs)
+        Transformation operator+(const Transformation & rhs) const
         {
-            Matrix4 newTMatrix = rhs.transformationMatrix * this->transformationMatrix;
-            Matrix4 newInverseTMatrix = this->inverseTransformationMatrix * rhs.inverseTransformationMatrix;
-            
-            return Transformation(newTMatrix, newInverseTMatrix);
+            return Transformation(
+                rhs.transformationMatrix * this->transformationMatrix,
+                this->inverseTransformationMatrix * rhs.inverseTransformationMatrix
+            );
         }
         
         Transformation & operator+=(const Transformation & rhs)
         {
-            Transformation newTransformation = *this + rhs;
-            
-            this->transformationMatrix = newTransformation.transformationMatrix;
-            this->inverseTransformationMatrix = newTransformation.inverseTransformationMatrix;
-            this->normalTransformationMatrix = this->inverseTransformationMatrix.getTranspose();
+            *this = *this + rhs;
             
             return *this;
         }
+
+        // this transformation followed by a translation, e.g. the motion blur of
+        // .. a shape at the time of a ray, the normals are not affected
+        Transformation getTranslated(const Vector3 & translation) const
+        {
+            Transformation result = *this;
+
+            result.transformationMatrix.translate(translation);
+            result.inverseTransformationMatrix.translate(-(this->inverseTransformationMatrix * translation));
+
+            return result;
+        }
         
         template<class T>
         void transformMutating(T & transformable) const
@@ -61,6 +78,7 @@ class Transformation
             transformable = this->transformationMatrix * transformable;
         }
         
+        // a ray is transformed without normalizing its direction, see AffineTransform
         template<class T>
         T transform(const T & transformable) const
         {
@@ -78,15 +96,12 @@ class Transformation
             return normalTransformationMatrix * normal;
         }
         
-        HitInfo hitInfoTransform(const HitInfo & hitInfo, const Ray & originalRay) const
+        // the hit of a ray transformed by inverseTransform, its t is the same
+        // .. for the original ray
+        void hitInfoTransform(HitInfo & hitInfo) const
         {
-            HitInfo result = hitInfo;
-
-            result.hitPosition = this->transform(hitInfo.hitPosition);
-            result.normal = this->normalTransform(hitInfo.normal).normalize();
-            result.t = originalRay.getTValue(result.hitPosition);
-
-            return result;
+            hitInfo.hitPosition = this->transform(hitInfo.hitPosition);
+            hitInfo.normal = this->normalTransform(hitInfo.normal).normalize();
         }
         
 };
@@ -97,13 +112,17 @@ class Scaling : public Transformation
     public:
         Scaling(float scaleX, float scaleY, float scaleZ)
         {
-            transformationMatrix.setEl(0, 0, scaleX);
-            transformationMatrix.setEl(1, 1, scaleY);
-            transformationMatrix.setEl(2, 2, scaleZ);
+            Matrix4 scalingMatrix, inverseScalingMatrix;
+
+            scalingMatrix.setEl(0, 0, scaleX);
+            scalingMatrix.setEl(1, 1, scaleY);
+            scalingMatrix.setEl(2, 2, scaleZ);
 
-            inverseTransformationMatrix.setEl(0, 0, 1 / scaleX);
-            inverseTransformationMatrix.setEl(1, 1, 1 / scaleY);
-            inverseTransformationMatrix.setEl(2, 2, 1 / scaleZ);
+            inverseScalingMatrix.setEl(0, 0, 1 / scaleX);
+            inverseScalingMatrix.setEl(1, 1, 1 / scaleY);
+            inverseScalingMatrix.setEl(2, 2, 1 / scaleZ);
+
+            set(scalingMatrix, inverseScalingMatrix);
         }
 };
 
@@ -159,8 +178,7 @@ class Rotation : public Transformation
             Matrix4 M(MArray);
             Matrix4 inverseM(MInverseArray);
             
-            transformationMatrix = inverseM * Matrix4(rotationArray) * M;        
-            inverseTransformationMatrix =  inverseM * Matrix4(inverseRotationArray) * M;
+            set(inverseM * Matrix4(rotationArray) * M, inverseM * Matrix4(inverseRotationArray) * M);
         }
 };
 
@@ -170,13 +188,8 @@ class Translation : public Transformation
     public:
         Translation(float translationX, float translationY, float translationZ)
         {
-            transformationMatrix.setEl(0, 3, translationX);
-            transformationMatrix.setEl(1, 3, translationY);
-            transformationMatrix.setEl(2, 3, translationZ);
-
-            inverseTransformationMatrix.setEl(0, 3, -translationX);
-            inverseTransformationMatrix.setEl(1, 3, -translationY);
-            inverseTransformationMatrix.setEl(2, 3, -translationZ);
+            transformationMatrix.translate(Vector3(translationX, translationY, translationZ));
+            inverseTransformationMatrix.translate(Vector3(-translationX, -translationY, -translationZ));
         }
 
         Translation(Vector3 motionBlurVector)
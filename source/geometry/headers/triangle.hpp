@@ -11,35 +11,47 @@
 #include "structs.hpp"
 #include "../../config.h"
 
+// the data a triangle is hit by, kept by the triangle and copied into the
+// .. compiled scene as it is, see CompiledBVH
+struct CompiledTriangle
+{
+    Position3 vertex0;
+
+    // vertex0 - vertex1 and vertex0 - vertex2
+    Vector3 A_B, A_C;
+
+    Vector3 normal;
+    Vector3 vertexNormals[3];
+    Vec2f texCoords[3];
+
+    ShadingMode shadingMode;
+
+    // the distance of the hit and its barycentric coordinates, beta and gamma
+    // .. are the weights of vertex1 and vertex2
+    bool intersect(const Ray & ray, bool backfaceCulling, float & t, float & beta, float & gamma) const;
+
+    // fills the hit found by intersect, the material and the textures are
+    // .. optional
+    void shade(
+        const Ray & ray, float t, float beta, float gamma,
+        const Material * material, const ImageTexture * imageTexture, const PerlinTexture * perlinTexture,
+        HitInfo & hitInfo
+    ) const;
+};
+
 class Triangle : public Surface
 {
+    friend class CompiledBVH;
+
     private:
         const Vertex vertex[3];
-        const Vector3 normal;
-
-        ShadingMode shadingMode;
 
-        Vec2f texCoord[3];
+        CompiledTriangle compiled;
 
         Position3 computeMinPosition() const;
         Position3 computeMaxPosition() const;
         
-        void fillLookUpTable();
-        
-        struct LookUpTable
-        {
-            // A: vertex[0], B: vertex[1], C: vertex[2]
-            float Ax_Bx;
-            float Ay_By;
-            float Az_Bz;
-            float Ax_Cx;
-            float Ay_Cy;
-            float Az_Cz;
-            Vector3 A_C;
-            Vector3 A_B;
-        };
-        
-        LookUpTable lookUpTable;
+        void fillCompiledTriangle();
         
     public:
         // constructor with material
@@ -68,22 +80,21 @@ class Triangle : public Surface
         
         bool hit(const Ray& ray, HitInfo & hitInfo, bool backfaceCulling, bool opaqueSearch) const;
 
-        ShadingMode getShadingMode() const { return this->shadingMode; }
-        void setShadingMode(ShadingMode shadingMode) { this->shadingMode = shadingMode; }
+        ShadingMode getShadingMode() const { return this->compiled.shadingMode; }
+        void setShadingMode(ShadingMode shadingMode) { this->compiled.shadingMode = shadingMode; }
 
         void setTexCoord(const Vec2f& c0, const Vec2f& c1, const Vec2f& c2)
         {
-            
-            texCoord[0] = c0;
-            texCoord[1] = c1;
-            texCoord[2] = c2;
-/*
-            std::cout << "TexCoord 0: " << c0.x << ", " << c0.y << std::endl;
-            std::cout << "TexCoord 1: " << c1.x << ", " << c1.y << std::endl;
-            std::cout << "TexCoord 2: " << c2.x << ", " << c2.y << std::endl;*/
+            compiled.texCoords[0] = c0;
+            compiled.texCoords[1] = c1;
+            compiled.texCoords[2] = c2;
         }
 
+        const Vec2f& getTexCoord(int vertexId) const { return this->compiled.texCoords[vertexId]; }
+
         virtual Position3 getUniformPoint() const;
+
+        virtual void appendTriangleVertices(std::vector<Position3>& vertices) const;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -2,63 +2,115 @@
 #define __VECTOR3_H__
 
 #include <vector>
+#include <cmath>
 #include "enums.hpp"
 
+// the arithmetic is defined in the header, so that it is inlined into the
+// .. intersection and shading code of every translation unit
 class Vector3
 {
     private:
         float x, y, z;
         
     public:
-        Vector3()
+        constexpr Vector3()
             : x(0.f), y(0.f), z(0.f) {}
 
-        Vector3(float x, float y, float z)
+        constexpr Vector3(float x, float y, float z)
             : x(x), y(y), z(z) {}
 
-        Vector3(float xyz)
+        constexpr Vector3(float xyz)
             : x(xyz), y(xyz), z(xyz) {}
 
-        float getX() const;
-        float getY() const;
-        float getZ() const;
+        constexpr float getX() const { return x; }
+        constexpr float getY() const { return y; }
+        constexpr float getZ() const { return z; }
         
-        void setX(float x);
-        void setY(float y);
-        void setZ(float z);
+        void setX(float x) { this->x = x; }
+        void setY(float y) { this->y = y; }
+        void setZ(float z) { this->z = z; }
         
         // unary (-) operator
-        Vector3 operator-() const;
+        constexpr Vector3 operator-() const
+        {
+            return Vector3(-x, -y, -z);
+        }
         
         // substraction
-        Vector3 operator-(const Vector3 & rhs) const;
+        constexpr Vector3 operator-(const Vector3 & rhs) const
+        {
+            return Vector3(x - rhs.x, y - rhs.y, z - rhs.z);
+        }
         
         // addition
-        Vector3 operator+(const Vector3 & rhs) const;
+        constexpr Vector3 operator+(const Vector3 & rhs) const
+        {
+            return Vector3(x + rhs.x, y + rhs.y, z + rhs.z);
+        }
         
         // dot product
-        float operator^(const Vector3 & rhs) const;
+        constexpr float operator^(const Vector3 & rhs) const
+        {
+            return x * rhs.x + y * rhs.y + z * rhs.z;
+        }
         
         // cross product
-        Vector3 operator*(const Vector3 & rhs) const;
+        constexpr Vector3 operator*(const Vector3 & rhs) const
+        {
+            return Vector3(
+                y * rhs.z - z * rhs.y,
+                z * rhs.x - x * rhs.z,
+                x * rhs.y - y * rhs.x
+            );
+        }
         
         // normalize: make it unit vector, then, return self
-        Vector3 & normalize();
+        Vector3 & normalize()
+        {
+            *this = *this / getNorm();
+
+            return *this;
+        }
         
         // scalar multiplication
-        Vector3 operator*(float rhs) const;
+        constexpr Vector3 operator*(float rhs) const
+        {
+            return Vector3(x * rhs, y * rhs, z * rhs);
+        }
         
-        // scalar division
-        Vector3 operator/(float rhs) const;
+        // scalar division, zero vector if divided by zero
+        constexpr Vector3 operator/(float rhs) const
+        {
+            return rhs == 0.f ? Vector3(0.f) : Vector3(x / rhs, y / rhs, z / rhs);
+        }
 
         // scalar division
-        Vector3& operator/=(float rhs);
+        Vector3& operator/=(float rhs)
+        {
+            x /= rhs;
+            y /= rhs;
+            z /= rhs;
+
+            return *this;
+        }
         
         // get norm
-        float getNorm() const;
+        float getNorm() const
+        {
+            return std::sqrt(x * x + y * y + z * z);
+        }
+
+        // average of the components, e.g. for the brightness of a color
+        constexpr float getAverage() const
+        {
+            return (x + y + z) / 3.f;
+        }
         
         // intensify
-        Vector3 intensify(const Vector3 & intensityVector) const;
+        constexpr Vector3 intensify(const Vector3 & intensityVector) const
+        {
+            return Vector3(x * intensityVector.x, y * intensityVector.y, z * intensityVector.z);
+        }
 
         static std::vector<Vector3> generateOrthonomalBasis(const Vector3& referenceVector);
         
@@ -66,21 +118,37 @@ class Vector3
         Vector3 generateDifferentlyDirectedVector() const;
 
         // element-wise division
-        Vector3 operator/(const Vector3 & rhs) const;
+        constexpr Vector3 operator/(const Vector3 & rhs) const
+        {
+            return Vector3(x / rhs.x, y / rhs.y, z / rhs.z);
+        }
 
         // element-wise compare
-        bool operator!=(const float rhs) const;
+        constexpr bool operator!=(const float rhs) const
+        {
+            return x != rhs && y != rhs && z != rhs;
+        }
 
         // element-wise product
-        Vector3 elementwiseMultiply(const Vector3& rhs) const;
+        constexpr Vector3 elementwiseMultiply(const Vector3& rhs) const
+        {
+            return Vector3(x * rhs.x, y * rhs.y, z * rhs.z);
+        }
 
-        bool isZeroVector() const;
+        constexpr bool isZeroVector() const
+        {
+            return x == 0.f && y == 0.f && z == 0.f;
+        }
 
         // element-wise power
         Vector3 power(float prime) const;
 
         // generates a randomly directed vector within the hemisphere around 'this' vector
         Vector3 generateRandomVectorWithinHemisphere(RandomFactor randomFactor) const;
+
+        // probability density (per solid angle) of generateRandomVectorWithinHemisphere
+        // .. generating the given direction
+        float getPdfWithinHemisphere(const Vector3& direction, RandomFactor randomFactor) const;
 };
 
 #endif
\ No newline at end of file
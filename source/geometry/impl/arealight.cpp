@@ -3,9 +3,9 @@
 #include "../headers/pointlight.hpp"
 #include "../headers/structs.hpp"
 
-IncidentLight AreaLight::getIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const
+IncidentLight AreaLight::sampleIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const
 {
     PointLight pointLight = this->getPointLight(position);
 
-    return pointLight.getIncidentLight(scene, hitInfo, time);
+    return pointLight.sampleIncidentLight(scene, hitInfo, time);
 }
\ No newline at end of file
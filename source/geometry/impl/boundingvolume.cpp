@@ -5,6 +5,7 @@
 #include <vector>
 #include <algorithm>
 #include <iostream>
+#include <stdexcept>
 
 // limits
 #include <limits>
@@ -45,6 +46,22 @@ Position3 BoundingVolume::getUniformPoint() const
 
 }
 
+void BoundingVolume::appendTriangleVertices(std::vector<Position3>& vertices) const
+{
+    int first = vertices.size();
+
+    if(leftNode)
+        leftNode->appendTriangleVertices(vertices);
+    if(rightNode)
+        rightNode->appendTriangleVertices(vertices);
+
+    if(this->hasTransformation)
+    {
+        for(int i = first; i < (int)vertices.size(); i++)
+            vertices[i] = this->transformation.transform(vertices[i]);
+    }
+}
+
 bool BoundingVolume::hit(const Ray & originalRay, HitInfo & hitInfo, bool backfaceCulling, bool opaqueSearch) const
 {
     // set time of hit
@@ -78,7 +95,7 @@ bool BoundingVolume::hit(const Ray & originalRay, HitInfo & hitInfo, bool backfa
         if(result)
         {
             if(this->hasMaterial)
-                hitInfo.material = this->material;
+                hitInfo.setMaterial(this->material);
 
             transformHitInfoAfterIntersection(originalRay, hitInfo);
         }
@@ -92,6 +109,18 @@ bool BoundingVolume::hit(const Ray & originalRay, HitInfo & hitInfo, bool backfa
     }
 }
 
+bool BoundingVolume::isOccluding(const Ray & originalRay, float maxT, bool backfaceCulling) const
+{
+    if(!liangbarskyHit(originalRay))
+        return false;
+
+    Ray hitCheckRay = transformRayForIntersection(originalRay);
+
+    // maxT is the same for the transformed ray, see transformRayForIntersection
+    return (leftNode && leftNode->isOccluding(hitCheckRay, maxT, backfaceCulling)) ||
+           (rightNode && rightNode->isOccluding(hitCheckRay, maxT, backfaceCulling));
+}
+
 // public bounding volume generator method
 Shape* BoundingVolume::createBoundingVolumeHiearchy(
     std::vector<Shape*> &shapes
@@ -101,15 +130,42 @@ Shape* BoundingVolume::createBoundingVolumeHiearchy(
         shapes,           // surfaces
         0,                  // first index
         shapes.size(),    // number of surfaces
-        Axis::X             // division axis
+        Axis::X,            // division axis
+        nullptr
     );
 }
 
+Shape* BoundingVolume::createBoundingVolumeHiearchy(
+    std::vector<Shape*> &shapes,
+    std::vector<int32_t> &leftSizes
+)
+{
+    leftSizes.clear();
+
+    return BoundingVolume::createBoundingVolumeHiearchy(shapes, 0, shapes.size(), Axis::X, &leftSizes);
+}
+
+Shape* BoundingVolume::createBoundingVolumeHiearchy(
+    std::vector<Shape*> &shapes,
+    const int32_t* leftSizes, int numberOfSplits
+)
+{
+    const int32_t* leftSizesEnd = leftSizes + numberOfSplits;
+
+    Shape* bvh = BoundingVolume::createBoundingVolumeHiearchy(shapes, 0, shapes.size(), leftSizes, leftSizesEnd);
+
+    if(leftSizes != leftSizesEnd)
+        throw std::runtime_error("Error: The layout of the bounding volume hiearchy does not match its shapes.");
+
+    return bvh;
+}
+
 // private bounding volume generator method
 Shape* BoundingVolume::createBoundingVolumeHiearchy(
     std::vector<Shape*> &shapes,  // surfaces
     int firstInd, int numOfShapes,  // indices of first and last, used to determine the surfaces to consider
-    Axis divisionAxis
+    Axis divisionAxis,
+    std::vector<int32_t>* leftSizes
 )
 {
     if(numOfShapes == 0)
@@ -131,26 +187,64 @@ Shape* BoundingVolume::createBoundingVolumeHiearchy(
         divisionAxis
     );
 
-    // create a new bounding volume
-    BoundingVolume* bvh = new BoundingVolume();
+    if(leftSizes)
+        leftSizes->push_back(divisionInd - firstInd);
 
     // create its nodes
         // left node
-    bvh->leftNode = createBoundingVolumeHiearchy(
+    Shape* leftNode = createBoundingVolumeHiearchy(
         shapes,
         firstInd,
         divisionInd - firstInd,
-        BoundingVolume::nextDivisionAxis(divisionAxis)
+        BoundingVolume::nextDivisionAxis(divisionAxis),
+        leftSizes
     );
 
         // right node
-    bvh->rightNode = createBoundingVolumeHiearchy(
+    Shape* rightNode = createBoundingVolumeHiearchy(
         shapes,
         divisionInd,
         numOfShapes - (divisionInd - firstInd),
-        BoundingVolume::nextDivisionAxis(divisionAxis)
+        BoundingVolume::nextDivisionAxis(divisionAxis),
+        leftSizes
     );
 
+    // return newly created bvh
+    return createParentOf(leftNode, rightNode);
+}
+
+// the hiearchy of a recorded layout, the shapes are not partitioned again
+Shape* BoundingVolume::createBoundingVolumeHiearchy(
+    std::vector<Shape*> &shapes,
+    int firstInd, int numOfShapes,
+    const int32_t* &leftSizes, const int32_t* leftSizesEnd
+)
+{
+    if(numOfShapes == 0)
+        return nullptr;
+
+    if(numOfShapes == 1)
+        return shapes[firstInd];
+
+    if(leftSizes == leftSizesEnd || *leftSizes < 0 || *leftSizes > numOfShapes)
+        throw std::runtime_error("Error: The layout of the bounding volume hiearchy does not match its shapes.");
+
+    int leftSize = *leftSizes++;
+
+    Shape* leftNode = createBoundingVolumeHiearchy(shapes, firstInd, leftSize, leftSizes, leftSizesEnd);
+    Shape* rightNode = createBoundingVolumeHiearchy(shapes, firstInd + leftSize, numOfShapes - leftSize, leftSizes, leftSizesEnd);
+
+    return createParentOf(leftNode, rightNode);
+}
+
+BoundingVolume* BoundingVolume::createParentOf(Shape* leftNode, Shape* rightNode)
+{
+    // create a new bounding volume
+    BoundingVolume* bvh = new BoundingVolume();
+
+    bvh->leftNode = leftNode;
+    bvh->rightNode = rightNode;
+
     // set minPosition & maxPosition
     if(bvh->leftNode != nullptr && bvh->rightNode != nullptr)
     {
@@ -178,7 +272,6 @@ Shape* BoundingVolume::createBoundingVolumeHiearchy(
     bvh->area += bvh->leftNode  ? bvh->leftNode->getArea()  : 0;
     bvh->area += bvh->rightNode ? bvh->rightNode->getArea() : 0;
 
-    // return newly created bvh
     return bvh;
 }
 
@@ -309,6 +402,8 @@ BoundingVolume* BoundingVolume::makeInstanceOf(BoundingVolume* toBeInstanced)
     // instance does not own the children
     // TODO: To be improved by making use of shared_ptr
     instance->ownsChildren = false;
+
+    return instance;
 }
 
 
@@ -3,9 +3,10 @@
 #include "../headers/ray.hpp"
 #include "../headers/vector3.hpp"
 #include "../../image/color.hpp"
+#include "../../utility/shading_math.hpp"
 #include <cmath>
 
-Color getDiffuseDefault(const HitInfo & hitInfo, const IncidentLight& incidentLight)
+static Color getDiffuseDefault(const HitInfo & hitInfo, const IncidentLight& incidentLight)
 {    
     if(incidentLight.inShadow)
         return Color::Black();
@@ -15,12 +16,12 @@ Color getDiffuseDefault(const HitInfo & hitInfo, const IncidentLight& incidentLi
     if(normalDotLight < 0.f)
         normalDotLight = 0.f;
 
-    Color diffuseColor = Color(hitInfo.material.getDiffuse().intensify(incidentLight.intensity) * normalDotLight);
+    Color diffuseColor = Color(hitInfo.diffuse.intensify(incidentLight.intensity) * normalDotLight);
 
     return diffuseColor;
 }
 
-Color getSpecularDefault(const Ray & ray, const HitInfo & hitInfo, const IncidentLight& incidentLight)
+static Color getSpecularDefault(const Ray & ray, const HitInfo & hitInfo, const IncidentLight& incidentLight)
 {
     if(incidentLight.inShadow)
         return Color::Black();
@@ -29,15 +30,15 @@ Color getSpecularDefault(const Ray & ray, const HitInfo & hitInfo, const Inciden
     
     float max = hitInfo.normal ^ h;
     max = max < 0.0f ? 0.0f : max;
-    max = pow(max, hitInfo.material.getPhongExponent());
+    max = shadingPow(max, hitInfo.material->getPhongExponent());
     
-    Vector3 colorVector = hitInfo.material.getSpecular().intensify(incidentLight.intensity) * max;
+    Vector3 colorVector = hitInfo.material->getSpecular().intensify(incidentLight.intensity) * max;
     
     return Color(colorVector);
 }
 
-// make it func of brdf
-Color getPhong(const Ray & ray, const HitInfo & hitInfo, const IncidentLight& incidentLight, bool modified, bool normalized)
+template<bool modified, bool normalized>
+static Color getPhong(const Ray & ray, const HitInfo & hitInfo, const IncidentLight& incidentLight)
 {
     if(incidentLight.inShadow)
         return Color::Black();
@@ -63,26 +64,26 @@ Color getPhong(const Ray & ray, const HitInfo & hitInfo, const IncidentLight& in
         return Color::Black();*/
     
     // raise to exponent p
-    float raisedCosAlfa_r = pow(cosAlfa_r, hitInfo.material.getBRDF().getExponent());
-    const Material& material = hitInfo.material;
+    float raisedCosAlfa_r = shadingPow(cosAlfa_r, hitInfo.material->getBRDF().getExponent());
+    const Material& material = *hitInfo.material;
 
     Vector3 diffuse, specular;
 
     // compute diffuse & specular according to modified and normalized
     if(!modified && !normalized)
     {
-        diffuse = material.getDiffuse();
+        diffuse = hitInfo.diffuse;
         specular = material.getSpecular() * ( raisedCosAlfa_r / cosTheta_i );
     }
     else if(modified && !normalized)
     {
-        diffuse = material.getDiffuse();
+        diffuse = hitInfo.diffuse;
         specular = material.getSpecular() * raisedCosAlfa_r;
     }
     else if(modified && normalized)
     {
-        diffuse = material.getDiffuse() * M_1_PI;
-        specular = material.getSpecular() * raisedCosAlfa_r * (hitInfo.material.getBRDF().getExponent() + 2) * M_1_PI * 0.5f;
+        diffuse = hitInfo.diffuse * M_1_PI;
+        specular = material.getSpecular() * raisedCosAlfa_r * (hitInfo.material->getBRDF().getExponent() + 2) * M_1_PI * 0.5f;
     }
 
     Vector3 result = ((diffuse + specular) * cosTheta_i).elementwiseMultiply(incidentLight.intensity);
@@ -90,7 +91,8 @@ Color getPhong(const Ray & ray, const HitInfo & hitInfo, const IncidentLight& in
     return Color(result);
 }
 
-Color getBlinnPhong(const Ray & ray, const HitInfo & hitInfo, const IncidentLight& incidentLight, bool modified, bool normalized)
+template<bool modified, bool normalized>
+static Color getBlinnPhong(const Ray & ray, const HitInfo & hitInfo, const IncidentLight& incidentLight)
 {
     if(incidentLight.inShadow)
         return Color::Black();
@@ -98,7 +100,7 @@ Color getBlinnPhong(const Ray & ray, const HitInfo & hitInfo, const IncidentLigh
     const Vector3 w_i = incidentLight.hitToLightDirection;
     const Vector3 w_o = -ray.getDirection();
 
-    const Material& material = hitInfo.material;
+    const Material& material = *hitInfo.material;
 
     // cosinus of the angle between w_i and surface normal
     const float cosTheta_i = w_i ^ hitInfo.normal;
@@ -117,23 +119,23 @@ Color getBlinnPhong(const Ray & ray, const HitInfo & hitInfo, const IncidentLigh
         return Color::Black();*/
 
     // raise to exponent p
-    float raisedCosAlfa_h = pow(cosAlfa_h, material.getBRDF().getExponent());
+    float raisedCosAlfa_h = shadingPow(cosAlfa_h, material.getBRDF().getExponent());
 
     Vector3 diffuse, specular;
 
     if(!modified && !normalized)
     {
-        diffuse = material.getDiffuse();
+        diffuse = hitInfo.diffuse;
         specular = material.getSpecular() * (raisedCosAlfa_h / cosTheta_i);
     }
     else if(modified && !normalized)
     {
-        diffuse = material.getDiffuse();
+        diffuse = hitInfo.diffuse;
         specular = material.getSpecular() * raisedCosAlfa_h;
     }
     else if(modified && normalized)
     {
-        diffuse = material.getDiffuse() * M_1_PI;
+        diffuse = hitInfo.diffuse * M_1_PI;
         specular = material.getSpecular() * (material.getBRDF().getExponent() + 8) * (1 / 8.f) * M_1_PI * raisedCosAlfa_h;
     }
 
@@ -142,7 +144,7 @@ Color getBlinnPhong(const Ray & ray, const HitInfo & hitInfo, const IncidentLigh
     return Color(result);
 }
 
-float computeGeometryTerm(const Vector3& normal, const Vector3& w_h, const Vector3& w_o, const Vector3& w_i)
+static float computeGeometryTerm(const Vector3& normal, const Vector3& w_h, const Vector3& w_o, const Vector3& w_i)
 {
     float n_dot_wh = normal ^ w_h;
     float n_dot_wo = normal ^ w_o;
@@ -155,14 +157,14 @@ float computeGeometryTerm(const Vector3& normal, const Vector3& w_h, const Vecto
     return std::min(1.f, std::min(p1, p2));
 }
 
-float computeFresnelReflectance(float refractiveIndex, float cosBeta)
+static float computeFresnelReflectance(float refractiveIndex, float cosBeta)
 {
-    float R_0 = pow((refractiveIndex - 1) / (refractiveIndex + 1), 2);
+    float R_0 = square((refractiveIndex - 1) / (refractiveIndex + 1));
 
-    return R_0 + (1 - R_0) * pow(1 - cosBeta, 5);
+    return R_0 + (1 - R_0) * powFive(1 - cosBeta);
 }
 
-Color getTorranceSparrow(const Ray & ray, const HitInfo & hitInfo, const IncidentLight& incidentLight)
+static Color getTorranceSparrow(const Ray & ray, const HitInfo & hitInfo, const IncidentLight& incidentLight)
 {
     if(incidentLight.inShadow)
         return Color::Black();
@@ -170,7 +172,7 @@ Color getTorranceSparrow(const Ray & ray, const HitInfo & hitInfo, const Inciden
     const Vector3 w_i = incidentLight.hitToLightDirection;
     const Vector3 w_o = -ray.getDirection();
 
-    const Material& material = hitInfo.material;
+    const Material& material = *hitInfo.material;
     float exponent = material.getBRDF().getExponent();
 
     // cosinus of the angle between w_i and surface normal
@@ -190,7 +192,7 @@ Color getTorranceSparrow(const Ray & ray, const HitInfo & hitInfo, const Inciden
         return Color::Black();
 
     // raise to exponent p
-    float raisedCosAlfa_h = pow(cosAlfa_h, exponent);
+    float raisedCosAlfa_h = shadingPow(cosAlfa_h, exponent);
 
     // D(alfa)
     float prob = (exponent + 2)  * 0.5f * M_1_PI * raisedCosAlfa_h;
@@ -201,7 +203,7 @@ Color getTorranceSparrow(const Ray & ray, const HitInfo & hitInfo, const Inciden
     // compute fresnel reflectance
     float fresnel = computeFresnelReflectance(material.getBRDF().getRefractiveIndex(), w_o ^ w_h);
 
-    Vector3 diffuse = material.getDiffuse() * M_1_PI;
+    Vector3 diffuse = hitInfo.diffuse * M_1_PI;
     Vector3 specular = material.getSpecular() * prob * fresnel * geometryTerm;
             specular /= 4 * cosTheta_i * (hitInfo.normal ^ w_o);
 
@@ -210,35 +212,64 @@ Color getTorranceSparrow(const Ray & ray, const HitInfo & hitInfo, const Inciden
     return Color(result);
 }
 
-// Methods for other brdfs
-Color BRDF::computeReflectedLight(const Ray & ray, const HitInfo & hitInfo, const IncidentLight& incidentLight) const
+static Color getDefault(const Ray & ray, const HitInfo & hitInfo, const IncidentLight& incidentLight)
 {
-    Color color = Color::Black();
+    Color color = getDiffuseDefault(hitInfo, incidentLight);
+    color += getSpecularDefault(ray, hitInfo, incidentLight);
 
+    return color;
+}
+
+template<BRDF::Kernel kernel>
+static void computeBatch(const Ray & ray, const HitInfo & hitInfo, const IncidentLight* incidentLights, Color* colors, int count)
+{
+    for(int i = 0; i < count; i++)
+        colors[i] = kernel(ray, hitInfo, incidentLights[i]);
+}
+
+void BRDF::selectKernels()
+{
     switch(this->mode)
     {
         case DEFAULT:
-            color += getDiffuseDefault(hitInfo, incidentLight);
-            color += getSpecularDefault(ray, hitInfo, incidentLight);
+            kernel = getDefault;
+            batchKernel = computeBatch<getDefault>;
             break;
         case PHONG:
-            color += getPhong(ray, hitInfo, incidentLight, false, false);
+            kernel = getPhong<false, false>;
+            batchKernel = computeBatch<getPhong<false, false> >;
             break;
         case PHONG_MODIFIED:
-            if(!normalized) color += getPhong(ray, hitInfo, incidentLight, true, false);
-            else            color += getPhong(ray, hitInfo, incidentLight, true, true);
+            if(!normalized)
+            {
+                kernel = getPhong<true, false>;
+                batchKernel = computeBatch<getPhong<true, false> >;
+            }
+            else
+            {
+                kernel = getPhong<true, true>;
+                batchKernel = computeBatch<getPhong<true, true> >;
+            }
             break;
         case BLINNPHONG:
-            color += getBlinnPhong(ray, hitInfo, incidentLight, false, false);
+            kernel = getBlinnPhong<false, false>;
+            batchKernel = computeBatch<getBlinnPhong<false, false> >;
             break;
         case BLINNPHONG_MODIFIED:
-            if(!normalized) color += getBlinnPhong(ray, hitInfo, incidentLight, true, false);
-            else            color += getBlinnPhong(ray, hitInfo, incidentLight, true, true);
+            if(!normalized)
+            {
+                kernel = getBlinnPhong<true, false>;
+                batchKernel = computeBatch<getBlinnPhong<true, false> >;
+            }
+            else
+            {
+                kernel = getBlinnPhong<true, true>;
+                batchKernel = computeBatch<getBlinnPhong<true, true> >;
+            }
             break;
         case TORRANCE_SPARROW:
-            color += getTorranceSparrow(ray, hitInfo, incidentLight);
+            kernel = getTorranceSparrow;
+            batchKernel = computeBatch<getTorranceSparrow>;
             break;
     }
-
-    return color;
-}
\ No newline at end of file
+}
@@ -2,6 +2,7 @@
 #include "../headers/camera.hpp"
 #include "../../utility/random_number_generator.hpp"
 #include "../../utility/pair.hpp"
+#include "../../utility/shading_math.hpp"
 #include <string>
 #include <iostream>
 #include <cmath>
@@ -325,7 +326,7 @@ float Camera::gaussianWeight(float xDistance, float yDistance)
     thread_local static float k_2 = exp( - 1.f / (2.f * pow(weightingStandartDev, 2)));
     thread_local static float k = k_1 * k_2;
 
-    return k * exp( -(pow(xDistance, 2) + pow(yDistance, 2) ) );
+    return k * shadingExp( -(square(xDistance) + square(yDistance)) );
 }
 
 std::vector<Ray> Camera::getRays(int imageCoordX, int imageCoordY) const
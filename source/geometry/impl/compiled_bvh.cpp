@@ -0,0 +1,590 @@
+#include "../headers/compiled_bvh.hpp"
+#include "../headers/boundingvolume.hpp"
+#include "../headers/lightmesh.hpp"
+#include "../headers/lightsphere.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// the nodes of a ray up to this depth are traversed without allocation
+#define COMPILED_BVH_STACK_SIZE 64
+
+// the boxes are tested against a slightly larger range than the closest hit,
+// .. so that a hit on the face of a box is not lost by rounding
+#define COMPILED_BVH_RANGE_SLACK 1e-5f
+
+// the ray in the form of the slab tests, a zero component of the direction is
+// .. replaced by a tiny one, so that the slab of that axis either contains the
+// .. whole ray or does not contain any point of it
+struct SlabRay
+{
+    float origin[3];
+    float direction[3];
+    float inverseDirection[3];
+
+    SlabRay(const Ray & ray)
+    {
+        const Position3 & rayOrigin = ray.getOrigin();
+        const Vector3 & rayDirection = ray.getDirection();
+
+        origin[0] = rayOrigin.getX();
+        origin[1] = rayOrigin.getY();
+        origin[2] = rayOrigin.getZ();
+
+        direction[0] = rayDirection.getX();
+        direction[1] = rayDirection.getY();
+        direction[2] = rayDirection.getZ();
+
+        for(int i = 0; i < 3; i++)
+            inverseDirection[i] = direction[i] != 0.f ? 1.f / direction[i] : std::copysign(1e30f, direction[i]);
+    }
+};
+
+// whether the ray enters the box of the node in [0, maxT]
+static inline bool intersectBox(const CompiledBVH::Node & node, const SlabRay & ray, float maxT)
+{
+    float tEntering = 0.f;
+    float tExitting = maxT;
+
+    const float minPosition[3] = { node.minPosition.getX(), node.minPosition.getY(), node.minPosition.getZ() };
+    const float maxPosition[3] = { node.maxPosition.getX(), node.maxPosition.getY(), node.maxPosition.getZ() };
+
+    for(int i = 0; i < 3; i++)
+    {
+        float tNear = (minPosition[i] - ray.origin[i]) * ray.inverseDirection[i];
+        float tFar = (maxPosition[i] - ray.origin[i]) * ray.inverseDirection[i];
+
+        if(ray.inverseDirection[i] < 0.f)
+            std::swap(tNear, tFar);
+
+        tEntering = tNear > tEntering ? tNear : tEntering;
+        tExitting = tFar < tExitting ? tFar : tExitting;
+    }
+
+    return tEntering <= tExitting;
+}
+
+struct CompiledBVH::Builder
+{
+    std::vector<Node> nodes;
+    std::vector<Primitive> primitives;
+    std::vector<CompiledTriangle> triangles;
+    std::vector<CompiledSphere> spheres;
+    std::vector<Material> materials;
+    std::vector<TextureHandle> textures;
+    std::vector<LightRecord> lights;
+    std::vector<const Shape*> shapes;
+
+    // the ones already added, by the scene's ones
+    std::map<const Material*, int> materialIndices;
+    std::map<std::pair<const ImageTexture*, const PerlinTexture*>, int> textureIndices;
+
+    int maxDepth = 0;
+};
+
+// the arena is freed without destructing its arrays
+static_assert(std::is_trivially_destructible<CompiledTriangle>::value, "CompiledTriangle is in the arena");
+static_assert(std::is_trivially_destructible<CompiledSphere>::value, "CompiledSphere is in the arena");
+static_assert(std::is_trivially_destructible<Material>::value, "Material is in the arena");
+
+// reserves an array of count elements at the end of the arena, returns its
+// .. offset
+template<typename T>
+static size_t reserveArray(size_t & arenaSize, size_t count)
+{
+    size_t offset = (arenaSize + alignof(T) - 1) / alignof(T) * alignof(T);
+    arenaSize = offset + count * sizeof(T);
+
+    return offset;
+}
+
+template<typename T>
+static T* copyArray(char* arena, size_t offset, const std::vector<T> & elements)
+{
+    T* array = reinterpret_cast<T*>(arena + offset);
+    std::uninitialized_copy(elements.begin(), elements.end(), array);
+
+    return array;
+}
+
+void CompiledBVH::clear()
+{
+    // the arrays are trivially destructible, see above
+    ::operator delete(arena);
+
+    arena = nullptr;
+    arenaSize = 0;
+
+    nodes = nullptr;
+    primitives = nullptr;
+    triangles = nullptr;
+    spheres = nullptr;
+    materials = nullptr;
+    textures = nullptr;
+    lights = nullptr;
+    shapes = nullptr;
+
+    numberOfNodes = 0;
+    numberOfPrimitives = 0;
+    numberOfTriangles = 0;
+    maxDepth = 0;
+}
+
+void CompiledBVH::compile(const Shape* root)
+{
+    clear();
+
+    if(!root)
+        return;
+
+    Builder builder;
+    compileNode(builder, root, -1, -1, 0);
+
+    // the arrays are placed one after another, each aligned for its type,
+    // .. into a block aligned for any of them
+    size_t nodesOffset = reserveArray<Node>(arenaSize, builder.nodes.size());
+    size_t primitivesOffset = reserveArray<Primitive>(arenaSize, builder.primitives.size());
+    size_t trianglesOffset = reserveArray<CompiledTriangle>(arenaSize, builder.triangles.size());
+    size_t spheresOffset = reserveArray<CompiledSphere>(arenaSize, builder.spheres.size());
+    size_t materialsOffset = reserveArray<Material>(arenaSize, builder.materials.size());
+    size_t texturesOffset = reserveArray<TextureHandle>(arenaSize, builder.textures.size());
+    size_t lightsOffset = reserveArray<LightRecord>(arenaSize, builder.lights.size());
+    size_t shapesOffset = reserveArray<const Shape*>(arenaSize, builder.shapes.size());
+
+    arena = static_cast<char*>(::operator new(arenaSize));
+
+    nodes = copyArray(arena, nodesOffset, builder.nodes);
+    primitives = copyArray(arena, primitivesOffset, builder.primitives);
+    triangles = copyArray(arena, trianglesOffset, builder.triangles);
+    spheres = copyArray(arena, spheresOffset, builder.spheres);
+    materials = copyArray(arena, materialsOffset, builder.materials);
+    textures = copyArray(arena, texturesOffset, builder.textures);
+    lights = copyArray(arena, lightsOffset, builder.lights);
+    shapes = copyArray(arena, shapesOffset, builder.shapes);
+
+    numberOfNodes = builder.nodes.size();
+    numberOfPrimitives = builder.primitives.size();
+    numberOfTriangles = builder.triangles.size();
+    maxDepth = builder.maxDepth;
+}
+
+void CompiledBVH::compileMesh(const MeshArrays& mesh, const Material* material, const Texture* texture)
+{
+    clear();
+
+    if(mesh.numberOfNodes == 0)
+        return;
+
+    Builder builder;
+
+    if(material)
+        addMaterial(builder, material);
+
+    if(texture && texture->getTextureType() == TextureType::IMAGE)
+        addTexture(builder, static_cast<const ImageTexture*>(texture), nullptr);
+    else if(texture && texture->getTextureType() == TextureType::PERLIN)
+        addTexture(builder, nullptr, static_cast<const PerlinTexture*>(texture));
+
+    size_t materialsOffset = reserveArray<Material>(arenaSize, builder.materials.size());
+    size_t texturesOffset = reserveArray<TextureHandle>(arenaSize, builder.textures.size());
+
+    arena = static_cast<char*>(::operator new(arenaSize));
+
+    materials = copyArray(arena, materialsOffset, builder.materials);
+    textures = copyArray(arena, texturesOffset, builder.textures);
+
+    nodes = mesh.nodes;
+    primitives = mesh.primitives;
+    triangles = mesh.triangles;
+
+    numberOfNodes = mesh.numberOfNodes;
+    numberOfPrimitives = mesh.numberOfPrimitives;
+    numberOfTriangles = mesh.numberOfTriangles;
+    maxDepth = mesh.maxDepth;
+}
+
+CompiledBVH::MeshArrays CompiledBVH::getMeshArrays() const
+{
+    return MeshArrays{ nodes, primitives, triangles, numberOfNodes, numberOfPrimitives, numberOfTriangles, maxDepth };
+}
+
+int CompiledBVH::addMaterial(Builder& builder, const Material* material)
+{
+    std::map<const Material*, int>::iterator found = builder.materialIndices.find(material);
+
+    if(found != builder.materialIndices.end())
+        return found->second;
+
+    builder.materials.push_back(*material);
+    builder.materialIndices[material] = builder.materials.size() - 1;
+
+    return builder.materials.size() - 1;
+}
+
+int CompiledBVH::addTexture(Builder& builder, const ImageTexture* imageTexture, const PerlinTexture* perlinTexture)
+{
+    if(!imageTexture && !perlinTexture)
+        return -1;
+
+    std::pair<const ImageTexture*, const PerlinTexture*> key(imageTexture, perlinTexture);
+    std::map<std::pair<const ImageTexture*, const PerlinTexture*>, int>::iterator found = builder.textureIndices.find(key);
+
+    if(found != builder.textureIndices.end())
+        return found->second;
+
+    builder.textures.push_back(TextureHandle{ imageTexture, perlinTexture });
+    builder.textureIndices[key] = builder.textures.size() - 1;
+
+    return builder.textures.size() - 1;
+}
+
+int CompiledBVH::compileNode(Builder& builder, const Shape* shape, int material, int light, int depth)
+{
+    const LightMesh* lightMesh = dynamic_cast<const LightMesh*>(shape);
+
+    // the hits on the mesh of a light mesh are the light's, see LightMesh::hit
+    if(lightMesh && lightMesh->mesh && !lightMesh->hasTransformation && !lightMesh->hasMotionBlur && light < 0)
+    {
+        builder.lights.push_back(LightRecord{ lightMesh->radiance, lightMesh });
+
+        return compileNode(builder, lightMesh->mesh, material, builder.lights.size() - 1, depth);
+    }
+
+    const BoundingVolume* boundingVolume = dynamic_cast<const BoundingVolume*>(shape);
+
+    // reached to a primitive
+    if(!boundingVolume || boundingVolume->hasTransformation || boundingVolume->hasMotionBlur)
+    {
+        builder.maxDepth = std::max(builder.maxDepth, depth);
+
+        Primitive primitive = { Primitive::SHAPE, -1, -1, material, -1, light };
+
+        const Triangle* triangle = dynamic_cast<const Triangle*>(shape);
+        const Sphere* sphere = dynamic_cast<const Sphere*>(shape);
+        const LightSphere* lightSphere = dynamic_cast<const LightSphere*>(shape);
+
+        if(triangle && !triangle->hasTransformation && !triangle->hasMotionBlur)
+        {
+            primitive.type = Primitive::TRIANGLE;
+            primitive.index = builder.triangles.size();
+            primitive.material = triangle->hasMaterial ? addMaterial(builder, triangle->material) : -1;
+            primitive.texture = addTexture(
+                builder,
+                triangle->hasImageTexture ? triangle->imageTexture : nullptr,
+                triangle->hasPerlinTexture ? triangle->perlinTexture : nullptr
+            );
+
+            builder.triangles.push_back(triangle->compiled);
+        }
+        else if(sphere && !sphere->hasTransformation && !sphere->hasMotionBlur && !(lightSphere && light >= 0))
+        {
+            primitive.type = Primitive::SPHERE;
+            primitive.index = builder.spheres.size();
+            primitive.material = sphere->hasMaterial ? addMaterial(builder, sphere->material) : -1;
+            primitive.texture = addTexture(
+                builder,
+                sphere->hasImageTexture ? sphere->imageTexture : nullptr,
+                sphere->hasPerlinTexture ? sphere->perlinTexture : nullptr
+            );
+
+            builder.spheres.push_back(sphere->compiled);
+
+            // the hits are the light's, see LightSphere::hit
+            if(lightSphere)
+            {
+                builder.lights.push_back(LightRecord{ lightSphere->radiance, lightSphere });
+                primitive.light = builder.lights.size() - 1;
+            }
+        }
+        else
+        {
+            primitive.index = builder.shapes.size();
+            builder.shapes.push_back(shape);
+        }
+
+        Node leaf;
+        leaf.minPosition = shape->getMinPosition();
+        leaf.maxPosition = shape->getMaxPosition();
+        leaf.index = builder.primitives.size();
+        leaf.axis = -1;
+
+        builder.nodes.push_back(leaf);
+        builder.primitives.push_back(primitive);
+
+        return builder.nodes.size() - 1;
+    }
+
+    // the material of the outermost bounding volume is the one of the hits
+    if(material < 0 && boundingVolume->hasMaterial)
+        material = addMaterial(builder, boundingVolume->material);
+
+    const Shape* left = boundingVolume->leftNode;
+    const Shape* right = boundingVolume->rightNode;
+
+    if(!left || !right)
+        return compileNode(builder, left ? left : right, material, light, depth);
+
+    int nodeIndex = builder.nodes.size();
+    builder.nodes.push_back(Node());
+
+    compileNode(builder, left, material, light, depth + 1);
+    int rightIndex = compileNode(builder, right, material, light, depth + 1);
+
+    // the children are visited in the order of the ray direction along the
+    // .. axis their centers are apart the most
+    Vector3 centerDistance =
+        (right->getMinPosition() - left->getMinPosition()) + (right->getMaxPosition() - left->getMaxPosition());
+
+    float distances[3] = { std::abs(centerDistance.getX()), std::abs(centerDistance.getY()), std::abs(centerDistance.getZ()) };
+
+    Node & node = builder.nodes[nodeIndex];
+    node.minPosition = boundingVolume->getMinPosition();
+    node.maxPosition = boundingVolume->getMaxPosition();
+    node.index = rightIndex;
+    node.axis = std::max_element(distances, distances + 3) - distances;
+
+    // the right child is visited first if it is ahead of the left one in
+    // .. the direction of the axis, see hit()
+    if((node.axis == 0 ? centerDistance.getX() : (node.axis == 1 ? centerDistance.getY() : centerDistance.getZ())) < 0.f)
+        node.axis += 3;
+
+    return nodeIndex;
+}
+
+bool CompiledBVH::hit(const Ray & ray, HitInfo & hitInfo, bool backfaceCulling, bool opaqueSearch) const
+{
+    // set time of hit
+    hitInfo.time = ray.getTimeCreated();
+
+    if(numberOfNodes == 0)
+        return false;
+
+    SlabRay slabRay(ray);
+
+    int localStack[COMPILED_BVH_STACK_SIZE];
+    std::vector<int> heapStack;
+    int* stack = localStack;
+
+    if(maxDepth >= COMPILED_BVH_STACK_SIZE)
+    {
+        heapStack.resize(maxDepth + 1);
+        stack = heapStack.data();
+    }
+
+    float maxT = std::numeric_limits<float>::infinity();
+
+    // the closest hit, which is shaded once it is found. the hits on the
+    // .. shapes are shaded by the shapes themselves
+    int closestPrimitive = -1;
+    float closestT = 0.f;
+    float beta = 0.f, gamma = 0.f;
+    bool isGrazing = false;
+    HitInfo shapeHitInfo;
+
+    int stackSize = 0;
+    int nodeIndex = 0;
+
+    while(true)
+    {
+        const Node & node = nodes[nodeIndex];
+
+        if(node.axis < 0)
+        {
+            const Primitive & primitive = primitives[node.index];
+
+            // the lights are not opaque, and are emitting from both sides
+            bool isLight = primitive.light >= 0;
+            bool primitiveBackfaceCulling = backfaceCulling && !isLight;
+
+            float t;
+            bool isPrimitiveHit = false;
+
+            if(isLight && opaqueSearch)
+            {
+                // not hit
+            }
+            else if(primitive.type == Primitive::TRIANGLE)
+            {
+                float primitiveBeta, primitiveGamma;
+
+                isPrimitiveHit = triangles[primitive.index].intersect(ray, primitiveBackfaceCulling, t, primitiveBeta, primitiveGamma) &&
+                                 (closestPrimitive < 0 || t < closestT);
+
+                if(isPrimitiveHit)
+                {
+                    beta = primitiveBeta;
+                    gamma = primitiveGamma;
+                }
+            }
+            else if(primitive.type == Primitive::SPHERE)
+            {
+                bool isPrimitiveGrazing;
+
+                isPrimitiveHit = spheres[primitive.index].intersect(ray, t, isPrimitiveGrazing) &&
+                                 (closestPrimitive < 0 || t < closestT);
+
+                if(isPrimitiveHit)
+                    isGrazing = isPrimitiveGrazing;
+            }
+            else
+            {
+                HitInfo primitiveHitInfo;
+
+                isPrimitiveHit = shapes[primitive.index]->hit(ray, primitiveHitInfo, primitiveBackfaceCulling, opaqueSearch) &&
+                                 (closestPrimitive < 0 || primitiveHitInfo.t < closestT);
+
+                if(isPrimitiveHit)
+                {
+                    t = primitiveHitInfo.t;
+                    shapeHitInfo = primitiveHitInfo;
+                }
+            }
+
+            if(isPrimitiveHit)
+            {
+                closestPrimitive = node.index;
+                closestT = t;
+
+                maxT = closestT * (1.f + COMPILED_BVH_RANGE_SLACK);
+            }
+        }
+        else if(intersectBox(node, slabRay, maxT))
+        {
+            // continue with the nearer child, the other one waits in the stack
+            int axis = node.axis % 3;
+            bool isRightNearer = (slabRay.direction[axis] < 0.f) != (node.axis >= 3);
+
+            stack[stackSize++] = isRightNearer ? nodeIndex + 1 : node.index;
+            nodeIndex = isRightNearer ? node.index : nodeIndex + 1;
+
+            continue;
+        }
+
+        if(stackSize == 0)
+            break;
+
+        nodeIndex = stack[--stackSize];
+    }
+
+    if(closestPrimitive < 0)
+        return false;
+
+    const Primitive & primitive = primitives[closestPrimitive];
+
+    if(primitive.type == Primitive::SHAPE)
+    {
+        hitInfo = shapeHitInfo;
+    }
+    else
+    {
+        const Material* material = primitive.material >= 0 ? &materials[primitive.material] : nullptr;
+        const TextureHandle* texture = primitive.texture >= 0 ? &textures[primitive.texture] : nullptr;
+
+        const ImageTexture* imageTexture = texture ? texture->imageTexture : nullptr;
+        const PerlinTexture* perlinTexture = texture ? texture->perlinTexture : nullptr;
+
+        HitInfo closestHitInfo;
+        closestHitInfo.time = ray.getTimeCreated();
+
+        if(primitive.type == Primitive::TRIANGLE)
+            triangles[primitive.index].shade(ray, closestT, beta, gamma, material, imageTexture, perlinTexture, closestHitInfo);
+        else
+            spheres[primitive.index].shade(ray, closestT, isGrazing, material, imageTexture, perlinTexture, closestHitInfo);
+
+        hitInfo = closestHitInfo;
+    }
+
+    if(primitive.light >= 0)
+    {
+        hitInfo.isLight = true;
+        hitInfo.lightColor = lights[primitive.light].radiance;
+        hitInfo.light = lights[primitive.light].light;
+    }
+
+    if(primitive.overridingMaterial >= 0)
+        hitInfo.setMaterial(&materials[primitive.overridingMaterial]);
+
+    return true;
+}
+
+bool CompiledBVH::isOccluding(const Ray & ray, float maxT, bool backfaceCulling) const
+{
+    if(numberOfNodes == 0)
+        return false;
+
+    SlabRay slabRay(ray);
+
+    int localStack[COMPILED_BVH_STACK_SIZE];
+    std::vector<int> heapStack;
+    int* stack = localStack;
+
+    if(maxDepth >= COMPILED_BVH_STACK_SIZE)
+    {
+        heapStack.resize(maxDepth + 1);
+        stack = heapStack.data();
+    }
+
+    float boxMaxT = maxT * (1.f + COMPILED_BVH_RANGE_SLACK);
+
+    int stackSize = 0;
+    int nodeIndex = 0;
+
+    while(true)
+    {
+        const Node & node = nodes[nodeIndex];
+
+        if(node.axis < 0)
+        {
+            const Primitive & primitive = primitives[node.index];
+
+            float t;
+
+            // the lights are not opaque, see LightMesh and LightSphere
+            if(primitive.light >= 0)
+            {
+                // not occluding
+            }
+            else if(primitive.type == Primitive::TRIANGLE)
+            {
+                float beta, gamma;
+
+                if(triangles[primitive.index].intersect(ray, backfaceCulling, t, beta, gamma) && t < maxT)
+                    return true;
+            }
+            else if(primitive.type == Primitive::SPHERE)
+            {
+                bool isGrazing;
+
+                if(spheres[primitive.index].intersect(ray, t, isGrazing) && t < maxT)
+                    return true;
+            }
+            else if(shapes[primitive.index]->isOccluding(ray, maxT, backfaceCulling))
+            {
+                return true;
+            }
+        }
+        else if(intersectBox(node, slabRay, boxMaxT))
+        {
+            int axis = node.axis % 3;
+            bool isRightNearer = (slabRay.direction[axis] < 0.f) != (node.axis >= 3);
+
+            stack[stackSize++] = isRightNearer ? nodeIndex + 1 : node.index;
+            nodeIndex = isRightNearer ? node.index : nodeIndex + 1;
+
+            continue;
+        }
+
+        if(stackSize == 0)
+            break;
+
+        nodeIndex = stack[--stackSize];
+    }
+
+    return false;
+}
@@ -1,13 +1,13 @@
 #include "../headers/directional_light.hpp"
 #include "../headers/position3.hpp"
 #include "../../scene.hpp"
+#include <limits>
 
-IncidentLight DirectionalLight::getIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const
+IncidentLight DirectionalLight::sampleIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const
 {
     IncidentLight result;
 
-    // check shadow
-    // create shadow ray
+    // shadow ray, traced by the caller
     Ray shadowRay(hitInfo.hitPosition, this->getReverseDirection());
 
     // set time for ray creation
@@ -16,13 +16,8 @@ IncidentLight DirectionalLight::getIncidentLight(const Scene& scene, const HitIn
     // move ray's origin with epsilon
     shadowRay.translateRayOrigin(scene.getShadowRayEpsilon());
 
-    HitInfo shadowRayHitInfo;
-
-    result.inShadow = scene.getBVH()->hit(shadowRay, shadowRayHitInfo, true, true);
-
-    // if in shadow, do not continue computation
-    if(result.inShadow)
-        return result;
+    result.inShadow = false;
+    result.setShadowRay(shadowRay, std::numeric_limits<float>::infinity(), true);
     
     // set intensity
     result.intensity = this->radiance;
@@ -0,0 +1,239 @@
+#include "../headers/geometry_cache.hpp"
+#include "../headers/triangle.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+#include <utility>
+
+std::vector<Shape*> createCachedMeshTriangles(const SceneCache::Mesh& mesh, ShadingMode shadingMode, const Texture* texture)
+{
+    std::vector<Shape*> trianglesOfMesh(mesh.numberOfTriangles);
+
+    for(int i = 0; i < mesh.numberOfTriangles; i++)
+    {
+        const SceneCache::Triangle & cachedTriangle = mesh.triangles[i];
+
+        Vertex vertices[3] = {
+            Vertex(cachedTriangle.positions[0][0], cachedTriangle.positions[0][1], cachedTriangle.positions[0][2]),
+            Vertex(cachedTriangle.positions[1][0], cachedTriangle.positions[1][1], cachedTriangle.positions[1][2]),
+            Vertex(cachedTriangle.positions[2][0], cachedTriangle.positions[2][1], cachedTriangle.positions[2][2])
+        };
+
+        for(int j = 0; j < 3; j++)
+            vertices[j].addToNormal(Vector3(cachedTriangle.normals[j][0], cachedTriangle.normals[j][1], cachedTriangle.normals[j][2]));
+
+        Triangle * triangle = new Triangle(vertices[0], vertices[1], vertices[2], shadingMode);
+
+        if(texture)
+        {
+            triangle->setTexture(texture);
+
+            if(texture->getTextureType() == TextureType::IMAGE)
+            {
+                triangle->setTexCoord(
+                    Vec2f(cachedTriangle.texCoords[0][0], cachedTriangle.texCoords[0][1]),
+                    Vec2f(cachedTriangle.texCoords[1][0], cachedTriangle.texCoords[1][1]),
+                    Vec2f(cachedTriangle.texCoords[2][0], cachedTriangle.texCoords[2][1])
+                );
+            }
+        }
+
+        trianglesOfMesh[i] = triangle;
+    }
+
+    return trianglesOfMesh;
+}
+
+GeometryCache::GeometryCache(size_t budget)
+    : budget(budget)
+{
+}
+
+GeometryCache::~GeometryCache()
+{
+    for(int i = 0; i < (int)loadedEntries.size(); i++)
+        delete loadedEntries[i]->geometry.load();
+}
+
+int GeometryCache::addMesh(int cachedMeshIndex, const Texture* texture, const Material& material)
+{
+    entries.emplace_back();
+
+    Entry& entry = entries.back();
+    entry.cachedMeshIndex = cachedMeshIndex;
+
+    // the triangles of a textured mesh have the material themselves, the
+    // .. material of an untextured one is the one of its LazyMesh
+    if(texture)
+    {
+        entry.texture = texture;
+        entry.material = &material;
+    }
+
+    return entries.size() - 1;
+}
+
+void GeometryCache::open(const std::string& sceneFilePath, uint64_t key)
+{
+    // the meshes are loaded in the order the rays enter them
+    if(!sceneCache.openForReading(sceneFilePath, key, MappedFile::ANY_ORDER))
+        throw std::runtime_error("Error: Scene cache " + sceneCache.getFilePath() + " cannot be read, the meshes are loaded from it out of core.");
+
+    for(int i = 0; i < (int)entries.size(); i++)
+    {
+        if(entries[i].cachedMeshIndex >= sceneCache.getNumberOfMeshes())
+            throw std::runtime_error("Error: Scene cache " + sceneCache.getFilePath() + " has fewer meshes than the scene.");
+    }
+}
+
+GeometryCache::Pin::Pin(GeometryCache& geometryCache, int meshIndex)
+    : entry(geometryCache.entries[meshIndex])
+{
+    // the mesh is either seen loaded while it is held, or it is evicted
+    // .. afterwards, by which the eviction sees it held, see evict()
+    entry.numberOfUsers++;
+
+    geometry = entry.geometry.load();
+
+    if(!geometry)
+    {
+        geometry = geometryCache.load(entry);
+        return;
+    }
+
+    entry.numberOfHits.fetch_add(1, std::memory_order_relaxed);
+
+    // written only once between two loads, so that the threads hitting the
+    // .. same mesh do not keep writing it
+    uint64_t now = geometryCache.clock.load(std::memory_order_relaxed);
+
+    if(entry.lastUse.load(std::memory_order_relaxed) != now)
+        entry.lastUse.store(now, std::memory_order_relaxed);
+}
+
+const GeometryCache::Geometry* GeometryCache::load(Entry& entry)
+{
+    std::lock_guard<std::mutex> loadingLock(entry.loadingMutex);
+
+    const Geometry* geometry = entry.geometry.load();
+
+    // loaded by another thread meanwhile
+    if(geometry)
+    {
+        entry.numberOfHits.fetch_add(1, std::memory_order_relaxed);
+        return geometry;
+    }
+
+    // created without the lock, so that the other meshes are loaded and
+    // .. hit meanwhile
+    Geometry* createdGeometry = createGeometry(entry);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // an eviction that was undone while it was created
+    geometry = entry.geometry.load();
+
+    if(geometry)
+    {
+        delete createdGeometry;
+        entry.numberOfHits.fetch_add(1, std::memory_order_relaxed);
+
+        return geometry;
+    }
+
+    entry.lastUse.store(++clock, std::memory_order_relaxed);
+    entry.geometry.store(createdGeometry);
+
+    loadedEntries.push_back(&entry);
+    loadedSize += createdGeometry->size;
+    numberOfMisses++;
+
+    evict(&entry);
+
+    peakLoadedSize = std::max(peakLoadedSize, loadedSize);
+
+    return createdGeometry;
+}
+
+GeometryCache::Geometry* GeometryCache::createGeometry(Entry& entry)
+{
+    const SceneCache::Mesh& mesh = sceneCache.getMesh(entry.cachedMeshIndex);
+
+    Geometry* geometry = new Geometry();
+
+    geometry->compiledBVH.compileMesh(mesh.compiled, entry.material, entry.texture);
+
+    geometry->size = sizeof(Geometry)
+                   + geometry->compiledBVH.getSize()
+                   + mesh.compiled.numberOfNodes * sizeof(CompiledBVH::Node)
+                   + mesh.compiled.numberOfPrimitives * sizeof(CompiledBVH::Primitive)
+                   + mesh.compiled.numberOfTriangles * sizeof(CompiledTriangle);
+
+    return geometry;
+}
+
+void GeometryCache::evict(const Entry* keptEntry)
+{
+    if(loadedSize <= budget)
+        return;
+
+    // the clocks are read once, since they change while the rest are hit
+    std::vector<std::pair<uint64_t, Entry*> > candidates;
+
+    for(int i = 0; i < (int)loadedEntries.size(); i++)
+    {
+        if(loadedEntries[i] != keptEntry)
+            candidates.push_back(std::make_pair(loadedEntries[i]->lastUse.load(std::memory_order_relaxed), loadedEntries[i]));
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+
+    for(int i = 0; i < (int)candidates.size() && loadedSize > budget; i++)
+    {
+        Entry& entry = *candidates[i].second;
+
+        // the mesh is unloaded first, then it is checked if it is held. a pin
+        // .. holding it afterwards sees it unloaded and loads it again, after
+        // .. the eviction is either done or undone, see load()
+        const Geometry* geometry = entry.geometry.exchange(nullptr);
+
+        if(entry.numberOfUsers.load() > 0)
+        {
+            entry.geometry.store(geometry);
+            continue;
+        }
+
+        loadedSize -= geometry->size;
+        numberOfEvictions++;
+
+        loadedEntries.erase(std::find(loadedEntries.begin(), loadedEntries.end(), &entry));
+
+        delete geometry;
+        sceneCache.releaseCompiledMesh(entry.cachedMeshIndex);
+    }
+}
+
+void GeometryCache::printStatistics(std::ostream& stream)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    uint64_t numberOfHits = 0;
+
+    for(int i = 0; i < (int)entries.size(); i++)
+        numberOfHits += entries[i].numberOfHits.load(std::memory_order_relaxed);
+
+    uint64_t numberOfUses = numberOfHits + numberOfMisses;
+    double hitRate = numberOfUses ? 100.0 * numberOfHits / numberOfUses : 0.0;
+    double missRate = numberOfUses ? 100.0 * numberOfMisses / numberOfUses : 0.0;
+
+    std::streamsize precision = stream.precision();
+
+    stream << "Geometry cache of " << entries.size() << " meshes: "
+           << numberOfHits << " hits (" << std::fixed << std::setprecision(2) << hitRate << "%), "
+           << numberOfMisses << " misses (" << missRate << "%), "
+           << numberOfEvictions << " evictions, "
+           << std::setprecision(1) << peakLoadedSize / (1024.0 * 1024.0) << " MB loaded at most of a budget of "
+           << budget / (1024.0 * 1024.0) << " MB" << std::defaultfloat << std::endl;
+
+    stream.precision(precision);
+}
@@ -0,0 +1,86 @@
+#include "../headers/lazy_mesh.hpp"
+#include "../../utility/random_number_generator.hpp"
+#include <cmath>
+#include <vector>
+
+bool LazyMesh::hit(const Ray & originalRay, HitInfo & hitInfo, bool backfaceCulling, bool opaqueSearch) const
+{
+    // set time of hit
+    hitInfo.time = originalRay.getTimeCreated();
+
+    // the mesh is not loaded unless the ray enters its bounds
+    if(!liangbarskyHit(originalRay))
+        return false;
+
+    GeometryCache::Pin geometry(*geometryCache, meshIndex);
+
+    Ray hitCheckRay = transformRayForIntersection(originalRay);
+
+    if(!geometry->compiledBVH.hit(hitCheckRay, hitInfo, backfaceCulling, opaqueSearch))
+        return false;
+
+    if(this->hasMaterial)
+        hitInfo.setMaterial(this->material);
+
+    transformHitInfoAfterIntersection(originalRay, hitInfo);
+
+    return true;
+}
+
+bool LazyMesh::isOccluding(const Ray & originalRay, float maxT, bool backfaceCulling) const
+{
+    if(!liangbarskyHit(originalRay))
+        return false;
+
+    GeometryCache::Pin geometry(*geometryCache, meshIndex);
+
+    // maxT is the same for the transformed ray, see transformRayForIntersection
+    return geometry->compiledBVH.isOccluding(transformRayForIntersection(originalRay), maxT, backfaceCulling);
+}
+
+Position3 LazyMesh::getUniformPoint() const
+{
+    // the meshes loaded out of core are not lights, so the point is not
+    // .. sampled while rendering, and the triangle is searched by its area
+    const SceneCache::Mesh& mesh = geometryCache->getCachedMesh(meshIndex);
+
+    std::vector<float> areas(mesh.numberOfTriangles);
+    float totalArea = 0.f;
+
+    for(int i = 0; i < mesh.numberOfTriangles; i++)
+    {
+        const float (&positions)[3][3] = mesh.triangles[i].positions;
+
+        Vector3 v0_to_v1(positions[1][0] - positions[0][0], positions[1][1] - positions[0][1], positions[1][2] - positions[0][2]);
+        Vector3 v0_to_v2(positions[2][0] - positions[0][0], positions[2][1] - positions[0][1], positions[2][2] - positions[0][2]);
+
+        areas[i] = (v0_to_v1 * v0_to_v2).getNorm() / 2.f;
+        totalArea += areas[i];
+    }
+
+    if(mesh.numberOfTriangles == 0)
+        return Position3();
+
+    float psi = getRandomBtw01() * totalArea;
+    int triangle = 0;
+
+    while(triangle < mesh.numberOfTriangles - 1 && psi >= areas[triangle])
+        psi -= areas[triangle++];
+
+    const float (&positions)[3][3] = mesh.triangles[triangle].positions;
+
+    Position3 v0(positions[0][0], positions[0][1], positions[0][2]);
+    Position3 v1(positions[1][0], positions[1][1], positions[1][2]);
+    Position3 v2(positions[2][0], positions[2][1], positions[2][2]);
+
+    // same displacements as Triangle::getUniformPoint
+    float sqrtpsi1 = sqrt(getRandomBtw01());
+    float     psi2 = getRandomBtw01();
+
+    Position3 result = v0 + (v0.to(v1) * sqrtpsi1 + v1.to(v2) * (sqrtpsi1 * psi2));
+
+    if(this->hasTransformation)
+        result = this->transformation.transform(result);
+
+    return result;
+}
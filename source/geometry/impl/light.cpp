@@ -0,0 +1,43 @@
+#include "../headers/light.hpp"
+#include "../headers/ray.hpp"
+#include "../headers/shape.hpp"
+#include "../../scene.hpp"
+
+void IncidentLight::setShadowRay(const Ray& shadowRay, float maxT, bool backfaceCulling)
+{
+    this->hasShadowRay = true;
+    this->shadowRayOrigin = shadowRay.getOrigin();
+    this->shadowRayDirection = shadowRay.getDirection();
+    this->shadowRayTime = shadowRay.getTimeCreated();
+    this->shadowRayMaxT = maxT;
+    this->shadowRayBackfaceCulling = backfaceCulling;
+}
+
+Ray IncidentLight::getShadowRay() const
+{
+    Ray shadowRay(this->shadowRayOrigin, this->shadowRayDirection);
+    shadowRay.setTimeCreated(this->shadowRayTime);
+
+    return shadowRay;
+}
+
+IncidentLight Light::getIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const
+{
+    IncidentLight incidentLight = sampleIncidentLight(scene, hitInfo, time);
+
+    traceShadowRay(scene, incidentLight);
+
+    return incidentLight;
+}
+
+void Light::traceShadowRay(const Scene& scene, IncidentLight& incidentLight)
+{
+    if(incidentLight.inShadow || !incidentLight.hasShadowRay)
+        return;
+
+    incidentLight.inShadow = scene.getBVH().isOccluding(
+        incidentLight.getShadowRay(), incidentLight.shadowRayMaxT, incidentLight.shadowRayBackfaceCulling
+    );
+
+    incidentLight.hasShadowRay = false;
+}
@@ -0,0 +1,268 @@
+#include "../headers/light_sampler.hpp"
+#include <algorithm>
+#include <cmath>
+
+void LightSampler::build(const std::vector<Light*>& sceneLights, LightSampling mode)
+{
+    this->mode = mode;
+
+    lights.assign(sceneLights.begin(), sceneLights.end());
+    unboundedLights.clear();
+    boundedLights.clear();
+    tableIndexOfLight.assign(sceneLights.size(), -1);
+    leafOfLight.assign(sceneLights.size(), -1);
+    nodes.clear();
+
+    std::vector<float> powers;
+
+    for(int i = 0; i < (int)sceneLights.size(); i++)
+    {
+        Position3 minPosition, maxPosition;
+
+        if(!sceneLights[i]->getBounds(minPosition, maxPosition))
+        {
+            unboundedLights.push_back(sceneLights[i]);
+            continue;
+        }
+
+        tableIndexOfLight[i] = boundedLights.size();
+        boundedLights.push_back(i);
+        powers.push_back(std::max(sceneLights[i]->getPower(), 0.f));
+    }
+
+    if(mode == POWER_LIGHT_SAMPLING)
+    {
+        powerTable = AliasTable(powers);
+    }
+    else if(mode == BVH_LIGHT_SAMPLING && !boundedLights.empty())
+    {
+        std::vector<int> lightIndices = boundedLights;
+
+        // centers of the lights, by the index in the scene
+        std::vector<Position3> centers(lights.size());
+
+        for(int i = 0; i < (int)lightIndices.size(); i++)
+        {
+            Position3 minPosition, maxPosition;
+            lights[lightIndices[i]]->getBounds(minPosition, maxPosition);
+
+            centers[lightIndices[i]] = minPosition + ((maxPosition - minPosition) * 0.5f);
+        }
+
+        nodes.reserve(2 * lightIndices.size());
+        buildNode(lightIndices, centers, 0, lightIndices.size(), -1);
+    }
+}
+
+int LightSampler::buildNode(std::vector<int>& lightIndices, const std::vector<Position3>& centers, int first, int count, int parent)
+{
+    int nodeIndex = nodes.size();
+    nodes.push_back(Node());
+    nodes[nodeIndex].parent = parent;
+
+    // reached to leaf
+    if(count == 1)
+    {
+        Node & leaf = nodes[nodeIndex];
+        const Light* light = lights[lightIndices[first]];
+
+        light->getBounds(leaf.minPosition, leaf.maxPosition);
+        leaf.power = std::max(light->getPower(), 0.f);
+        leaf.light = lightIndices[first];
+
+        leafOfLight[leaf.light] = nodeIndex;
+
+        return nodeIndex;
+    }
+
+    // divide the lights into two by their centers along the longest axis
+    // .. of the box enclosing the centers
+    Position3 minCenter, maxCenter;
+
+    for(int i = first; i < first + count; i++)
+    {
+        const Position3 & center = centers[lightIndices[i]];
+
+        minCenter = i == first ? center : Position3::generateMinPosition(minCenter, center);
+        maxCenter = i == first ? center : Position3::generateMaxPosition(maxCenter, center);
+    }
+
+    Vector3 extent = maxCenter - minCenter;
+
+    Axis axis = Axis::X;
+    if(extent.getY() > extent.getX() && extent.getY() >= extent.getZ())
+        axis = Axis::Y;
+    else if(extent.getZ() > extent.getX() && extent.getZ() > extent.getY())
+        axis = Axis::Z;
+
+    auto coordinate = [&](int light)
+    {
+        const Position3 & center = centers[light];
+        return axis == Axis::X ? center.getX() : (axis == Axis::Y ? center.getY() : center.getZ());
+    };
+
+    int half = count / 2;
+
+    std::nth_element(
+        lightIndices.begin() + first,
+        lightIndices.begin() + first + half,
+        lightIndices.begin() + first + count,
+        [&](int lhs, int rhs) { return coordinate(lhs) < coordinate(rhs); }
+    );
+
+    int left = buildNode(lightIndices, centers, first, half, nodeIndex);
+    int right = buildNode(lightIndices, centers, first + half, count - half, nodeIndex);
+
+    Node & node = nodes[nodeIndex];
+    node.left = left;
+    node.right = right;
+    node.power = nodes[left].power + nodes[right].power;
+    node.minPosition = Position3::generateMinPosition(nodes[left].minPosition, nodes[right].minPosition);
+    node.maxPosition = Position3::generateMaxPosition(nodes[left].maxPosition, nodes[right].maxPosition);
+
+    return nodeIndex;
+}
+
+float LightSampler::getImportance(const Node& node, const Position3& position, const Vector3& normal) const
+{
+    if(node.power <= 0.f)
+        return 0.f;
+
+    // the lights entirely below the surface cannot illuminate it
+    bool isAbove = false;
+
+    for(int i = 0; i < 8 && !isAbove; i++)
+    {
+        Position3 corner(
+            (i & 1) ? node.maxPosition.getX() : node.minPosition.getX(),
+            (i & 2) ? node.maxPosition.getY() : node.minPosition.getY(),
+            (i & 4) ? node.maxPosition.getZ() : node.minPosition.getZ()
+        );
+
+        isAbove = (position.to(corner) ^ normal) > 0.f;
+    }
+
+    if(!isAbove)
+        return 0.f;
+
+    // power falls off by the squared distance, which is not taken less than
+    // .. the size of the node, so that the hits near or inside it do not
+    // .. make it infinitely important
+    Vector3 halfDiagonal = (node.maxPosition - node.minPosition) * 0.5f;
+    Position3 center = node.minPosition + halfDiagonal;
+
+    Vector3 toCenter = position.to(center);
+
+    float distanceSq = std::max(toCenter ^ toCenter, halfDiagonal ^ halfDiagonal);
+
+    return node.power / std::max(distanceSq, 1e-6f);
+}
+
+float LightSampler::getChildProbability(int child, const Position3& position, const Vector3& normal) const
+{
+    const Node & parent = nodes[nodes[child].parent];
+    int sibling = parent.left == child ? parent.right : parent.left;
+
+    float childImportance = getImportance(nodes[child], position, normal);
+    float siblingImportance = getImportance(nodes[sibling], position, normal);
+
+    if(childImportance + siblingImportance <= 0.f)
+        return 0.f;
+
+    return childImportance / (childImportance + siblingImportance);
+}
+
+bool LightSampler::sample(const Position3& position, const Vector3& normal, float u, LightSelection& selection) const
+{
+    if(mode == POWER_LIGHT_SAMPLING)
+    {
+        if(powerTable.isEmpty())
+            return false;
+
+        int tableIndex = powerTable.sample(u);
+
+        selection.light = lights[boundedLights[tableIndex]];
+        selection.probability = powerTable.getPdf(tableIndex);
+
+        return selection.probability > 0.f;
+    }
+
+    if(mode != BVH_LIGHT_SAMPLING || nodes.empty())
+        return false;
+
+    // descend choosing the children by their importance, u is reused
+    // .. by rescaling it to [0, 1) after each choice
+    int nodeIndex = 0;
+    float probability = 1.f;
+
+    while(nodes[nodeIndex].light < 0)
+    {
+        const Node & node = nodes[nodeIndex];
+
+        float leftImportance = getImportance(nodes[node.left], position, normal);
+        float rightImportance = getImportance(nodes[node.right], position, normal);
+
+        if(leftImportance + rightImportance <= 0.f)
+            return false;
+
+        float leftProbability = leftImportance / (leftImportance + rightImportance);
+
+        // a child of no importance is never chosen, as it would be of no
+        // .. probability, e.g. the lights below the surface
+        bool isLeft = rightImportance <= 0.f || (leftImportance > 0.f && u < leftProbability);
+
+        if(isLeft)
+        {
+            u = u / leftProbability;
+            probability *= leftProbability;
+            nodeIndex = node.left;
+        }
+        else
+        {
+            u = (u - leftProbability) / (1 - leftProbability);
+            probability *= 1 - leftProbability;
+            nodeIndex = node.right;
+        }
+
+        u = std::min(u, 0.99999994f);
+    }
+
+    selection.light = lights[nodes[nodeIndex].light];
+    selection.probability = probability;
+
+    return selection.probability > 0.f;
+}
+
+bool LightSampler::isAlwaysSampled(const Light* light) const
+{
+    int index = light->getIndex();
+
+    return mode == ALL_LIGHTS || index < 0 || index >= (int)lights.size() || tableIndexOfLight[index] < 0;
+}
+
+float LightSampler::getProbability(const Light* light, const Position3& position, const Vector3& normal) const
+{
+    if(isAlwaysSampled(light))
+        return 1.f;
+
+    int index = light->getIndex();
+
+    if(mode == POWER_LIGHT_SAMPLING)
+        return powerTable.isEmpty() ? 0.f : powerTable.getPdf(tableIndexOfLight[index]);
+
+    int nodeIndex = leafOfLight[index];
+
+    if(nodeIndex < 0)
+        return 0.f;
+
+    // product of the choices from the root down to the leaf
+    float probability = 1.f;
+
+    while(nodes[nodeIndex].parent >= 0 && probability > 0.f)
+    {
+        probability *= getChildProbability(nodeIndex, position, normal);
+        nodeIndex = nodes[nodeIndex].parent;
+    }
+
+    return probability;
+}
@@ -2,12 +2,62 @@
 #include "../headers/position3.hpp"
 #include "../headers/pointlight.hpp"
 #include "../headers/triangle.hpp"
+#include "../headers/ray.hpp"
+#include "../headers/structs.hpp"
 #include "../../utility/random_number_generator.hpp"
 #include <cmath>
 
+void LightMesh::buildTriangleTable()
+{
+    triangleVertices.clear();
+    
+    if(mesh)
+        mesh->appendTriangleVertices(triangleVertices);
+
+    // the areas after the transformations, which are the ones the
+    // .. probability densities are computed with
+    std::vector<float> areas(triangleVertices.size() / 3);
+    
+    double totalArea = 0.0;
+
+    for(int i = 0; i < (int)areas.size(); i++)
+    {
+        const Position3 & v0 = triangleVertices[3 * i];
+        
+        Vector3 cross = v0.to(triangleVertices[3 * i + 1]) * v0.to(triangleVertices[3 * i + 2]);
+        
+        areas[i] = 0.5f * cross.getNorm();
+        totalArea += areas[i];
+    }
+
+    triangleTable = AliasTable(areas);
+    this->area = triangleTable.isEmpty() ? 0.f : totalArea;
+}
+
+Position3 LightMesh::sampleTriangle(Vector3& normal) const
+{
+    int triangle = triangleTable.sample(getRandomBtw01());
+
+    const Position3 & v0 = triangleVertices[3 * triangle];
+    Vector3 v0_to_v1 = v0.to(triangleVertices[3 * triangle + 1]);
+    Vector3 v1_to_v2 = triangleVertices[3 * triangle + 1].to(triangleVertices[3 * triangle + 2]);
+
+    normal = (v0_to_v1 * v1_to_v2).normalize();
+
+    // same displacements as Triangle::getUniformPoint
+    float sqrtpsi1 = sqrt(getRandomBtw01());
+    float     psi2 = getRandomBtw01();
+
+    return v0 + (v0_to_v1 * sqrtpsi1 + v1_to_v2 * (sqrtpsi1 * psi2));
+}
+
 Position3 LightMesh::getUniformPoint() const
 {
-    Position3 uniformPoint = this->mesh->getUniformPoint();
+    if(triangleTable.isEmpty())
+        return Position3();
+
+    Vector3 normal;
+    Position3 uniformPoint = sampleTriangle(normal);
 
     if(this->hasTransformation)
         uniformPoint = this->transformation.transform(uniformPoint);
@@ -15,20 +65,75 @@ Position3 LightMesh::getUniformPoint() const
     return uniformPoint;
 }
 
-IncidentLight LightMesh::getIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const
+IncidentLight LightMesh::sampleIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const
 {
-    Position3 uniformPoint = getUniformPoint();
+    IncidentLight shadow;
+    shadow.inShadow = true;
 
-    // treat it as a point light
-    PointLight pointLight = PointLight(uniformPoint, this->radiance);
+    if(triangleTable.isEmpty())
+        return shadow;
 
-    IncidentLight incidentLight = pointLight.getIncidentLight(scene, hitInfo, time);
-    
-    // disabling attenuation for lightmesh
-    incidentLight.intensity = this->radiance;
+    Vector3 lightNormal;
+    Position3 lightPoint = sampleTriangle(lightNormal);
+
+    Vector3 hitToLight = hitInfo.hitPosition.to(lightPoint);
+    float distanceSq = hitToLight ^ hitToLight;
+
+    if(distanceSq <= 0.f)
+        return shadow;
+
+    Ray w_i = Ray(hitInfo.hitPosition, hitToLight);
+
+    // light is emitted from both sides of the mesh
+    float cosTheta_l = std::abs(lightNormal ^ w_i.getDirection());
+
+    if(cosTheta_l <= 0.f)
+        return shadow;
+
+    // the mesh does not block the shadow rays, so check whether the point
+    // .. is hidden behind another part of it
+    HitInfo lightHitInfo;
+
+    if(this->hit(w_i, lightHitInfo, false, false))
+    {
+        Vector3 hitToMesh = hitInfo.hitPosition.to(lightHitInfo.hitPosition);
+
+        if((hitToMesh ^ hitToMesh) < distanceSq * 0.998f)
+            return shadow;
+    }
+
+    // uniform over the area, converted to solid angle
+    float p_w = distanceSq / (this->area * cosTheta_l);
+
+    // treat it as a point light for the shadow check
+    PointLight pointLight = PointLight(lightPoint, this->radiance);
+
+    IncidentLight incidentLight = pointLight.sampleIncidentLight(scene, hitInfo, time);
+
+    // radiance arriving from the sampled direction, divided by its probability
+    incidentLight.intensity = this->radiance * (1 / p_w);
+    incidentLight.pdf = p_w;
 
     return incidentLight;
+}
+
+float LightMesh::getPdf(const HitInfo& hitInfo, const Vector3& direction, const HitInfo& lightHitInfo) const
+{
+    if(this->area <= 0.f)
+        return 0.f;
+
+    Vector3 hitToLight = hitInfo.hitPosition.to(lightHitInfo.hitPosition);
+    float distanceSq = hitToLight ^ hitToLight;
+
+    // light is emitted from both sides of the mesh
+    Vector3 lightNormal = lightHitInfo.normal;
+    float cosTheta_l = std::abs(lightNormal.normalize() ^ direction);
+
+    if(cosTheta_l <= 0.f)
+        return 0.f;
 
+    // uniform over the area, converted to solid angle
+    return distanceSq / (this->area * cosTheta_l);
 }
 
 // Decorator
@@ -42,6 +147,7 @@ bool LightMesh::hit(const Ray& ray, HitInfo & hitInfo, bool backfaceCulling, boo
 
     hitInfo.isLight = true;
     hitInfo.lightColor = this->radiance;
+    hitInfo.light = this;
 
     return result;
 }
\ No newline at end of file
@@ -1,7 +1,7 @@
 #include "../headers/lightsphere.hpp"
-#include "../headers/pointlight.hpp"
 #include "../headers/structs.hpp"
 #include "../../utility/random_number_generator.hpp"
+#include "../../utility/shading_math.hpp"
 #include "../../scene.hpp"
 #include "../../config.h"
 #include <cmath>
@@ -12,66 +12,122 @@ bool LightSphere::hit(const Ray& ray, HitInfo & hitInfo, bool backfaceCulling, b
     if(opaqueSearch)
         return false;
     
-    bool result = Sphere(*this).hit(ray, hitInfo, backfaceCulling, opaqueSearch);
+    bool result = Sphere::hit(ray, hitInfo, backfaceCulling, opaqueSearch);
 
     hitInfo.isLight = true;
     hitInfo.lightColor = this->radiance;
+    hitInfo.light = this;
 
     return result;
 }
 
-IncidentLight LightSphere::getIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const
+void LightSphere::getWorldSphere(float time, Position3& center, float& radius) const
 {
-    Vector3 d = hitInfo.hitPosition.to(this->getCenter());
+    center = this->getCenter();
+    radius = this->getRadius();
 
-    float sinThetaMax = this->getRadius() / d.getNorm();
-    float cosThetaMax = sqrt(1 - pow(sinThetaMax, 2));
-    float thetaMax    = asin(sinThetaMax);
+    // a point on the surface gives the scaled radius, exact unless the
+    // .. scaling is non-uniform
+    if(this->hasTransformation)
+    {
+        Position3 surfacePoint = this->transformation.transform(center + Vector3(radius, 0.f, 0.f));
+
+        center = this->transformation.transform(center);
+        radius = center.to(surfacePoint).getNorm();
+    }
+
+    if(this->hasMotionBlur)
+        center = center + this->motionBlur * time;
+}
+
+// 1 - cos(thetaMax) of the cone subtended by the sphere, computed from
+// .. sin^2(thetaMax) to keep the precision for the small or far spheres
+static float getOneMinusCosThetaMax(float sinThetaMaxSq)
+{
+    if(sinThetaMaxSq < 0.00068523f) // sin^2(1.5 degrees)
+        return 0.5f * sinThetaMaxSq;
+
+    return 1 - sqrt(1 - sinThetaMaxSq);
+}
+
+float LightSphere::getPdf(const HitInfo& hitInfo, const Vector3& direction, const HitInfo& lightHitInfo) const
+{
+    Position3 center;
+    float radius;
+    getWorldSphere(lightHitInfo.time, center, radius);
+
+    Vector3 d = hitInfo.hitPosition.to(center);
+
+    float sinThetaMaxSq = radius * radius / (d ^ d);
+
+    // inside the sphere, it is not sampled
+    if(sinThetaMaxSq >= 1.f)
+        return 0.f;
+
+    // uniform within the cone subtended by the sphere
+    return 0.5f * M_1_PI / getOneMinusCosThetaMax(sinThetaMaxSq);
+}
+
+IncidentLight LightSphere::sampleIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const
+{
+    IncidentLight incidentLight;
+    incidentLight.inShadow = true;
+
+    Position3 center;
+    float radius;
+    getWorldSphere(time, center, radius);
+
+    Vector3 d = hitInfo.hitPosition.to(center);
+    float distanceSq = d ^ d;
+
+    float sinThetaMaxSq = radius * radius / distanceSq;
+
+    // inside the sphere, no direction to sample
+    if(sinThetaMaxSq >= 1.f)
+        return incidentLight;
+
+    float oneMinusCosThetaMax = getOneMinusCosThetaMax(sinThetaMaxSq);
 
     // generate two random numbers
     float psi1 = getRandomBtw01();
     float psi2 = getRandomBtw01();
 
-    // compute angles for the hemisphere above the hit position
-    float fi    = 2 * M_PI * psi1;
-    float theta = acos(1 - psi2 + psi2 * cosThetaMax);
+    // compute angles within the cone, uniform in its solid angle
+    float fi       = 2 * M_PI * psi1;
+    float cosTheta = 1 - psi2 * oneMinusCosThetaMax;
+    float sinTheta = sqrt(std::fmax(0.f, 1 - cosTheta * cosTheta));
 
-    // generate orthonormal basis from normal
+    // generate orthonormal basis from the direction to the center
     std::vector<Vector3> orthonormalBasis = Vector3::generateOrthonomalBasis(d);
 
     // to follow the convention, extract u, v, w
     Vector3 w = orthonormalBasis[0], u = orthonormalBasis[1], v = orthonormalBasis[2];
 
-    Vector3 l = w * cos(theta) +
-                v * sin(theta) * cos(fi) +
-                u * sin(theta) * sin(fi);
+    float sinFi, cosFi;
+    shadingSinCos(fi, sinFi, cosFi);
 
-    // Now, create a ray to send through the sphere
-    Ray w_i = Ray(hitInfo.hitPosition, l);
+    Vector3 l = w * cosTheta +
+                v * sinTheta * cosFi +
+                u * sinTheta * sinFi;
 
-    // apply transformation if needed
-    w_i = applyShapeTransformation(w_i);
+    // distance to the near side of the sphere along l, instead of tracing it
+    float distance = sqrt(distanceSq);
+    float tSphere = distance * cosTheta - sqrt(std::fmax(0.f, radius * radius - distanceSq * sinTheta * sinTheta));
 
-    HitInfo newHitInfo;
-    // Thanks to the last parameter of hit, opaqueOnly, lightsphere would not
-    // .. itself since it is not an opaque object
-    bool hitCheck = this->hit(w_i, newHitInfo, false, false);
+    // the sphere itself is not opaque, only the shapes before it may block the light
+    Ray shadowRay = Ray(hitInfo.hitPosition, l);
+    shadowRay.setTimeCreated(time);
+    shadowRay.translateRayOrigin(scene.getShadowRayEpsilon());
 
-    if(!hitCheck)
-    {
-        IncidentLight result;
-        result.inShadow = true;
-        return result;
-    }
+    incidentLight.setShadowRay(shadowRay, tSphere - scene.getShadowRayEpsilon(), false);
 
-    float p_w = 0.5f * M_1_PI * ( 1 / (1 - cosThetaMax) );
+    float p_w = 0.5f * M_1_PI / oneMinusCosThetaMax;
 
-    // Create a point light
-    PointLight pointLight = PointLight(newHitInfo.hitPosition, this->radiance);
-
-    IncidentLight incidentLight = pointLight.getIncidentLight(scene, hitInfo, time);
-
-    // incidentLight.intensity = incidentLight.intensity * p_w;
+    // radiance arriving from the sampled direction, divided by its probability
+    incidentLight.inShadow = false;
+    incidentLight.hitToLightDirection = l;
+    incidentLight.intensity = this->radiance * (1 / p_w);
+    incidentLight.pdf = p_w;
 
     return incidentLight;
-}
\ No newline at end of file
+}
@@ -1,7 +1,9 @@
 #include "../headers/material.hpp"
 #include "../headers/brdf.hpp"
 
-BRDF Material::getBRDF() const
+const Material Material::DEFAULT_MATERIAL;
+
+const BRDF& Material::getBRDF() const
 {
     return this->brdf;
 }
@@ -3,14 +3,13 @@
 #include "../headers/ray.hpp"
 #include "../../scene.hpp"
 
-IncidentLight PointLight::getIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const
+IncidentLight PointLight::sampleIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const
 {
     IncidentLight result;
 
     Vector3 hit2light = hitInfo.hitPosition.to(this->position);
 
-    // check if in shadow
-        // first, create the shadow ray
+    // shadow ray, traced by the caller
     Ray shadowRay(hitInfo.hitPosition, hit2light);
 
     // set time for ray creation
@@ -19,25 +18,11 @@ IncidentLight PointLight::getIncidentLight(const Scene& scene, const HitInfo& hi
     // move ray's origin with epsilon
     shadowRay.translateRayOrigin(scene.getShadowRayEpsilon());
 
-    HitInfo shadowRayHitInfo;
+    // light and the object to shadow may reside at the same position
+    // .. therefore, only the shapes before the light shadow it
+    result.inShadow = false;
+    result.setShadowRay(shadowRay, shadowRay.getTValue(this->position), false);
 
-    if(scene.getBVH() && scene.getBVH()->hit(shadowRay, shadowRayHitInfo, false, true) )
-    {   
-        float hitPointToLightT = shadowRay.getTValue(this->position);
-
-        // light and the object to shadow may reside at the same position
-        // .. therefore, use shadow ray epsilon as the least amount for valid shadowing
-        result.inShadow = hitPointToLightT > shadowRayHitInfo.t;
-    }
-    else
-    {
-        result.inShadow = false;
-    }
-
-    // if in shadow, do not continue computation
-    if(result.inShadow)
-        return result;
-    
     // compute intensity
     float distanceSq = hit2light ^ hit2light;
     
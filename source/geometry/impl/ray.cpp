@@ -85,7 +85,7 @@ Ray Ray::createReflectionRay(const HitInfo & hitInfo) const
     reflectionRay.setOrigin(hitInfo.hitPosition);
     
     // glossy reflection
-    float roughness = hitInfo.material.getRoughness();
+    float roughness = hitInfo.material->getRoughness();
 
     if(roughness != 0.f)
     {
@@ -36,6 +36,13 @@ inline void updateTExitting(const float & t, float & tExitting)
         tExitting = t;
 }
 
+bool Shape::isOccluding(const Ray & ray, float maxT, bool backfaceCulling) const
+{
+    HitInfo hitInfo;
+
+    return hit(ray, hitInfo, backfaceCulling, true) && hitInfo.t < maxT;
+}
+
 bool Shape::liangbarskyHit(const Ray & ray) const
 {
     // looking for:
@@ -293,95 +300,43 @@ void Shape::transform(const Transformation& transformation)
 }
 
 
+// the direction of the ray is not normalized in the space of the shape, so that
+// .. the parameters t of the hits are the same in both spaces
 Ray Shape::transformRayForIntersection(const Ray & originalRay) const
 {
-    // Here you are going to see some simple optimization tricks
-    // Therefore, code is not simple as it could have been
-
-    Ray ray = originalRay;
-
-    // both
-    if(this->hasTransformation && this->hasMotionBlur)
-    {
-        Transformation totalTransformation = this->transformation;
-
-        totalTransformation += Translation(this->motionBlur * ray.getTimeCreated());
-
-        ray = totalTransformation.inverseTransform<Ray>(ray);
-    }
-    else if(this->hasTransformation)
-    {
-        // only transformation
-        ray = this->transformation.inverseTransform<Ray>(ray);
-    }
-    else if(this->hasMotionBlur)
-    {
-        // only motion blur
-        Translation motionBlurTranslation(this->motionBlur * ray.getTimeCreated());
-
-        ray = motionBlurTranslation.inverseTransform<Ray>(ray);
-    }
-
-    return ray;
-}
-
-Ray Shape::applyShapeTransformation(const Ray & originalRay) const
-{
-    // Here you are going to see some simple optimization tricks
-    // Therefore, code is not simple as it could have been
-
-    Ray ray = originalRay;
-
-    // both
     if(this->hasTransformation && this->hasMotionBlur)
     {
-        Transformation totalTransformation = this->transformation;
-
-        totalTransformation += Translation(this->motionBlur * ray.getTimeCreated());
-
-        ray = totalTransformation.transform<Ray>(ray);
+        return this->transformation.getTranslated(this->motionBlur * originalRay.getTimeCreated()).inverseTransform<Ray>(originalRay);
     }
     else if(this->hasTransformation)
     {
-        // only transformation
-        ray = this->transformation.transform<Ray>(ray);
+        return this->transformation.inverseTransform<Ray>(originalRay);
     }
     else if(this->hasMotionBlur)
     {
-        // only motion blur
-        Translation motionBlurTranslation(this->motionBlur * ray.getTimeCreated());
+        // only motion blur, translate the origin
+        Ray ray = originalRay;
+        ray.setOrigin(ray.getOrigin() + (this->motionBlur * -originalRay.getTimeCreated()));
 
-        ray = motionBlurTranslation.transform<Ray>(ray);
+        return ray;
     }
 
-    return ray;
+    return originalRay;
 }
 
 void Shape::transformHitInfoAfterIntersection(const Ray & originalRay, HitInfo & hitInfo) const
 {
-    // Here you are going to see some simple optimization tricks
-    // Therefore, code is not simple as it could have been
-
-    // both
     if(this->hasTransformation && this->hasMotionBlur)
     {
-        Transformation totalTransformation = this->transformation;
-
-        totalTransformation += Translation(this->motionBlur * originalRay.getTimeCreated());
-
-        hitInfo = totalTransformation.hitInfoTransform(hitInfo, originalRay);
+        this->transformation.getTranslated(this->motionBlur * originalRay.getTimeCreated()).hitInfoTransform(hitInfo);
     }
     else if(this->hasTransformation)
     {
-        // only transformation
-        hitInfo = this->transformation.hitInfoTransform(hitInfo, originalRay);
+        this->transformation.hitInfoTransform(hitInfo);
     }
     else if(this->hasMotionBlur)
     {
-        // only motion blur
-        Translation motionBlurTranslation(this->motionBlur * originalRay.getTimeCreated());
-
-        hitInfo = motionBlurTranslation.hitInfoTransform(hitInfo, originalRay);
+        // only motion blur, the normal is not affected
+        hitInfo.hitPosition = hitInfo.hitPosition + (this->motionBlur * originalRay.getTimeCreated());
     }
-
-}
\ No newline at end of file
+}
@@ -1,7 +1,7 @@
 #include "../headers/sphere.hpp"
 #include <cmath>
 
-float Sphere::discriminant(const Ray & ray) const
+float CompiledSphere::discriminant(const Ray & ray) const
 {
     const Vector3 & direction = ray.getDirection();
     const Position3 & rayOrigin = ray.getOrigin();
@@ -15,6 +15,11 @@ float Sphere::discriminant(const Ray & ray) const
     return (A * A) - B * (C - (radius * radius));
 }
 
+float Sphere::discriminant(const Ray & ray) const
+{
+    return compiled.discriminant(ray);
+}
+
 bool Sphere::isIntersecting(const Ray & ray) const
 {
     return discriminant(ray) >= 0.0;
@@ -27,6 +32,28 @@ bool Sphere::hit(const Ray & originalRay, HitInfo & hitInfo, bool backfaceCullin
     
     Ray ray = transformRayForIntersection(originalRay);
 
+    float t;
+    bool isGrazing;
+
+    if(!compiled.intersect(ray, t, isGrazing))
+        return false;
+
+    compiled.shade(
+        ray, t, isGrazing,
+        this->hasMaterial ? this->material : nullptr,
+        this->hasImageTexture ? this->imageTexture : nullptr,
+        this->hasPerlinTexture ? this->perlinTexture : nullptr,
+        hitInfo
+    );
+
+    // apply transformation to hitInfo if required
+    transformHitInfoAfterIntersection(originalRay, hitInfo);
+
+    return true;
+}
+
+bool CompiledSphere::intersect(const Ray & ray, float & t, bool & isGrazing) const
+{
     float disc = discriminant(ray);
     
     float A = ( ray.getOrigin() - center ) ^ ( ray.getDirection() * (-1) );
@@ -43,26 +70,54 @@ bool Sphere::hit(const Ray & originalRay, HitInfo & hitInfo, bool backfaceCullin
             return false;
 
         // take the smallest t
-        hitInfo.t = t1 > t2 ? t2 : t1;
+        t = t1 > t2 ? t2 : t1;
 
         // if one of them is negative, take the other one since we are looking for the smallest positive t
         if(t2 < 0)
-            hitInfo.t = t1;
+            t = t1;
         else if(t1 < 0)
-            hitInfo.t = t2;
-        
+            t = t2;
+
+        isGrazing = false;
+
+        return true;
+    }
+    // the ray grazes
+    else if (disc == 0.0f) 
+    {
+        t = A / B;
+        isGrazing = true;
+
+        return t > 0.0f;
+    }
+
+    // no intersection
+    return false;
+}
+
+void CompiledSphere::shade(
+    const Ray & ray, float t, bool isGrazing,
+    const Material * material, const ImageTexture * imageTexture, const PerlinTexture * perlinTexture,
+    HitInfo & hitInfo
+) const
+{
+    hitInfo.t = t;
+
+    // the texture of a grazing hit is not bumped
+    if(!isGrazing)
+    {
         // fill hitinfo
-        hitInfo.normal = (this->getCenter().to(ray.getPoint(hitInfo.t))).normalize();
+        hitInfo.normal = (center.to(ray.getPoint(hitInfo.t))).normalize();
         hitInfo.hitPosition = ray.getPoint(hitInfo.t);
-        if(this->hasMaterial)
-            hitInfo.material = this->material;
+        if(material)
+            hitInfo.setMaterial(material);
 
         // texture info
-        hitInfo.textureInfo.hasTexture = this->hasImageTexture || this->hasPerlinTexture;
+        hitInfo.textureInfo.hasTexture = imageTexture || perlinTexture;
 
-        if(this->hasImageTexture)
+        if(imageTexture)
         {
-            hitInfo.textureInfo.decalMode = imageTexture.getDecalMode();
+            hitInfo.textureInfo.decalMode = imageTexture->getDecalMode();
 
             Vector3 centerToHitPosition = center.to(hitInfo.hitPosition);
 
@@ -75,21 +130,20 @@ bool Sphere::hit(const Ray & originalRay, HitInfo & hitInfo, bool backfaceCullin
             float v = theta / M_PI;
 
             // assign color
-            hitInfo.textureInfo.textureColor = imageTexture.getInterpolatedColor(u, v);
+            hitInfo.textureInfo.textureColor = imageTexture->getInterpolatedColor(u, v);
 
             // check decal mode
-            if(imageTexture.getDecalMode() == DecalMode::REPLACE_KD)
+            if(imageTexture->getDecalMode() == DecalMode::REPLACE_KD)
             {
-                hitInfo.material.setDiffuse(hitInfo.textureInfo.textureColor.getVector3());
+                hitInfo.diffuse = hitInfo.textureInfo.textureColor.getVector3();
             }
-            else if(imageTexture.getDecalMode() == DecalMode::BLEND_KD)
+            else if(imageTexture->getDecalMode() == DecalMode::BLEND_KD)
             {
-                hitInfo.material.setDiffuse(
-                    ((hitInfo.textureInfo.textureColor.getVector3()) + hitInfo.material.getDiffuse()) / 2.f
-                );
+                hitInfo.diffuse =
+                    ((hitInfo.textureInfo.textureColor.getVector3()) + hitInfo.diffuse) / 2.f;
             }
 
-            if(imageTexture.isBump())
+            if(imageTexture->isBump())
             {
                 // compute dpdu and dpdv
                 float dxdu = 2 * M_PI * centerToHitPosition.getZ();
@@ -103,7 +157,7 @@ bool Sphere::hit(const Ray & originalRay, HitInfo & hitInfo, bool backfaceCullin
                 Vector3 dpdu = Vector3(dxdu, dydu, dzdu);
                 Vector3 dpdv = Vector3(dxdv, dydv, dzdv);
 
-                Vec2f grd = imageTexture.getGradient(u, v);
+                Vec2f grd = imageTexture->getGradient(u, v);
 
                 Vector3 dpPrimedu = dpdu + (hitInfo.normal * grd.x);
                 Vector3 dpPrimedv = dpdv + (hitInfo.normal * grd.y);
@@ -111,28 +165,27 @@ bool Sphere::hit(const Ray & originalRay, HitInfo & hitInfo, bool backfaceCullin
                 // update normal
                 hitInfo.normal = (dpPrimedv * dpPrimedu).normalize();
             }
-            
+        
         }
-        else if(this->hasPerlinTexture)
+        else if(perlinTexture)
         {
-            hitInfo.textureInfo.decalMode = perlinTexture.getDecalMode();
-            hitInfo.textureInfo.textureColor = perlinTexture.getPerlinColor(hitInfo.hitPosition);
+            hitInfo.textureInfo.decalMode = perlinTexture->getDecalMode();
+            hitInfo.textureInfo.textureColor = perlinTexture->getPerlinColor(hitInfo.hitPosition);
 
             // check decal mode
-            if(perlinTexture.getDecalMode() == DecalMode::REPLACE_KD)
+            if(perlinTexture->getDecalMode() == DecalMode::REPLACE_KD)
             {
-                hitInfo.material.setDiffuse(hitInfo.textureInfo.textureColor.getVector3());
+                hitInfo.diffuse = hitInfo.textureInfo.textureColor.getVector3();
             }
-            else if(perlinTexture.getDecalMode() == DecalMode::BLEND_KD)
+            else if(perlinTexture->getDecalMode() == DecalMode::BLEND_KD)
             {
-                hitInfo.material.setDiffuse(
-                    ((hitInfo.textureInfo.textureColor.getVector3()) + hitInfo.material.getDiffuse()) / 2.f
-                );
+                hitInfo.diffuse =
+                    ((hitInfo.textureInfo.textureColor.getVector3()) + hitInfo.diffuse) / 2.f;
             }
 
-            if(perlinTexture.isBump())
+            if(perlinTexture->isBump())
             {
-                Vector3 gradient = perlinTexture.getPerlinColor(hitInfo.hitPosition).getVector3();
+                Vector3 gradient = perlinTexture->getPerlinColor(hitInfo.hitPosition).getVector3();
 
                 Vector3 gParallel = hitInfo.normal * (gradient ^ hitInfo.normal);
                 Vector3 gOrth = gradient - gParallel;
@@ -141,100 +194,73 @@ bool Sphere::hit(const Ray & originalRay, HitInfo & hitInfo, bool backfaceCullin
                 hitInfo.normal = (hitInfo.normal - gOrth).normalize();
             }
         }
-
-        // apply transformation to hitInfo if required
-        transformHitInfoAfterIntersection(originalRay, hitInfo);
-
-        return true;    
     }
-    // the ray grazes
-    else if (disc == 0.0f) 
+    else
     {
-        hitInfo.t = A / B;
-        
-        if(hitInfo.t > 0.0f)
+        // fill hitinfo
+        hitInfo.normal = (center.to(ray.getPoint(hitInfo.t))).normalize();
+        hitInfo.hitPosition = ray.getPoint(hitInfo.t);
+        if(material)
+            hitInfo.setMaterial(material);
+
+        // TODO: Write clearer
+        // texture info
+        hitInfo.textureInfo.hasTexture = imageTexture || perlinTexture;
+
+        if(imageTexture)
         {
-            // fill hitinfo
-            hitInfo.normal = (this->getCenter().to(ray.getPoint(hitInfo.t))).normalize();
-            hitInfo.hitPosition = ray.getPoint(hitInfo.t);
-            if(this->hasMaterial)
-                hitInfo.material = this->material;
+            hitInfo.textureInfo.decalMode = imageTexture->getDecalMode();
 
-            // TODO: Write clearer
-            // texture info
-            hitInfo.textureInfo.hasTexture = this->hasImageTexture || this->hasPerlinTexture;
+            Vector3 centerToHitPosition = center.to(hitInfo.hitPosition);
+
+            // compute theta and fi angles
+            float theta = acos(centerToHitPosition.getY() / radius);
+            float fi    = atan2(centerToHitPosition.getZ(), centerToHitPosition.getX());
 
-            if(this->hasImageTexture)
+            // compute u and v
+            float u = (-fi + M_PI) / (2 * M_PI);
+            float v = theta / M_PI;
+
+            // assign color
+            hitInfo.textureInfo.textureColor = imageTexture->getInterpolatedColor(u, v);
+
+            // check decal mode
+            if(imageTexture->getDecalMode() == DecalMode::REPLACE_KD)
             {
-                hitInfo.textureInfo.decalMode = imageTexture.getDecalMode();
-
-                Vector3 centerToHitPosition = center.to(hitInfo.hitPosition);
-
-                // compute theta and fi angles
-                float theta = acos(centerToHitPosition.getY() / radius);
-                float fi    = atan2(centerToHitPosition.getZ(), centerToHitPosition.getX());
-
-                // compute u and v
-                float u = (-fi + M_PI) / (2 * M_PI);
-                float v = theta / M_PI;
-
-                // assign color
-                hitInfo.textureInfo.textureColor = imageTexture.getInterpolatedColor(u, v);
-
-                // check decal mode
-                if(imageTexture.getDecalMode() == DecalMode::REPLACE_KD)
-                {
-                    hitInfo.material.setDiffuse(hitInfo.textureInfo.textureColor.getVector3());
-                }
-                else if(imageTexture.getDecalMode() == DecalMode::BLEND_KD)
-                {
-                    hitInfo.material.setDiffuse(
-                        (hitInfo.textureInfo.textureColor.getVector3() + hitInfo.material.getDiffuse()) / 2.f
-                    );
-                }
+                hitInfo.diffuse = hitInfo.textureInfo.textureColor.getVector3();
             }
-            else if(this->hasPerlinTexture)
+            else if(imageTexture->getDecalMode() == DecalMode::BLEND_KD)
             {
-                hitInfo.textureInfo.decalMode = perlinTexture.getDecalMode();
-                hitInfo.textureInfo.textureColor = perlinTexture.getPerlinColor(hitInfo.hitPosition);
-
-                // check decal mode
-                if(perlinTexture.getDecalMode() == DecalMode::REPLACE_KD)
-                {
-                    hitInfo.material.setDiffuse(hitInfo.textureInfo.textureColor.getVector3());
-                }
-                else if(perlinTexture.getDecalMode() == DecalMode::BLEND_KD)
-                {
-                    hitInfo.material.setDiffuse(
-                        ((hitInfo.textureInfo.textureColor.getVector3()) + hitInfo.material.getDiffuse()) / 2.f
-                    );
-                }
-
-                if(perlinTexture.isBump())
-                {
-                    Vector3 gradient = perlinTexture.getPerlinColor(hitInfo.hitPosition).getVector3();
-
-                    Vector3 gParallel = hitInfo.normal * (gradient ^ hitInfo.normal);
-                    Vector3 gOrth = gradient - gParallel;
-
-                    // update normal
-                    hitInfo.normal = (hitInfo.normal - gOrth).normalize();
-                }
+                hitInfo.diffuse =
+                    (hitInfo.textureInfo.textureColor.getVector3() + hitInfo.diffuse) / 2.f;
             }
-
-            // apply transformation to hitInfo if required
-            transformHitInfoAfterIntersection(originalRay, hitInfo);
-
-            return true;
         }
-        else
+        else if(perlinTexture)
         {
-            return false;
+            hitInfo.textureInfo.decalMode = perlinTexture->getDecalMode();
+            hitInfo.textureInfo.textureColor = perlinTexture->getPerlinColor(hitInfo.hitPosition);
+
+            // check decal mode
+            if(perlinTexture->getDecalMode() == DecalMode::REPLACE_KD)
+            {
+                hitInfo.diffuse = hitInfo.textureInfo.textureColor.getVector3();
+            }
+            else if(perlinTexture->getDecalMode() == DecalMode::BLEND_KD)
+            {
+                hitInfo.diffuse =
+                    ((hitInfo.textureInfo.textureColor.getVector3()) + hitInfo.diffuse) / 2.f;
+            }
+
+            if(perlinTexture->isBump())
+            {
+                Vector3 gradient = perlinTexture->getPerlinColor(hitInfo.hitPosition).getVector3();
+
+                Vector3 gParallel = hitInfo.normal * (gradient ^ hitInfo.normal);
+                Vector3 gOrth = gradient - gParallel;
+
+                // update normal
+                hitInfo.normal = (hitInfo.normal - gOrth).normalize();
+            }
         }
     }
-    // no intersection
-    else
-    {
-        return false;
-    }
-}
\ No newline at end of file
+}
@@ -2,51 +2,151 @@
 #include "../headers/structs.hpp"
 #include "../../scene.hpp"
 #include "../../config.h"
+#include "../../utility/random_number_generator.hpp"
+#include "../../utility/shading_math.hpp"
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
-IncidentLight SphericalEnvLight::getIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const
+void SphericalEnvLight::buildSamplingTables()
 {
-    Vector3 dir = hitInfo.normal.generateRandomVectorWithinHemisphere(DEFAULT_RANDOM_FACTOR);
+    int width = image.getWidth();
+    int height = image.getHeight();
 
-    IncidentLight incidentLight;
-
-    #ifdef ENV_MAP_SHADOW_CHECK
-    Ray shadowRay = Ray(hitInfo.hitPosition, dir).translateRayOrigin(scene.getShadowRayEpsilon());
-    HitInfo dummyHitInfo;
+    std::vector<float> rowWeights(height, 0.f);
+    columnTables.resize(height);
 
-    if(scene.getBVH() && scene.getBVH()->hit(shadowRay, dummyHitInfo, true, true))
+    for(int j = 0; j < height; j++)
     {
-        incidentLight.inShadow = true;
-        return incidentLight;
+        // solid angle covered by the texels of the row
+        float sinTheta = sin((j + 0.5f) / height * M_PI);
+
+        std::vector<float> columnWeights(width);
+
+        for(int i = 0; i < width; i++)
+        {
+            // the lookups in the texel are interpolated with the next ones,
+            // .. therefore, it is as bright as the brightest of them
+            float brightness = 0.f;
+
+            for(int k = 0; k < 4; k++)
+                brightness = std::fmax(brightness, image.getColor(i + (k & 1), j + (k >> 1)).getVector3().getAverage());
+
+            columnWeights[i] = brightness * sinTheta;
+            rowWeights[j] += columnWeights[i];
+        }
+
+        columnTables[j] = AliasTable(columnWeights);
     }
-    #endif
-    
-    incidentLight.inShadow = false;
-    incidentLight.hitToLightDirection = dir;
-    incidentLight.intensity = this->getColor(dir).getVector3().intensify(1 / SPHERE_UNIFORM_SAMPLING_PROP);
 
-    return incidentLight;
+    rowTable = AliasTable(rowWeights);
 }
 
-Color SphericalEnvLight::getColor(const Vector3& dirParam) const
+void SphericalEnvLight::getTextureCoordinates(const Vector3& dirParam, float& u, float& v)
 {
     // get normalized direction
     Vector3 direction = dirParam;
     direction.normalize();
 
     // find theta and psi angles for the sphere
-    float theta = acos(direction.getY());
+    float theta = acos(std::fmax(-1.f, std::fmin(1.f, direction.getY())));
     float psi   = atan2(direction.getZ(), direction.getX());   
 
     // u and v
-    float u = (-psi + M_PI) / (2 * M_PI);
-    float v = theta / M_PI;
+    u = (-psi + M_PI) / (2 * M_PI);
+    v = theta / M_PI;
+}
 
-    // texture lookup
-    Color texColor = this->sampleTexture(u, v);
+Vector3 SphericalEnvLight::getDirection(float u, float v)
+{
+    float theta = v * M_PI;
+    float psi   = M_PI - u * 2 * M_PI;
+
+    float sinTheta, cosTheta, sinPsi, cosPsi;
+    shadingSinCos(theta, sinTheta, cosTheta);
+    shadingSinCos(psi, sinPsi, cosPsi);
+
+    return Vector3(sinTheta * cosPsi, cosTheta, sinTheta * sinPsi);
+}
+
+IncidentLight SphericalEnvLight::sampleIncidentLight(const Scene& scene, const HitInfo& hitInfo, float time) const
+{
+    IncidentLight incidentLight;
+    incidentLight.inShadow = true;
+
+    if(rowTable.isEmpty())
+        return incidentLight;
+
+    // choose a texel, then a point in it
+    int row = rowTable.sample(getRandomBtw01());
+    int column = columnTables[row].sample(getRandomBtw01());
+
+    float u = (column + getRandomBtw01()) / image.getWidth();
+    float v = (row + getRandomBtw01()) / image.getHeight();
+
+    Vector3 dir = getDirection(u, v);
+
+    // the light cannot arrive from below the surface
+    if((dir ^ hitInfo.normal) <= 0.f)
+        return incidentLight;
 
-    //return texColor.intensify(p_w);
-    return texColor;
+    float p_w = getPdf(hitInfo, dir, HitInfo());
+
+    if(p_w <= 0.f)
+        return incidentLight;
+
+    if(this->shadowCheck)
+    {
+        Ray shadowRay = Ray(hitInfo.hitPosition, dir);
+        shadowRay.setTimeCreated(time);
+        shadowRay.translateRayOrigin(scene.getShadowRayEpsilon());
+
+        incidentLight.setShadowRay(shadowRay, std::numeric_limits<float>::infinity(), false);
+    }
+
+    incidentLight.inShadow = false;
+    incidentLight.hitToLightDirection = dir;
+    incidentLight.intensity = this->getColor(dir).getVector3() * (1 / p_w);
+    incidentLight.pdf = p_w;
+
+    return incidentLight;
+}
+
+float SphericalEnvLight::getPdf(const HitInfo& hitInfo, const Vector3& direction, const HitInfo& lightHitInfo) const
+{
+    if(rowTable.isEmpty())
+        return 0.f;
+
+    float u, v;
+    getTextureCoordinates(direction, u, v);
+
+    int width = image.getWidth();
+    int height = image.getHeight();
+
+    int column = std::min((int)(u * width), width - 1);
+    int row = std::min((int)(v * height), height - 1);
+
+    if(columnTables[row].isEmpty())
+        return 0.f;
+
+    float sinTheta = sin(v * M_PI);
+
+    if(sinTheta <= 0.f)
+        return 0.f;
+
+    // uniform in the texel, converted from the texture coordinates to solid angle
+    float p_uv = rowTable.getPdf(row) * columnTables[row].getPdf(column) * width * height;
+
+    return p_uv / (2 * M_PI * M_PI * sinTheta);
+}
+
+Color SphericalEnvLight::getColor(const Vector3& direction) const
+{
+    float u, v;
+    getTextureCoordinates(direction, u, v);
+
+    // texture lookup
+    return this->sampleTexture(u, v);
 }
 
 Color SphericalEnvLight::sampleTexture(float u, float v) const
@@ -1,5 +1,4 @@
 #include "../headers/texture.hpp"
-#include "../../image/image.hpp"
 #include "../../image/color.hpp"
 
 
@@ -16,34 +15,42 @@ int closestPositiveInt(float val)
     return result;
 }
 
+// not normalized
+float ImageTexture::getGrayscaleColor(int x, int y) const
+{
+    Color color = image->getTexel(x, y);
+
+    return (color.getFR() + color.getFG() + color.getFB()) / 3;
+}
+
 Vec2f ImageTexture::getGradient(float u, float v) const
 {
-    float i = u * image.getWidth();
-    float j = v * image.getHeight();
+    float i = u * image->getWidth();
+    float j = v * image->getHeight();
 
     float iNext = i + 1;
     float jNext = j + 1;
 
     // update next coordinates according to limits
-    iNext = iNext <= image.getWidth() ? iNext : i;
-    jNext = jNext <= image.getWidth() ? jNext : j;
+    iNext = iNext <= image->getWidth() ? iNext : i;
+    jNext = jNext <= image->getWidth() ? jNext : j;
 
     return Vec2f(
-        image.getGrayscaleColor(iNext, j) - image.getGrayscaleColor(i, j),
-        image.getGrayscaleColor(i, jNext) - image.getGrayscaleColor(i, j)
+        getGrayscaleColor(iNext, j) - getGrayscaleColor(i, j),
+        getGrayscaleColor(i, jNext) - getGrayscaleColor(i, j)
     );
 }
 // u and v: [0,1]
 Color ImageTexture::getInterpolatedColor(float u, float v) const
 {
-    float i = u * image.getWidth();
-    float j = v * image.getHeight();
+    float i = u * image->getWidth();
+    float j = v * image->getHeight();
 
     // set texture color depending on interpolation mode
     if(interpMode == InterpolationMode::NEAREST)
     {
         // TODO: Limits? Repeat clamp etc.
-        return image.getColor(closestPositiveInt(i), closestPositiveInt(j));
+        return getColor(closestPositiveInt(i), closestPositiveInt(j));
     }
     else if(interpMode == InterpolationMode::BILINEAR)
     {
@@ -57,10 +64,10 @@ Color ImageTexture::getInterpolatedColor(float u, float v) const
 
         // there are 4 cells to get interpolated
         Color color =
-            image.getColor(iFloor    , jFloor    ).intensify((1 - dx) * (1 - dy)) +
-            image.getColor(iFloor + 1, jFloor + 1).intensify(dx       * dy      ) +
-            image.getColor(iFloor + 1, jFloor    ).intensify(dx       * (1 - dy)) +
-            image.getColor(iFloor    , jFloor + 1).intensify((1 - dx) * dy      );
+            getColor(iFloor    , jFloor    ).intensify((1 - dx) * (1 - dy)) +
+            getColor(iFloor + 1, jFloor + 1).intensify(dx       * dy      ) +
+            getColor(iFloor + 1, jFloor    ).intensify(dx       * (1 - dy)) +
+            getColor(iFloor    , jFloor + 1).intensify((1 - dx) * dy      );
         
         
         return color;
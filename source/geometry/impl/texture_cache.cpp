@@ -0,0 +1,540 @@
+#include "../headers/texture_cache.hpp"
+#include "../../image/image.hpp"
+#include "../../utility/half_float.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+// file layout: the header, then the tiles in the order of their rows. the
+// .. lookups have no footprint to choose a mip level by, so there is none
+static const char TEXTURE_CACHE_MAGIC[8] = { 'R', 'T', 'T', 'E', 'X', '\0', '\0', '\0' };
+static const int32_t TEXTURE_CACHE_VERSION = 2;
+
+struct TileFileHeader
+{
+    char magic[8];
+    int32_t version;
+    int32_t tileSize;
+    uint64_t key;
+    int32_t width, height;
+    int32_t isHalf;
+    float scale;
+    float decodingTable[256];
+};
+
+// the key of the file of the tiles, by the path, the size and the modification
+// .. time of the image, and its degamma
+static uint64_t computeTileFileKey(const std::string& imageFilePath, bool isDegamma)
+{
+    // 64-bit FNV-1a
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    auto hashBytes = [&hash](const void* bytes, size_t size)
+    {
+        const unsigned char* data = static_cast<const unsigned char*>(bytes);
+
+        for(size_t i = 0; i < size; i++)
+        {
+            hash ^= data[i];
+            hash *= 0x100000001B3ULL;
+        }
+    };
+
+    hashBytes(imageFilePath.data(), imageFilePath.size() + 1);
+    hashBytes(&isDegamma, sizeof(isDegamma));
+
+    struct stat fileStat;
+
+    if(stat(imageFilePath.data(), &fileStat) == 0)
+    {
+        int64_t metadata[3] = { (int64_t)fileStat.st_size, (int64_t)fileStat.st_mtim.tv_sec, (int64_t)fileStat.st_mtim.tv_nsec };
+        hashBytes(metadata, sizeof(metadata));
+    }
+
+    return hash;
+}
+
+TextureCache::TiledImage::~TiledImage()
+{
+    for(int i = 0; i < numberOfTiles; i++)
+        delete[] tiles[i].texels.load();
+
+    if(tileFileDescriptor >= 0)
+        ::close(tileFileDescriptor);
+}
+
+void TextureCache::TiledImage::setTiles()
+{
+    numberOfTilesX = (width + TEXTURE_TILE_SIZE - 1) / TEXTURE_TILE_SIZE;
+    numberOfTiles = numberOfTilesX * ((height + TEXTURE_TILE_SIZE - 1) / TEXTURE_TILE_SIZE);
+
+    tiles.reset(new Tile[numberOfTiles]);
+
+    for(int i = 0; i < numberOfTiles; i++)
+    {
+        tiles[i].image = this;
+        tiles[i].index = i;
+    }
+}
+
+Color TextureCache::TiledImage::decodeTexel(const uint8_t* texels, int index) const
+{
+    if(isHalf)
+    {
+        const uint16_t* texel = reinterpret_cast<const uint16_t*>(texels) + 3 * index;
+
+        return Color(halfToFloat(texel[0]) * scale, halfToFloat(texel[1]) * scale, halfToFloat(texel[2]) * scale);
+    }
+
+    const uint8_t* texel = texels + 3 * index;
+
+    return Color(decodingTable[texel[0]], decodingTable[texel[1]], decodingTable[texel[2]]);
+}
+
+void TextureCache::TiledImage::copyTile(const std::vector<uint8_t>& texels, int tileX, int tileY, uint8_t* tile) const
+{
+    size_t texelSize = getTexelSize();
+
+    int firstX = tileX * TEXTURE_TILE_SIZE;
+    int firstY = tileY * TEXTURE_TILE_SIZE;
+    int tileWidth = std::min(TEXTURE_TILE_SIZE, width - firstX);
+    int tileHeight = std::min(TEXTURE_TILE_SIZE, height - firstY);
+
+    // the texels beyond the edges are never read
+    std::memset(tile, 0, getTileSize());
+
+    for(int y = 0; y < tileHeight; y++)
+    {
+        std::memcpy(
+            tile + (size_t)y * TEXTURE_TILE_SIZE * texelSize,
+            texels.data() + ((size_t)(firstY + y) * width + firstX) * texelSize,
+            tileWidth * texelSize
+        );
+    }
+}
+
+Color TextureCache::TiledImage::getTexel(int x, int y) const
+{
+    x = std::min(std::max(x, 0), width - 1);
+    y = std::min(std::max(y, 0), height - 1);
+
+    Tile& tile = tiles[(y / TEXTURE_TILE_SIZE) * numberOfTilesX + x / TEXTURE_TILE_SIZE];
+    int index = (y % TEXTURE_TILE_SIZE) * TEXTURE_TILE_SIZE + x % TEXTURE_TILE_SIZE;
+
+    // the tiles kept in memory are never evicted
+    if(!textureCache->isOutOfCore())
+        return decodeTexel(tile.texels.load(std::memory_order_relaxed), index);
+
+    Pin pin(*textureCache, tile);
+
+    return decodeTexel(pin.getTexels(), index);
+}
+
+TextureCache::TextureCache(size_t budget)
+    : budget(budget)
+{
+}
+
+TextureCache::TiledImage* TextureCache::addImage(const std::string& imageFilePath, bool isDegamma, bool& isAdded)
+{
+    std::pair<std::string, bool> file(imageFilePath, isDegamma);
+
+    auto image = imagesByFile.find(file);
+    isAdded = image == imagesByFile.end();
+
+    if(!isAdded)
+        return image->second;
+
+    images.emplace_back();
+
+    TiledImage& addedImage = images.back();
+    addedImage.textureCache = this;
+    addedImage.filePath = imageFilePath;
+    addedImage.isDegamma = isDegamma;
+
+    imagesByFile[file] = &addedImage;
+
+    return &addedImage;
+}
+
+void TextureCache::loadImage(TiledImage& image)
+{
+    if(!isOutOfCore())
+    {
+        convertImage(image, 0);
+        return;
+    }
+
+    image.tileFilePath = image.filePath + (image.isDegamma ? ".degamma" : "") + TEXTURE_CACHE_FILE_EXTENSION;
+
+    uint64_t key = computeTileFileKey(image.filePath, image.isDegamma);
+
+    if(openTileFile(image, key))
+        return;
+
+    convertImage(image, key);
+
+    if(!openTileFile(image, key))
+        throw std::runtime_error("Error: Texture cache " + image.tileFilePath + " cannot be read, the textures are loaded from it out of core.");
+}
+
+void TextureCache::convertImage(TiledImage& image, uint64_t key)
+{
+    cv::Mat imageMat = cv::imread(image.filePath, cv::IMREAD_UNCHANGED);
+
+    if(imageMat.empty())
+        throw std::runtime_error("Error: Texture image " + image.filePath + " cannot be read.");
+
+    if(imageMat.channels() == 1)
+        cv::cvtColor(imageMat, imageMat, CV_GRAY2RGB);
+    else if(imageMat.channels() == 4)
+        cv::cvtColor(imageMat, imageMat, CV_BGRA2RGB);
+    else
+        cv::cvtColor(imageMat, imageMat, CV_BGR2RGB);
+
+    image.width = imageMat.cols;
+    image.height = imageMat.rows;
+    image.isHalf = imageMat.depth() != CV_8U;
+
+    size_t rowSize = (size_t)image.width * image.getTexelSize();
+    std::vector<uint8_t> texels(rowSize * image.height);
+
+    if(!image.isHalf)
+    {
+        // the values of the 8-bit texels, degammaed as the image would be
+        Image table(256, 1);
+
+        for(int i = 0; i < 256; i++)
+            table.setColor(i, 0, Color(i, i, i));
+
+        if(image.isDegamma)
+            table.degamma();
+
+        for(int i = 0; i < 256; i++)
+            image.decodingTable[i] = table.getColor(i, 0).getFR();
+
+        for(int y = 0; y < image.height; y++)
+            std::memcpy(texels.data() + y * rowSize, imageMat.ptr<uint8_t>(y), rowSize);
+    }
+    else
+    {
+        imageMat.convertTo(imageMat, CV_32FC3);
+
+        // as Image::degamma()
+        if(image.isDegamma)
+        {
+            imageMat = imageMat / 255.f;
+            cv::pow(imageMat, 2.2f, imageMat);
+            imageMat = imageMat * 255.f;
+        }
+
+        // the values beyond the largest half, e.g. of 16 bits, are scaled by
+        // .. a power of two, which keeps their precision
+        float maximum = 0.f;
+
+        for(int y = 0; y < image.height; y++)
+        {
+            const float* row = imageMat.ptr<float>(y);
+
+            for(int i = 0; i < 3 * image.width; i++)
+            {
+                if(std::isfinite(row[i]))
+                    maximum = std::max(maximum, std::fabs(row[i]));
+            }
+        }
+
+        image.scale = 1.f;
+
+        while(maximum / image.scale > 65504.f)
+            image.scale *= 2.f;
+
+        for(int y = 0; y < image.height; y++)
+        {
+            const float* row = imageMat.ptr<float>(y);
+            uint16_t* halfRow = reinterpret_cast<uint16_t*>(texels.data() + y * rowSize);
+
+            for(int i = 0; i < 3 * image.width; i++)
+                halfRow[i] = floatToHalf(row[i] / image.scale);
+        }
+    }
+
+    imageMat = cv::Mat();
+
+    if(isOutOfCore())
+    {
+        writeTileFile(image, key, texels);
+        return;
+    }
+
+    image.setTiles();
+
+    for(int i = 0; i < image.numberOfTiles; i++)
+    {
+        uint8_t* tile = new uint8_t[image.getTileSize()];
+        image.copyTile(texels, i % image.numberOfTilesX, i / image.numberOfTilesX, tile);
+
+        image.tiles[i].texels.store(tile, std::memory_order_relaxed);
+    }
+}
+
+bool TextureCache::openTileFile(TiledImage& image, uint64_t key)
+{
+    int fileDescriptor = ::open(image.tileFilePath.data(), O_RDONLY);
+
+    if(fileDescriptor < 0)
+        return false;
+
+    TileFileHeader header;
+    struct stat fileStat;
+
+    bool isValid =
+        pread(fileDescriptor, &header, sizeof(header), 0) == (ssize_t)sizeof(header) &&
+        fstat(fileDescriptor, &fileStat) == 0 &&
+        std::memcmp(header.magic, TEXTURE_CACHE_MAGIC, sizeof(header.magic)) == 0 &&
+        header.version == TEXTURE_CACHE_VERSION && header.tileSize == TEXTURE_TILE_SIZE && header.key == key &&
+        header.width > 0 && header.height > 0;
+
+    if(isValid)
+    {
+        image.width = header.width;
+        image.height = header.height;
+        image.isHalf = header.isHalf != 0;
+        image.scale = header.scale;
+        std::memcpy(image.decodingTable, header.decodingTable, sizeof(image.decodingTable));
+
+        image.setTiles();
+
+        isValid = fileStat.st_size == (off_t)(sizeof(header) + image.numberOfTiles * image.getTileSize());
+    }
+
+    if(!isValid)
+    {
+        ::close(fileDescriptor);
+        return false;
+    }
+
+    image.tileFileDescriptor = fileDescriptor;
+
+    return true;
+}
+
+void TextureCache::writeTileFile(TiledImage& image, uint64_t key, const std::vector<uint8_t>& texels)
+{
+    image.setTiles();
+
+    TileFileHeader header;
+    std::memcpy(header.magic, TEXTURE_CACHE_MAGIC, sizeof(header.magic));
+    header.version = TEXTURE_CACHE_VERSION;
+    header.tileSize = TEXTURE_TILE_SIZE;
+    header.key = key;
+    header.width = image.width;
+    header.height = image.height;
+    header.isHalf = image.isHalf;
+    header.scale = image.scale;
+    std::memcpy(header.decodingTable, image.decodingTable, sizeof(header.decodingTable));
+
+    // the temporary file is of the process, so that the processes rendering
+    // .. with the same image, e.g. the regions of a frame, do not write to the
+    // .. same one
+    std::string tmpFilePath = image.tileFilePath + ".tmp." + std::to_string(getpid());
+    std::ofstream stream(tmpFilePath.data(), std::ofstream::binary | std::ofstream::trunc);
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<uint8_t> tile(image.getTileSize());
+
+    for(int i = 0; i < image.numberOfTiles && stream; i++)
+    {
+        image.copyTile(texels, i % image.numberOfTilesX, i / image.numberOfTilesX, tile.data());
+        stream.write(reinterpret_cast<const char*>(tile.data()), tile.size());
+    }
+
+    stream.flush();
+
+    bool isWritten = (bool)stream;
+    stream.close();
+
+    // the previous file, if any, is replaced at once
+    if(!isWritten || std::rename(tmpFilePath.data(), image.tileFilePath.data()) != 0)
+    {
+        std::remove(tmpFilePath.data());
+        throw std::runtime_error("Error: Texture cache " + image.tileFilePath + " cannot be written, the textures are loaded from it out of core.");
+    }
+}
+
+TextureCache::Pin::Pin(TextureCache& textureCache, Tile& tile)
+    : tile(tile)
+{
+    // the tile is either seen loaded while it is held, or it is evicted
+    // .. afterwards, by which the eviction sees it held, see evict()
+    tile.numberOfUsers++;
+
+    texels = tile.texels.load();
+
+    if(!texels)
+    {
+        texels = textureCache.load(tile);
+        return;
+    }
+
+    tile.numberOfHits.fetch_add(1, std::memory_order_relaxed);
+
+    // written only once the clock hand has cleared it, so that the threads
+    // .. reading the same tile do not keep writing it
+    if(!tile.isReferenced.load(std::memory_order_relaxed))
+        tile.isReferenced.store(true, std::memory_order_relaxed);
+}
+
+const uint8_t* TextureCache::load(Tile& tile)
+{
+    std::lock_guard<std::mutex> loadingLock(tile.loadingMutex);
+
+    const uint8_t* texels = tile.texels.load();
+
+    // loaded by another thread meanwhile
+    if(texels)
+    {
+        tile.numberOfHits.fetch_add(1, std::memory_order_relaxed);
+        return texels;
+    }
+
+    // read without the lock, so that the other tiles are loaded and hit
+    // .. meanwhile
+    const TiledImage& image = *tile.image;
+    size_t tileSize = image.getTileSize();
+    off_t offset = sizeof(TileFileHeader) + (off_t)tile.index * tileSize;
+
+    uint8_t* readTexels = new uint8_t[tileSize];
+
+    if(pread(image.tileFileDescriptor, readTexels, tileSize, offset) != (ssize_t)tileSize)
+    {
+        delete[] readTexels;
+        throw std::runtime_error("Error: Texture cache " + image.tileFilePath + " cannot be read.");
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // an eviction that was undone while it was read
+    texels = tile.texels.load();
+
+    if(texels)
+    {
+        delete[] readTexels;
+        tile.numberOfHits.fetch_add(1, std::memory_order_relaxed);
+
+        return texels;
+    }
+
+    tile.isReferenced.store(true, std::memory_order_relaxed);
+    tile.texels.store(readTexels);
+
+    loadedTiles.push_back(&tile);
+    loadedSize += tileSize;
+    numberOfMisses++;
+
+    evict(&tile);
+
+    peakLoadedSize = std::max(peakLoadedSize, loadedSize);
+
+    return readTexels;
+}
+
+void TextureCache::evict(const Tile* keptTile)
+{
+    // a tile is passed at most twice, once to clear its reference and once to
+    // .. evict it, unless it is held
+    size_t numberOfSteps = 2 * loadedTiles.size();
+
+    for(size_t i = 0; i < numberOfSteps && loadedSize > budget; i++)
+    {
+        if(clockHand >= loadedTiles.size())
+            clockHand = 0;
+
+        Tile& tile = *loadedTiles[clockHand];
+
+        if(&tile == keptTile || tile.isReferenced.exchange(false, std::memory_order_relaxed))
+        {
+            clockHand++;
+            continue;
+        }
+
+        // the tile is unloaded first, then it is checked if it is held. a pin
+        // .. holding it afterwards sees it unloaded and loads it again, after
+        // .. the eviction is either done or undone, see load()
+        const uint8_t* texels = tile.texels.exchange(nullptr);
+
+        if(tile.numberOfUsers.load() > 0)
+        {
+            tile.texels.store(texels);
+            clockHand++;
+            continue;
+        }
+
+        loadedSize -= tile.image->getTileSize();
+        numberOfEvictions++;
+
+        // the last tile takes its place in the circle
+        loadedTiles[clockHand] = loadedTiles.back();
+        loadedTiles.pop_back();
+
+        delete[] texels;
+    }
+}
+
+size_t TextureCache::getSize() const
+{
+    size_t size = 0;
+
+    for(int i = 0; i < (int)images.size(); i++)
+    {
+        for(int j = 0; j < images[i].numberOfTiles; j++)
+        {
+            if(images[i].tiles[j].texels.load(std::memory_order_relaxed))
+                size += images[i].getTileSize();
+        }
+    }
+
+    return size;
+}
+
+void TextureCache::printStatistics(std::ostream& stream)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    uint64_t numberOfHits = 0;
+    int numberOfTiles = 0;
+
+    for(int i = 0; i < (int)images.size(); i++)
+    {
+        numberOfTiles += images[i].numberOfTiles;
+
+        for(int j = 0; j < images[i].numberOfTiles; j++)
+            numberOfHits += images[i].tiles[j].numberOfHits.load(std::memory_order_relaxed);
+    }
+
+    uint64_t numberOfUses = numberOfHits + numberOfMisses;
+    double hitRate = numberOfUses ? 100.0 * numberOfHits / numberOfUses : 0.0;
+    double missRate = numberOfUses ? 100.0 * numberOfMisses / numberOfUses : 0.0;
+
+    std::streamsize precision = stream.precision();
+
+    stream << "Texture cache of " << numberOfTiles << " tiles: "
+           << numberOfHits << " hits (" << std::fixed << std::setprecision(2) << hitRate << "%), "
+           << numberOfMisses << " misses (" << missRate << "%), "
+           << numberOfEvictions << " evictions, "
+           << std::setprecision(1) << peakLoadedSize / (1024.0 * 1024.0) << " MB loaded at most of a budget of "
+           << budget / (1024.0 * 1024.0) << " MB" << std::defaultfloat << std::endl;
+
+    stream.precision(precision);
+}
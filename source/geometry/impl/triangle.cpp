@@ -12,14 +12,13 @@ Triangle::Triangle(
     const Vertex & vertex2,
     const ShadingMode & shadingMode
 ) : Surface(material),
-    vertex{vertex0, vertex1, vertex2},
-    shadingMode(shadingMode),
-    normal(computeNormal(vertex0, vertex1, vertex2))
+    vertex{vertex0, vertex1, vertex2}
 {
     minPosition = computeMinPosition();
     maxPosition = computeMaxPosition();
 
-    fillLookUpTable();
+    compiled.shadingMode = shadingMode;
+    fillCompiledTriangle();
 }
 
 Triangle::Triangle(
@@ -27,14 +26,13 @@ Triangle::Triangle(
     const Vertex & vertex1,
     const Vertex & vertex2,
     const ShadingMode & shadingMode
-) : vertex{vertex0, vertex1, vertex2},
-    shadingMode(shadingMode),
-    normal(computeNormal(vertex0, vertex1, vertex2))
+) : vertex{vertex0, vertex1, vertex2}
 {
     minPosition = computeMinPosition();
     maxPosition = computeMaxPosition();
 
-    fillLookUpTable();
+    compiled.shadingMode = shadingMode;
+    fillCompiledTriangle();
 }
 
 Position3 Triangle::computeMinPosition() const
@@ -103,7 +101,7 @@ Vertex Triangle::getVertex(int vertexId) const
 
 Vector3 Triangle::getNormal() const
 {
-    return this->normal;
+    return this->compiled.normal;
 }
 
 Vector3 Triangle::computeNormal(const Position3 & vertex0,
@@ -127,8 +125,10 @@ Position3 Triangle::getUniformPoint() const
     float sqrtpsi1 = sqrt(getRandomBtw01());
     float     psi2 = getRandomBtw01();
 
+    // the second displacement is scaled by sqrtpsi1 as well, so that the
+    // .. point stays inside the triangle
     v0_to_v1 = v0_to_v1 * sqrtpsi1;
-    v1_to_v2 = v1_to_v2 * psi2;
+    v1_to_v2 = v1_to_v2 * (sqrtpsi1 * psi2);
 
     // apply displacement on v0 to find the point to get the result
     Position3 result = vertex[0] + (v0_to_v1 + v1_to_v2);
@@ -141,35 +141,37 @@ Position3 Triangle::getUniformPoint() const
     return result;
 }
 
-void Triangle::fillLookUpTable()
+void Triangle::appendTriangleVertices(std::vector<Position3>& vertices) const
+{
+    for(int i = 0; i < 3; i++)
+    {
+        Position3 position = vertex[i];
+
+        if(this->hasTransformation)
+            position = this->transformation.transform(position);
+
+        vertices.push_back(position);
+    }
+}
+
+void Triangle::fillCompiledTriangle()
 {
     const Position3 & a = vertex[0];
     const Position3 & b = vertex[1];
     const Position3 & c = vertex[2];
-    
-    // A: ax - bx
-    float A = lookUpTable.Ax_Bx = a.getX() - b.getX();
-    
-    // B: ay - by
-    float B = lookUpTable.Ay_By = a.getY() - b.getY();
-    
-    // C: az - bz
-    float C = lookUpTable.Az_Bz = a.getZ() - b.getZ();
-    
-    // D: ax - cx
-    float D = lookUpTable.Ax_Cx = a.getX() - c.getX();
-    
-    // F: ay - cy
-    float F = lookUpTable.Ay_Cy = a.getY() - c.getY();
-    
-    // E: az - cz
-    float E = lookUpTable.Az_Cz = a.getZ() - c.getZ();
-    
-    lookUpTable.A_C = Vector3( lookUpTable.Ax_Cx, lookUpTable.Ay_Cy, lookUpTable.Az_Cz );
-    lookUpTable.A_B = Vector3( lookUpTable.Ax_Bx, lookUpTable.Ay_By, lookUpTable.Az_Bz );
 
-    this->area = (a.to(b) * a.to(c)).getNorm() / 2.f;
+    compiled.vertex0 = a;
+
+    // a - b and a - c
+    compiled.A_B = Vector3( a.getX() - b.getX(), a.getY() - b.getY(), a.getZ() - b.getZ() );
+    compiled.A_C = Vector3( a.getX() - c.getX(), a.getY() - c.getY(), a.getZ() - c.getZ() );
+
+    compiled.normal = computeNormal(a, b, c);
+
+    for(int i = 0; i < 3; i++)
+        compiled.vertexNormals[i] = vertex[i].getNormal();
 
+    this->area = (a.to(b) * a.to(c)).getNorm() / 2.f;
 }
 
 bool Triangle::hit(const Ray& originalRay, HitInfo & hitInfo, bool backfaceCulling, bool opaqueSearch) const
@@ -179,27 +181,41 @@ bool Triangle::hit(const Ray& originalRay, HitInfo & hitInfo, bool backfaceCulli
     
     Ray ray = transformRayForIntersection(originalRay);
 
+    float t, beta, gamma;
+
+    if(!compiled.intersect(ray, backfaceCulling, t, beta, gamma))
+        return false;
+
+    compiled.shade(
+        ray, t, beta, gamma,
+        this->hasMaterial ? this->material : nullptr,
+        this->hasImageTexture ? this->imageTexture : nullptr,
+        this->hasPerlinTexture ? this->perlinTexture : nullptr,
+        hitInfo
+    );
+
+    transformHitInfoAfterIntersection(originalRay, hitInfo);
+
+    return true;
+}
+
+bool CompiledTriangle::intersect(const Ray & ray, bool backfaceCulling, float & t, float & beta, float & gamma) const
+{
     const Vector3 & rayDirection = ray.getDirection();
     const Position3 & rayOrigin = ray.getOrigin();
     
     // if the angle between ray and normal bigger than 90 degree, 
     //.. there is no need for coloring this triangle,
     //.. simply ignore the intersection
-    //#ifdef __BACKFACE_CULLING__
     if(backfaceCulling && (normal ^ rayDirection) > 0)
     {
         return false;
     }
-    //#endif
     
-    Vector3 A_O = Vector3( vertex[0].getX() - rayOrigin.getX(),
-                           vertex[0].getY() - rayOrigin.getY(),
-                           vertex[0].getZ() - rayOrigin.getZ() );
+    Vector3 A_O = Vector3( vertex0.getX() - rayOrigin.getX(),
+                           vertex0.getY() - rayOrigin.getY(),
+                           vertex0.getZ() - rayOrigin.getZ() );
                            
-    const Vector3 & A_B = lookUpTable.A_B;
-    
-    const Vector3 & A_C = lookUpTable.A_C;
-     
     const float & a = A_B.getX();
     const float & b = A_B.getY();
     const float & c = A_B.getZ();
@@ -243,48 +259,62 @@ bool Triangle::hit(const Ray& originalRay, HitInfo & hitInfo, bool backfaceCulli
     if(T <= 0.0f)
         return false;
 
-    
-    
+    t = T;
+    beta = B;
+    gamma = Y;
+
+    return true;
+}
+
+void CompiledTriangle::shade(
+    const Ray & ray, float t, float beta, float gamma,
+    const Material * material, const ImageTexture * imageTexture, const PerlinTexture * perlinTexture,
+    HitInfo & hitInfo
+) const
+{
+    const float & B = beta;
+    const float & Y = gamma;
+
     // update hit info to inform caller
-    hitInfo.t = T;
+    hitInfo.t = t;
     hitInfo.hitPosition = ray.getPoint(hitInfo.t);
-    if(this->hasMaterial)
-        hitInfo.material = this->material;
+    if(material)
+        hitInfo.setMaterial(material);
 
     if(this->shadingMode == ShadingMode::FLAT)
     {
-        hitInfo.normal = this->getNormal();
+        hitInfo.normal = this->normal;
     }
     else if(this->shadingMode == ShadingMode::SMOOTH)
     {
         Vector3 normal =
-            this->vertex[0].getNormal() * (1 - (Y + B)) +
-            this->vertex[1].getNormal() * B +
-            this->vertex[2].getNormal() * Y;
+            this->vertexNormals[0] * (1 - (Y + B)) +
+            this->vertexNormals[1] * B +
+            this->vertexNormals[2] * Y;
 
         hitInfo.normal = normal.normalize();                
     }
 
     // texture info
-    hitInfo.textureInfo.hasTexture = this->hasImageTexture || this->hasPerlinTexture;
+    hitInfo.textureInfo.hasTexture = imageTexture || perlinTexture;
 
-    if(this->hasImageTexture)
+    if(imageTexture)
     {
-        hitInfo.textureInfo.decalMode = imageTexture.getDecalMode();
+        hitInfo.textureInfo.decalMode = imageTexture->getDecalMode();
 
         // compute u and v
         float u =
-            texCoord[0].x +
-            B * (texCoord[1].x - texCoord[0].x) +
-            Y * (texCoord[2].x - texCoord[0].x);
+            texCoords[0].x +
+            B * (texCoords[1].x - texCoords[0].x) +
+            Y * (texCoords[2].x - texCoords[0].x);
 
         float v =
-            texCoord[0].y +
-            B * (texCoord[1].y - texCoord[0].y) +
-            Y * (texCoord[2].y - texCoord[0].y);
+            texCoords[0].y +
+            B * (texCoords[1].y - texCoords[0].y) +
+            Y * (texCoords[2].y - texCoords[0].y);
 
         // change u and v depending on AppearanceMode
-        if(imageTexture.getAppearanceMode() == AppearanceMode::CLAMP)
+        if(imageTexture->getAppearanceMode() == AppearanceMode::CLAMP)
         {
             u = u < 0.f ? 0.f : u;
             v = v < 0.f ? 0.f : v;
@@ -292,7 +322,7 @@ bool Triangle::hit(const Ray& originalRay, HitInfo & hitInfo, bool backfaceCulli
             u = u > 1.f ? 1.f : u;
             v = v > 1.f ? 1.f : v;
         }
-        else if(imageTexture.getAppearanceMode() == AppearanceMode::REPEAT)
+        else if(imageTexture->getAppearanceMode() == AppearanceMode::REPEAT)
         {
             u = u - (int)u;
             v = v - (int)v;
@@ -302,32 +332,32 @@ bool Triangle::hit(const Ray& originalRay, HitInfo & hitInfo, bool backfaceCulli
         }
 
         // assign color
-        hitInfo.textureInfo.textureColor = imageTexture.getInterpolatedColor(u, v);
+        hitInfo.textureInfo.textureColor = imageTexture->getInterpolatedColor(u, v);
 
         // check decal mode
-        if(imageTexture.getDecalMode() == DecalMode::REPLACE_KD)
+        if(imageTexture->getDecalMode() == DecalMode::REPLACE_KD)
         {
-            hitInfo.material.setDiffuse(hitInfo.textureInfo.textureColor.getVector3());
+            hitInfo.diffuse = hitInfo.textureInfo.textureColor.getVector3();
         }
-        else if(imageTexture.getDecalMode() == DecalMode::BLEND_KD)
+        else if(imageTexture->getDecalMode() == DecalMode::BLEND_KD)
         {
-            hitInfo.material.setDiffuse(
-                ((hitInfo.textureInfo.textureColor.getVector3()) + hitInfo.material.getDiffuse()) / 2.f
-            );
+            hitInfo.diffuse =
+                ((hitInfo.textureInfo.textureColor.getVector3()) + hitInfo.diffuse) / 2.f;
         }
 
-        if(imageTexture.isBump())
+        if(imageTexture->isBump())
         {
             // compute dpdu and dpdv
             
             // TODO: Same for a triangle, compute once
-            float a = texCoord[1].x - texCoord[0].x;
-            float b = texCoord[1].y - texCoord[0].y;
-            float c = texCoord[2].x - texCoord[0].x;
-            float d = texCoord[2].y - texCoord[0].y;
+            float a = texCoords[1].x - texCoords[0].x;
+            float b = texCoords[1].y - texCoords[0].y;
+            float c = texCoords[2].x - texCoords[0].x;
+            float d = texCoords[2].y - texCoords[0].y;
 
-            Vector3 b_a = vertex[1] - vertex[0];
-            Vector3 b_b = vertex[2] - vertex[0];
+            // vertex1 - vertex0 and vertex2 - vertex0
+            Vector3 b_a = -A_B;
+            Vector3 b_b = -A_C;
 
             float det = (a*d - b*c);
             a /= det;
@@ -338,35 +368,34 @@ bool Triangle::hit(const Ray& originalRay, HitInfo & hitInfo, bool backfaceCulli
             Vector3 dpdu = (b_a * d) + (b_b * -b);
             Vector3 dpdv = (b_a * -c) + (b_b * a);
 
-            Vec2f grd = imageTexture.getGradient(u, v);
+            Vec2f grd = imageTexture->getGradient(u, v);
 
-            Vector3 dpPrimedu = dpdu + (hitInfo.normal * (grd.x * imageTexture.getBumpMapMultiplier()));
-            Vector3 dpPrimedv = dpdv + (hitInfo.normal * (grd.y * imageTexture.getBumpMapMultiplier()));
+            Vector3 dpPrimedu = dpdu + (hitInfo.normal * (grd.x * imageTexture->getBumpMapMultiplier()));
+            Vector3 dpPrimedv = dpdv + (hitInfo.normal * (grd.y * imageTexture->getBumpMapMultiplier()));
 
             // update normal
             hitInfo.normal = (dpPrimedv * dpPrimedu).normalize();
         }
     }
-    else if(this->hasPerlinTexture)
+    else if(perlinTexture)
     {
-        hitInfo.textureInfo.decalMode = perlinTexture.getDecalMode();
-        hitInfo.textureInfo.textureColor = perlinTexture.getPerlinColor(hitInfo.hitPosition);
+        hitInfo.textureInfo.decalMode = perlinTexture->getDecalMode();
+        hitInfo.textureInfo.textureColor = perlinTexture->getPerlinColor(hitInfo.hitPosition);
 
         // check decal mode
-        if(perlinTexture.getDecalMode() == DecalMode::REPLACE_KD)
+        if(perlinTexture->getDecalMode() == DecalMode::REPLACE_KD)
         {
-            hitInfo.material.setDiffuse(hitInfo.textureInfo.textureColor.getVector3());
+            hitInfo.diffuse = hitInfo.textureInfo.textureColor.getVector3();
         }
-        else if(perlinTexture.getDecalMode() == DecalMode::BLEND_KD)
+        else if(perlinTexture->getDecalMode() == DecalMode::BLEND_KD)
         {
-            hitInfo.material.setDiffuse(
-                ((hitInfo.textureInfo.textureColor.getVector3()) + hitInfo.material.getDiffuse()) / 2.f
-            );
+            hitInfo.diffuse =
+                ((hitInfo.textureInfo.textureColor.getVector3()) + hitInfo.diffuse) / 2.f;
         }
 
-        if(perlinTexture.isBump())
+        if(perlinTexture->isBump())
         {
-            Vector3 gradient = perlinTexture.getPerlinColor(hitInfo.hitPosition).getVector3();
+            Vector3 gradient = perlinTexture->getPerlinColor(hitInfo.hitPosition).getVector3();
 
             Vector3 gParallel = hitInfo.normal * (gradient ^ hitInfo.normal);
             Vector3 gOrth = gradient - gParallel;
@@ -375,9 +404,4 @@ bool Triangle::hit(const Ray& originalRay, HitInfo & hitInfo, bool backfaceCulli
             hitInfo.normal = (hitInfo.normal - gOrth).normalize();
         }
     }
-    
-    transformHitInfoAfterIntersection(originalRay, hitInfo);
-
-    return true;
-
-}
\ No newline at end of file
+}
@@ -1,189 +1,19 @@
 #include "../../utility/random_number_generator.hpp"
+#include "../../utility/shading_math.hpp"
 #include "../headers/vector3.hpp"
 #include <cmath>
 #include <vector>
 #include <iostream>
 
-// getX
-float Vector3::getX() const
-{
-    return x;
-}
-
-// getY
-float Vector3::getY() const
-{
-    return y;
-}
-
-// getZ
-float Vector3::getZ() const
-{
-    return z;
-}
-
-// setX
-void Vector3::setX(float x)
-{
-    this -> x = x;
-}
-
-// setY
-void Vector3::setY(float y)
-{
-    this -> y = y;
-}
-
-// setZ
-void Vector3::setZ(float z)
-{
-    this -> z = z;
-}
-
-// unary (-) operator
-Vector3 Vector3::operator-() const
-{
-    return *this * (-1);
-}
-
-// Vector3 substraction
-Vector3 Vector3::operator-(const Vector3 & rhs) const
-{
-    Vector3 result;
-    
-    result.setX( this->getX() - rhs.getX() );
-    result.setY( this->getY() - rhs.getY() );
-    result.setZ( this->getZ() - rhs.getZ() );
-    
-    return result;
-}
-
-// Vector3 addition
-Vector3 Vector3::operator+(const Vector3 & rhs) const
-{
-    Vector3 result;
-    
-    result.setX( this->getX() + rhs.getX() );
-    result.setY( this->getY() + rhs.getY() );
-    result.setZ( this->getZ() + rhs.getZ() );
-    
-    return result;
-}
-
-// dot product
-float Vector3::operator^(const Vector3 & rhs) const
-{
-    return this->x * rhs.x
-         + this->y * rhs.y
-         + this->z * rhs.z;
-}
-
 Vector3 Vector3::power(float prime) const
 {
     return Vector3(
-        pow(this->getX(), prime),
-        pow(this->getY(), prime),
-        pow(this->getZ(), prime)
-    );
-}
-
-// cross product
-Vector3 Vector3::operator*(const Vector3 & rhs) const
-{
-    Vector3 result;
-    
-    result.setX( this->getY() * rhs.getZ() - this->getZ() * rhs.getY() );
-    result.setY( this->getZ() * rhs.getX() - this->getX() * rhs.getZ() );
-    result.setZ( this->getX() * rhs.getY() - this->getY() * rhs.getX() );
-    
-    return result;
-}
-
-// normalize
-Vector3 & Vector3::normalize()
-{
-    float norm = this->getNorm();
-    
-    // normalize by dividing the vector by its norm
-    *this = *this / norm;
-    
-    return *this;
-}
-
-// scalar multiplication
-Vector3 Vector3::operator*(float rhs) const
-{
-    return Vector3(
-        this->x * rhs,
-        this->y * rhs,
-        this->z * rhs
-    );
-}
-
-// scalar division
-Vector3 Vector3::operator/(float rhs) const
-{
-    if(rhs == 0.0)
-    {
-        // division by zero!
-        return Vector3(0.0, 0.0, 0.0);
-    }
-
-    return Vector3(
-        this->x / rhs,
-        this->y / rhs,
-        this->z / rhs
+        shadingPow(this->getX(), prime),
+        shadingPow(this->getY(), prime),
+        shadingPow(this->getZ(), prime)
     );
 }
 
-// scalar division
-Vector3& Vector3::operator/=(float rhs)
-{
-    x /= rhs;
-    y /= rhs;
-    z /= rhs;
-    
-    return *this;
-}
-
-// get norm
-float Vector3::getNorm() const
-{
-    float normSquare = this->x * this->x
-                     + this->y * this->y
-                     + this->z * this->z;
-                     
-    return sqrt( normSquare );
-}
-
-// element-wise division
-Vector3 Vector3::operator/(const Vector3 & rhs) const
-{
-    return
-        Vector3(
-            this->x / rhs.x,
-            this->y / rhs.y,
-            this->z / rhs.z
-        );
-}
-
-// element-wise compare
-bool Vector3::operator!=(const float rhs) const
-{
-    return 
-        this->x != rhs &&
-        this->y != rhs &&
-        this->z != rhs;
-}
-
-bool Vector3::isZeroVector() const
-{
-    return
-        this->x == 0.f &&
-        this->y == 0.f &&
-        this->z == 0.f;
-}
-
 // operator overloadings with different order
 Vector3 operator*(float lhs, const Vector3 & rhs)
 {
@@ -195,16 +25,6 @@ Vector3 operator/(float lhs, const Vector3 & rhs)
     return rhs / lhs;
 }
 
-// intensify
-Vector3 Vector3::intensify(const Vector3 & intensityVector) const
-{
-
-    return Vector3( this->x * intensityVector.x,
-                    this->y * intensityVector.y,
-                    this->z * intensityVector.z
-                    );
-}
-
 std::ostream &operator<<(std::ostream &output, const Vector3 & vector)
 {
     output << "V( " << vector.getX() << ", " << vector.getY() << ", " << vector.getZ() << " )";
@@ -266,15 +86,6 @@ Vector3 Vector3::generateDifferentlyDirectedVector() const
     }
 }
 
-Vector3 Vector3::elementwiseMultiply(const Vector3& rhs) const
-{
-    return Vector3(
-        x * rhs.x,
-        y * rhs.y,
-        z * rhs.z
-    );
-}
-
 Vector3 Vector3::generateRandomVectorWithinHemisphere(RandomFactor randomFactor) const
 {
     // copy this
@@ -291,22 +102,52 @@ Vector3 Vector3::generateRandomVectorWithinHemisphere(RandomFactor randomFactor)
     float psi2 = getRandomBtw01();
 
     // compute angles for hemisphere
-    float theta = 0.f;
+    float cosTheta = 1.f, sinTheta = 0.f;
     float fi    = 2 * M_PI * psi2;
 
-    // theta changes depending on the random factor
+    // theta changes depending on the random factor, its sine and cosine are
+    // .. computed without the angle
     if(randomFactor == RandomFactor::UNIFORM)
-        theta = acos(psi1); 
+    {
+        // theta = acos(psi1)
+        cosTheta = psi1;
+        sinTheta = sqrt(std::fmax(0.f, 1 - psi1 * psi1));
+    }
     else if(randomFactor == RandomFactor::IMPORTANCE)
-        theta = asin( sqrt(psi1) );
+    {
+        // theta = asin(sqrt(psi1))
+        cosTheta = sqrt(1 - psi1);
+        sinTheta = sqrt(psi1);
+    }
+
+    float sinFi, cosFi;
+    shadingSinCos(fi, sinFi, cosFi);
 
     // compute the new vector
-    Vector3 w_i = (vec * cos(theta)) +
-                  (orthonormalBasis[1] * (sin(theta) * cos(fi))) +
-                  (orthonormalBasis[2] * (sin(theta) * sin(fi)));
+    Vector3 w_i = (vec * cosTheta) +
+                  (orthonormalBasis[1] * (sinTheta * cosFi)) +
+                  (orthonormalBasis[2] * (sinTheta * sinFi));
 
     // return sampled vector
     w_i.normalize();
 
     return w_i;
-}
\ No newline at end of file
+}
+
+float Vector3::getPdfWithinHemisphere(const Vector3& direction, RandomFactor randomFactor) const
+{
+    Vector3 vec = *this;
+    Vector3 dir = direction;
+
+    float cosTheta = vec.normalize() ^ dir.normalize();
+
+    // out of the hemisphere
+    if(cosTheta <= 0.f)
+        return 0.f;
+
+    // uniform: 1 / (2 * pi), importance (cosine weighted): cos(theta) / pi
+    if(randomFactor == RandomFactor::IMPORTANCE)
+        return cosTheta * M_1_PI;
+
+    return 0.5f * M_1_PI;
+}
@@ -9,18 +9,10 @@ class Color
     private:
         float R, G, B;
     public:
-        Color(float R = 0.0f, float G = 0.0f, float B = 0.0f)
-        {
-            this->R = R;
-            this->G = G;
-            this->B = B;
-                        
-            this->R = R;
-            this->G = G;
-            this->B = B;
-        }
+        constexpr Color(float R = 0.0f, float G = 0.0f, float B = 0.0f)
+            : R(R), G(G), B(B) {}
         
-        Color(const Vector3 & colorVector)
+        constexpr Color(const Vector3 & colorVector)
         :   Color(colorVector.getX(), colorVector.getY(), colorVector.getZ()) {}
         
         Color operator+(const Color & rhs) const
@@ -81,17 +73,17 @@ class Color
             return Color(R / divider, G / divider, B / divider);
         }
         
-        float getFR() const
+        constexpr float getFR() const
         {
             return this->R;
         }
         
-        float getFG() const
+        constexpr float getFG() const
         {
             return this->G;
         }
         
-        float getFB() const
+        constexpr float getFB() const
         {
             return this->B;
         }
@@ -144,30 +136,32 @@ class Color
 
         bool isBlack() const
         {
-            return getR() == 0 && getG() == 0 && getB() == 0;
+            // compare the float values, the truncated ones would make
+            // .. any color dimmer than 1 black
+            return R <= 0.f && G <= 0.f && B <= 0.f;
         }
 
-        static Color Black()
+        static constexpr Color Black()
         {
             return Color(0.0f, 0.0f, 0.0f);
         }
         
-        static Color White()
+        static constexpr Color White()
         {
             return Color(255.0f, 255.0f, 255.0f);
         }
 
-        static Color Red()
+        static constexpr Color Red()
         {
             return Color(255.f, 0.f, 0.f);
         }
 
-        static Color Blue()
+        static constexpr Color Blue()
         {
             return Color(0.f, 0.f, 255.f);
         }
 
-        static Color Green()
+        static constexpr Color Green()
         {
             return Color(0.f, 255.f, 0.f);
         }
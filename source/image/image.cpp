@@ -25,12 +25,16 @@ Image::Image(std::string fileName)
 }
 
 Image::Image(int width, int height)
+    : width(width), height(height)
 {
-    imageMat = cv::Mat(height, width, CV_32FC3);
+    imageMat = cv::Mat(height, width, CV_32FC3, cv::Scalar(0.f));
 }
 
 void Image::setColor(int positionX, int positionY, Color color)
 {
+    positionX -= originX;
+    positionY -= originY;
+
     imageMat.at<cv::Vec3f>(positionY, positionX)[0] = color.getFR();
     imageMat.at<cv::Vec3f>(positionY, positionX)[1] = color.getFG();
     imageMat.at<cv::Vec3f>(positionY, positionX)[2] = color.getFB();
@@ -53,6 +57,9 @@ float Image::getGrayscaleColor(int positionX, int positionY) const
 
 Color Image::getColor(int positionX, int positionY) const
 {
+    positionX -= originX;
+    positionY -= originY;
+
     if(positionX >= width)
         positionX = width - 1;
 
@@ -74,6 +81,22 @@ void Image::write(std::string fileName)
     cv::imwrite(fileName, bgrImg);
 }
 
+void Image::writeOutput(std::string fileName, bool doTonemap, ToneMappingParam toneMappingParam)
+{
+    write(fileName);
+
+    // check HDR
+    if(doTonemap)
+    {
+        // change image name
+        int extensionInd = fileName.find('.');
+        fileName = fileName.substr(0, extensionInd) + ".png";
+
+        // tonemap&write image
+        write(fileName, toneMappingParam);
+    }
+}
+
 void Image::degamma()
 {
     imageMat = imageMat / 255.f;
@@ -21,6 +21,10 @@ class Image
         
         int width, height;
 
+        // pixel coordinates of the top left pixel, e.g. of a tile of a larger
+        // .. image which is addressed by the coordinates of the larger one
+        int originX = 0, originY = 0;
+
         float normalizer = 1.f;
     
     public:
@@ -43,10 +47,16 @@ class Image
         // write tonemapped image
         void write(std::string fileName, ToneMappingParam toneMappingParam);
 
+        // write the image, and if tonemapping is on, the tonemapped png as well
+        void writeOutput(std::string fileName, bool doTonemap, ToneMappingParam toneMappingParam);
+
         int getWidth() const { return width; }
         int getHeight() const { return height; }
 
         void setNormalizer(float normalizer) { this->normalizer = normalizer; }
+
+        // setColor and getColor take the pixel coordinates relative to the origin
+        void setOrigin(int originX, int originY) { this->originX = originX; this->originY = originY; }
 };
 
 #endif
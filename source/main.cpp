@@ -1,18 +1,52 @@
-#include "config.h"
-#include "scene.hpp"
-#include <iostream>
-#include <cstdlib>
-
-int main(int argc, char* argv[])
-{
-    #ifdef SEEDED_RANDOMIZATION
-    srand(1);
-    #endif
-
-    Scene scene;
-
-    scene.loadFromXml(argv[1]);
-    scene.generateImages(NUM_OF_THREADS);
-   
-    return 0;
-}
+#include "config.h"
+#include "scene.hpp"
+#include "utility/render_options.hpp"
+#include "utility/partial_image.hpp"
+#include "utility/random_number_generator.hpp"
+#include <iostream>
+#include <cstdlib>
+#include <exception>
+
+int main(int argc, char* argv[])
+{
+    #ifdef SEEDED_RANDOMIZATION
+    srand(1);
+    #endif
+
+    // the errors, e.g. of a mistyped option or a missing file, are reported
+    // .. rather than aborting
+    try
+    {
+        RenderOptions options = parseRenderOptions(argc, argv);
+
+        // merging partial images does not need the scene
+        if(options.merge)
+        {
+            PartialImage::merge(options.partialImagePaths);
+            return 0;
+        }
+
+        // a checkpointed render should be reproducible, including the random
+        // .. numbers consumed while loading the scene
+        if(options.checkpoint)
+            seedRandomNumberGenerator(CHECKPOINT_RANDOM_SEED);
+
+        Scene scene;
+
+        scene.loadFromXml(options.sceneFilePath, options);
+
+        if(options.workerFd >= 0)
+            scene.runRenderWorker(options);
+        else if(options.numberOfWorkers > 0)
+            scene.coordinateRenderWorkers(options);
+        else
+            scene.generateImages(options);
+    }
+    catch(const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
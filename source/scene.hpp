@@ -7,12 +7,121 @@
 #include "image/color.hpp"
 #include "utility/concurrent_bag.hpp"
 #include "utility/pixel_mission_generator.hpp"
+#include "utility/render_checkpoint.hpp"
+#include "utility/render_options.hpp"
+#include "utility/image_region.hpp"
+#include "utility/shadow_ray_queue.hpp"
+#include "utility/ray_sorter.hpp"
 #include "filemanip/tinyxml2.h"
 #include "geometry/headers/transformation.hpp"
 #include "geometry/headers/light.hpp"
+#include "geometry/headers/light_sampler.hpp"
+#include "geometry/headers/compiled_bvh.hpp"
+#include "geometry/headers/geometry_cache.hpp"
+#include "geometry/headers/texture_cache.hpp"
+#include "geometry/headers/texture.hpp"
 #include "geometry/headers/brdf.hpp"
 #include "geometry/headers/enums.hpp"
 #include <string>
+#include <vector>
+
+// a ray of a path waiting to be traced, together with the state of the path
+struct PathRay
+{
+    Ray ray;
+
+    // product of the (brdf * cos / pdf) factors of the bounces before the ray
+    Vector3 throughput = Vector3(1.f);
+
+    // number of bounces before the ray, in total and of each type
+    int depth = 0;
+    int numberOfBounces[NUMBER_OF_BOUNCE_TYPES] = { 0, 0, 0 };
+
+    bool backfaceCulling;
+    bool onlyOpaque = false;
+
+    // if the ray is sampled from the hemisphere of a hit, the hit and the pdf
+    // .. are kept to weight the light the ray finds (multiple importance sampling)
+    bool isHemisphereSample = false;
+    Position3 sampledPosition;
+    Vector3 sampledNormal;
+    float pdf = 0.f;
+
+    PathRay(const Ray & ray, bool backfaceCulling)
+        : ray(ray), backfaceCulling(backfaceCulling) {}
+
+    // the ray continuing the path after a bounce of the given type, which
+    // .. scales the throughput by factor
+    PathRay bounce(const Ray & nextRay, const Vector3 & factor, BounceType type, bool nextBackfaceCulling) const
+    {
+        PathRay next = *this;
+
+        next.ray = nextRay;
+        next.throughput = throughput.intensify(factor);
+        next.depth++;
+        next.numberOfBounces[type]++;
+        next.backfaceCulling = nextBackfaceCulling;
+        next.onlyOpaque = false;
+        next.isHemisphereSample = false;
+
+        return next;
+    }
+};
+
+// the two rays a hit on a dielectric splits into, with the fraction of the
+// .. light each carries
+struct DielectricSplit
+{
+    Ray reflectionRay;
+    Ray refractionRay;
+
+    Vector3 reflectionWeight;
+    Vector3 refractionWeight;   // zero in case of total internal reflection
+
+    // fraction of the light reflected, 1 in case of total internal reflection
+    float reflectance;
+};
+
+// buffers of a wavefront of paths, a path is the ray it continues with and the
+// .. pixel (target) and the weight of the camera ray it started with
+struct Wavefront
+{
+    std::vector<PathRay> pathRays;
+    std::vector<int> targets;
+    std::vector<float> weights;
+
+    // filled by the intersection stage
+    std::vector<HitInfo> hitInfos;
+    std::vector<char> isHit;
+
+    void push(const PathRay & pathRay, int target, float weight)
+    {
+        pathRays.push_back(pathRay);
+        targets.push_back(target);
+        weights.push_back(weight);
+    }
+
+    int getSize() const { return this->pathRays.size(); }
+
+    void clear()
+    {
+        pathRays.clear();
+        targets.clear();
+        weights.clear();
+    }
+};
+
+// buffers reused by the wavefronts of a thread
+struct WavefrontBuffers
+{
+    Wavefront current, next;
+
+    // rays continuing the path of a single hit
+    std::vector<PathRay> continuingRays;
+
+    RaySorter raySorter;
+    ShadowRayQueue shadowRayQueue;
+};
 
 class Scene
 {
@@ -20,6 +129,10 @@ class Scene
 
         Integrator integrator = Integrator::DEFAULT;
 
+        // path tracing combines light sampling and hemisphere sampling by
+        // .. multiple importance sampling, rather than light sampling only
+        bool multipleImportanceSampling = false;
+
         Color backgroundColor;
         SphericalEnvLight* sphericalEnvLight = nullptr;
 
@@ -27,22 +140,80 @@ class Scene
 
         float shadowRayEpsilon;
         int maxRecursionDepth;
+
+        // maximum number of bounces of each type on a path, and the number of
+        // .. bounces after which the paths are terminated by russian roulette
+        int maxBounceDepth[NUMBER_OF_BOUNCE_TYPES];
+        int russianRouletteDepth;
+
+        // a dielectric hit continues the path with either the reflection or
+        // .. the refraction ray, chosen with the probability of the reflectance,
+        // .. rather than with both. the first bounce makes fresnelSplittingFactor
+        // .. such choices to reduce the noise
+        bool stochasticFresnel = false;
+        int fresnelSplittingFactor = 1;
+
+        // every light is sampled at a hit by default, otherwise lightSamplesPerHit
+        // .. of them are chosen by the light sampler
+        LightSampling lightSampling = ALL_LIGHTS;
+        int lightSamplesPerHit = 1;
+        LightSampler lightSampler;
+
+        // shadow rays of the light samples are traced together in batches of
+        // .. SHADOW_RAY_BATCH_SIZE per thread, rather than while shading
+        bool batchShadowRays = false;
+
+        // paths are traced depth first by default, otherwise WAVEFRONT_BATCH_SIZE
+        // .. pixels of a thread are traced together, see scene_wavefront.cpp
+        RenderingOrder renderingOrder = RenderingOrder::DEPTH_FIRST;
         
         std::vector<Camera> cameras;
         std::vector<Light*> lights;
+        // material table, the shapes and the hits refer to its materials
+        // .. therefore, it is not changed after the objects are parsed
         std::vector<Material> materials;
         std::vector<Vertex> vertexData;
 
+        // the shapes as they are loaded, owned by the scene
         Shape* BVH;
 
-        // the reason why getRayColor(), getReflectionColor(), isLyingInShadow()
+        // the hiearchy of the shapes compiled for rendering, which is the only
+        // .. one the rendering reads, see compile()
+        CompiledBVH compiledBVH;
+
+        // the meshes loaded while rendering, out of core only
+        GeometryCache* geometryCache = nullptr;
+
+        // the textures, the surfaces refer to them, and their images
+        std::vector<Texture*> textures;
+        TextureCache* textureCache = nullptr;
+
+        // builds the structures the rendering reads from the loaded scene, see
+        // .. scene_compile.cpp
+        void compile();
+
+        // the reason why getRayColor(), shadePathRay(), isLyingInShadow()
         // .. methods are non-static is that they are dependent on the Shape's included in the scene
         // therefore, they require to access the self's bounding volume hiearchy
-        Color getRayColor(const Ray & ray, int recursionDepth, bool backfaceCulling, bool onlyOpaque=false) const;
-        Color getReflectionColor(const Ray & ray, const HitInfo & hitInfo, int recursionDepth) const;
-        Color getRefractionColor(const Ray & hittingRay, const HitInfo & hitInfo, int recursionDepth) const;
+            // traces the path of a camera ray iteratively, the path has at most
+            // .. maxDepth - 1 bounces. if shadowRayQueue is given, the light
+            // .. samples are queued to it rather than included in the color
+        Color getRayColor(const Ray & ray, int maxDepth, bool backfaceCulling, ShadowRayQueue * shadowRayQueue = nullptr) const;
+            // light leaving the hit of pathRay towards its origin, without the
+            // .. throughput, the rays continuing the path are pushed to pathRays
+        Color shadePathRay(const PathRay & pathRay, int maxDepth, std::vector<PathRay> & pathRays, ShadowRayQueue * shadowRayQueue) const;
+            // the two stages of shadePathRay, shadeHit is given the result of intersectPathRay
+        bool intersectPathRay(const PathRay & pathRay, HitInfo & hitInfo) const;
+        Color shadeHit(const PathRay & pathRay, bool isHit, HitInfo & hitInfo, int maxDepth, std::vector<PathRay> & pathRays, ShadowRayQueue * shadowRayQueue) const;
+            // traces the paths of the wavefront bounce by bounce until all of them
+            // .. end, adds the light they bring to colors by their targets
+        void traceWavefront(int maxDepth, std::vector<Color> & colors, WavefrontBuffers & buffers) const;
+            // whether the path can continue with a bounce of the given type
+        bool canBounce(const PathRay & pathRay, int maxDepth, BounceType type) const;
+            // probability of the light being sampled at a hit, multiplied by the number of samples
+        float getLightSelectionProbability(const Light * light, const Position3 & position, const Vector3 & normal) const;
 
-        Ray createRefractionRay(const Ray & hittingRay, const HitInfo & hitInfo) const;
+        DielectricSplit splitOnDielectric(const Ray & hittingRay, const HitInfo & hitInfo) const;
 
         // new methods
         Color getDiffuseColor(const Material & material, const HitInfo & hitInfo, const IncidentLight& incidentLight) const;
@@ -50,11 +221,26 @@ class Scene
 
         Color getAmbientColor(const Material & material, const Vector3 & ambientLight) const;
 
+        // checkpoint is optional, if given, completed pixels are recorded to it
         #ifdef __CONCURRENT_BAG_TASK_DIST__
-        static void imageFiller(Camera * camera, Image * image, Scene * scene, ConcurrentBag<Vec2i> * missionsBag);
+        static void imageFiller(Camera * camera, Image * image, Scene * scene, ConcurrentBag<Vec2i> * missionsBag, RenderCheckpoint * checkpoint);
         #else
-        static void imageFiller(Camera * camera, Image * image, Scene * scene, PixelMissionGenerator * pixelMissionGenerator);
+        static void imageFiller(Camera * camera, Image * image, Scene * scene, PixelMissionGenerator * pixelMissionGenerator, RenderCheckpoint * checkpoint);
+        static void wavefrontImageFiller(Camera * camera, Image * image, Scene * scene, PixelMissionGenerator * pixelMissionGenerator, RenderCheckpoint * checkpoint);
         #endif
+
+        // renders the regions of the image with the given number of threads
+        // .. pixels marked in completedPixels are skipped. the image may cover
+        // .. only the regions, see Image::setOrigin
+        void renderRegions(
+            Camera & camera,
+            Image & image,
+            const std::vector<ImageRegion> & regions,
+            const std::vector<bool> & completedPixels,
+            RenderCheckpoint * checkpoint,
+            unsigned short numberOfThreads,
+            bool dumpProgress
+        );
     public:
         
         ~Scene()
@@ -66,10 +252,29 @@ class Scene
                 BVH = nullptr;
             }
 
-            // lights
+            // the meshes loaded out of core
+            if(geometryCache)
+            {
+                delete geometryCache;
+                geometryCache = nullptr;
+            }
+
+            // textures
+            for(int i = 0; i < textures.size(); i++)
+                delete textures[i];
+
+            textures.clear();
+
+            if(textureCache)
+            {
+                delete textureCache;
+                textureCache = nullptr;
+            }
+
+            // lights, the environment light is shared with sphericalEnvLight
             for(int i = 0; i < lights.size(); i++)
             {
-                if(lights[i])
+                if(lights[i] && lights[i] != this->sphericalEnvLight)
                     delete lights[i];
 
                 lights[i] = nullptr;    
@@ -85,11 +290,22 @@ class Scene
             }
         }
         
-        void loadFromXml(const std::string& filepath);
-        void generateImages(unsigned short numberOfThreads);
+        // the textures and the meshes are loaded by options.numberOfThreads
+        // .. threads, and the meshes are cached if options.sceneCache is set,
+        // .. see SceneCache. out of core, the meshes are loaded from the cache
+        // .. while rendering instead, see GeometryCache. the images of the
+        // .. textures are converted to tiles, see TextureCache
+        void loadFromXml(const std::string& filepath, const RenderOptions& options = RenderOptions());
+        void generateImages(const RenderOptions& options);
+
+        // distributed rendering, see scene_distributedRendering.cpp
+            // coordinator: spawns the workers, hands them tiles, writes the images
+        void coordinateRenderWorkers(const RenderOptions& options);
+            // worker: renders the tiles it receives through options.workerFd
+        void runRenderWorker(const RenderOptions& options);
 
         float getShadowRayEpsilon() const { return this->shadowRayEpsilon; }
-        Shape* getBVH() const { return this->BVH; }
+        const CompiledBVH& getBVH() const { return this->compiledBVH; }
 };
 
 #endif
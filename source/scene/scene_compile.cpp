@@ -0,0 +1,19 @@
+#include "../scene.hpp"
+
+// Compiling the scene
+//
+// The loading builds the shapes and the lights as the scene describes them,
+// .. e.g. a bounding volume hiearchy for each mesh. Compiling prepares what
+// .. the rendering reads from them:
+//  - the bounding volume hiearchy of the shapes, compiled into an arena with
+// ..   the triangles, the spheres and their materials, see CompiledBVH
+//  - the structures choosing the lights, see LightSampler
+// The loaded shapes and lights are not changed afterwards. They are still read
+// .. for the instances and the transformed shapes, which the arena refers to,
+// .. and by the lights sampling them.
+void Scene::compile()
+{
+    this->compiledBVH.compile(this->BVH);
+
+    this->lightSampler.build(this->lights, this->lightSampling);
+}
@@ -0,0 +1,489 @@
+#include "../config.h"
+#include "../scene.hpp"
+#include "../image/image.hpp"
+#include "../image/color.hpp"
+#include "../utility/image_region.hpp"
+#include "../utility/render_protocol.hpp"
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <poll.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+// state of a worker process, kept by the coordinator
+struct RenderWorker
+{
+    pid_t pid;
+    int fd;
+
+    bool alive;
+    bool ready;     // scene is loaded, can take tiles
+    bool busy;      // a tile is assigned
+    RenderMessage tile;
+    bool stallReported; // the tile takes longer than TILE_STALL_REPORT_INTERVAL
+    int numberOfRespawns = 0;
+
+    // throughput
+    int numberOfTiles = 0;
+    long numberOfPixels = 0;
+    std::chrono::steady_clock::time_point tileStart;
+    double busySeconds = 0.0;
+};
+
+// starts a worker process, which is this executable in the worker mode
+// .. connected to the coordinator through a socket pair
+static RenderWorker spawnRenderWorker(const RenderOptions& options)
+{
+    int fds[2];
+
+    // close-on-exec, so that the other workers do not inherit them
+    if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0)
+        throw std::runtime_error("Error: Cannot create a socket for a worker.");
+
+    pid_t pid = fork();
+
+    if(pid < 0)
+        throw std::runtime_error("Error: Cannot fork a worker.");
+
+    if(pid == 0)
+    {
+        // worker: keep its end of the socket open through exec
+        close(fds[0]);
+        fcntl(fds[1], F_SETFD, 0);
+
+        std::string workerFd = std::to_string(fds[1]);
+        std::string numberOfThreads = std::to_string(options.numberOfThreads);
+        std::string geometryBudget = std::to_string(options.geometryBudget / (1024 * 1024));
+        std::string textureBudget = std::to_string(options.textureBudget / (1024 * 1024));
+
+        std::vector<const char*> arguments = {
+            "raytracer.out",
+            options.sceneFilePath.c_str(),
+            "--worker-fd", workerFd.c_str(),
+            "--threads", numberOfThreads.c_str()
+        };
+
+        // the workers read the meshes from the cache of the coordinator, out
+        // .. of core each within the budget
+        if(options.outOfCore)
+        {
+            arguments.push_back("--out-of-core");
+            arguments.push_back(geometryBudget.c_str());
+        }
+        else if(options.sceneCache)
+        {
+            arguments.push_back("--scene-cache");
+        }
+
+        // and the tiles of the textures from the files of the coordinator
+        if(options.textureCache)
+        {
+            arguments.push_back("--texture-cache");
+            arguments.push_back(textureBudget.c_str());
+        }
+
+        arguments.push_back(NULL);
+
+        execv("/proc/self/exe", const_cast<char* const*>(arguments.data()));
+
+        // exec failed, the coordinator sees the closed socket
+        perror("Worker exec");
+        _exit(1);
+    }
+
+    // coordinator
+    close(fds[1]);
+
+    RenderWorker worker;
+    worker.pid = pid;
+    worker.fd = fds[0];
+    worker.alive = true;
+    worker.ready = false;
+    worker.busy = false;
+    worker.stallReported = false;
+
+    return worker;
+}
+
+void Scene::coordinateRenderWorkers(const RenderOptions& options)
+{
+    // split each image into tiles
+    std::deque<RenderMessage> tiles;
+    std::vector<Image> images;
+
+    for(int i = 0; i < (int)this->cameras.size(); i++)
+    {
+        int imageWidth = this->cameras[i].getImageWidth();
+        int imageHeight = this->cameras[i].getImageHeight();
+
+        images.push_back(Image(imageWidth, imageHeight));
+
+        int numberOfTiles = ImageRegion::getNumberOfTiles(imageWidth, imageHeight, options.tileSize);
+
+        for(int j = 0; j < numberOfTiles; j++)
+        {
+            RenderMessage tile;
+            tile.type = RenderMessageType::TILE;
+            tile.cameraIndex = i;
+            tile.region = ImageRegion::getTile(imageWidth, imageHeight, options.tileSize, j);
+
+            tiles.push_back(tile);
+        }
+    }
+
+    int numberOfTiles = tiles.size();
+    int numberOfCompletedTiles = 0;
+
+    std::vector<RenderWorker> workers;
+
+    for(int i = 0; i < options.numberOfWorkers; i++)
+        workers.push_back(spawnRenderWorker(options));
+
+    std::cout << "Rendering " << numberOfTiles << " tiles with "
+              << workers.size() << " workers." << std::endl;
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    // a dead worker's tile goes back to the queue to be given to another one.
+    // .. the worker is killed in case it is only hung, and replaced by a new
+    // .. one up to WORKER_RESPAWN_LIMIT times. once none is left, the render
+    // .. cannot be completed
+    auto markDead = [&](RenderWorker & worker)
+    {
+        kill(worker.pid, SIGKILL);
+
+        if(worker.busy)
+            tiles.push_front(worker.tile);
+
+        std::cerr << "Warning: Worker " << worker.pid << " died";
+        if(worker.busy)
+            std::cerr << ", its tile is reassigned";
+        std::cerr << "." << std::endl;
+
+        worker.alive = false;
+        worker.busy = false;
+        close(worker.fd);
+        waitpid(worker.pid, NULL, 0);
+
+        if(worker.numberOfRespawns >= WORKER_RESPAWN_LIMIT)
+            return;
+
+        // the new worker takes the place of the dead one, its throughput is
+        // .. reported together with the dead one's
+        try
+        {
+            RenderWorker respawned = spawnRenderWorker(options);
+
+            std::cerr << "Warning: Worker " << worker.pid << " is replaced by worker " << respawned.pid << "." << std::endl;
+
+            worker.pid = respawned.pid;
+            worker.fd = respawned.fd;
+            worker.alive = true;
+            worker.ready = false;
+            worker.stallReported = false;
+            worker.numberOfRespawns++;
+        }
+        catch(const std::runtime_error& exception)
+        {
+            std::cerr << "Warning: Worker " << worker.pid << " cannot be replaced. " << exception.what() << std::endl;
+        }
+    };
+
+    // seconds the tile of a busy worker has taken
+    auto getTileSeconds = [](const RenderWorker & worker, std::chrono::steady_clock::time_point now)
+    {
+        return std::chrono::duration<double>(now - worker.tileStart).count();
+    };
+
+    std::vector<float> colors;
+
+    while(numberOfCompletedTiles < numberOfTiles)
+    {
+        // assign tiles to the idle workers
+        for(int i = 0; i < (int)workers.size(); i++)
+        {
+            RenderWorker & worker = workers[i];
+
+            if(!worker.alive || !worker.ready || worker.busy || tiles.empty())
+                continue;
+
+            worker.tile = tiles.front();
+            tiles.pop_front();
+            worker.busy = true;
+            worker.stallReported = false;
+            worker.tileStart = std::chrono::steady_clock::now();
+
+            if(!sendRenderMessage(worker.fd, worker.tile))
+                markDead(worker);
+        }
+
+        // wait for a message from any worker, or until the tile of a busy
+        // .. one is to be reported or timed out. a hung worker does not close
+        // .. its socket
+        std::vector<pollfd> pollFds;
+        std::vector<int> pollWorkers;
+
+        auto now = std::chrono::steady_clock::now();
+        double secondsToWait = -1.0; // forever
+
+        auto waitAtMost = [&secondsToWait](double seconds)
+        {
+            seconds = std::max(seconds, 0.0);
+
+            if(secondsToWait < 0.0 || seconds < secondsToWait)
+                secondsToWait = seconds;
+        };
+
+        for(int i = 0; i < (int)workers.size(); i++)
+        {
+            if(!workers[i].alive)
+                continue;
+
+            if(workers[i].busy)
+            {
+                double tileSeconds = getTileSeconds(workers[i], now);
+
+                if(options.tileTimeout > 0)
+                    waitAtMost(options.tileTimeout - tileSeconds);
+
+                if(!workers[i].stallReported)
+                    waitAtMost(TILE_STALL_REPORT_INTERVAL - tileSeconds);
+            }
+
+            pollfd pollFd;
+            pollFd.fd = workers[i].fd;
+            pollFd.events = POLLIN;
+            pollFd.revents = 0;
+
+            pollFds.push_back(pollFd);
+            pollWorkers.push_back(i);
+        }
+
+        if(pollFds.empty())
+            throw std::runtime_error("Error: All workers died before the render is completed.");
+
+        // rounded up to the next millisecond, so that the deadline has passed
+        int pollTimeout = secondsToWait < 0.0 ? -1 : (int)(secondsToWait * 1000.0) + 1;
+
+        if(poll(pollFds.data(), pollFds.size(), pollTimeout) < 0)
+            continue; // interrupted
+
+        for(int i = 0; i < (int)pollFds.size(); i++)
+        {
+            if(pollFds[i].revents == 0)
+                continue;
+
+            RenderWorker & worker = workers[pollWorkers[i]];
+            RenderMessage message;
+
+            // the rest of a message that has begun to arrive should not take
+            // .. long, a worker hung in the middle of one is killed
+            if(!receiveRenderMessage(worker.fd, message, RENDER_MESSAGE_TIMEOUT))
+            {
+                markDead(worker);
+                continue;
+            }
+
+            if(message.type == RenderMessageType::READY)
+            {
+                worker.ready = true;
+            }
+            else if(message.type == RenderMessageType::RESULT)
+            {
+                const ImageRegion & region = worker.tile.region;
+
+                // the result should be of the assigned tile
+                if(!worker.busy || message.cameraIndex != worker.tile.cameraIndex ||
+                   message.region.x0 != region.x0 || message.region.y0 != region.y0 ||
+                   message.region.x1 != region.x1 || message.region.y1 != region.y1 ||
+                   !receiveColors(worker.fd, colors, region.getArea(), RENDER_MESSAGE_TIMEOUT))
+                {
+                    markDead(worker);
+                    continue;
+                }
+
+                Image & image = images[message.cameraIndex];
+                int colorIndex = 0;
+
+                for(int y = region.y0; y < region.y1; y++)
+                {
+                    for(int x = region.x0; x < region.x1; x++, colorIndex += 3)
+                        image.setColor(x, y, Color(colors[colorIndex], colors[colorIndex + 1], colors[colorIndex + 2]));
+                }
+
+                worker.busy = false;
+                worker.numberOfTiles++;
+                worker.numberOfPixels += region.getArea();
+                worker.busySeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - worker.tileStart).count();
+
+                numberOfCompletedTiles++;
+
+                printf("\r%d of %d tiles are completed.", numberOfCompletedTiles, numberOfTiles);
+                fflush(stdout);
+            }
+        }
+
+        // the tiles of the busy workers that take too long
+        now = std::chrono::steady_clock::now();
+
+        for(int i = 0; i < (int)workers.size(); i++)
+        {
+            RenderWorker & worker = workers[i];
+
+            if(!worker.alive || !worker.busy)
+                continue;
+
+            double tileSeconds = getTileSeconds(worker, now);
+
+            if(options.tileTimeout > 0 && tileSeconds >= options.tileTimeout)
+            {
+                std::cerr << std::endl << "Warning: Worker " << worker.pid << " timed out after " << (int)tileSeconds
+                          << " s on the tile [" << worker.tile.region.x0 << ", " << worker.tile.region.x1 << ") x ["
+                          << worker.tile.region.y0 << ", " << worker.tile.region.y1 << ") of camera "
+                          << worker.tile.cameraIndex << ", it is killed." << std::endl;
+
+                markDead(worker);
+            }
+            else if(!worker.stallReported && tileSeconds >= TILE_STALL_REPORT_INTERVAL)
+            {
+                std::cerr << std::endl << "Warning: Worker " << worker.pid << " has been rendering the tile ["
+                          << worker.tile.region.x0 << ", " << worker.tile.region.x1 << ") x ["
+                          << worker.tile.region.y0 << ", " << worker.tile.region.y1 << ") of camera "
+                          << worker.tile.cameraIndex << " for " << (int)tileSeconds << " s";
+
+                if(options.tileTimeout > 0)
+                    std::cerr << ", it is killed after " << options.tileTimeout << " s";
+
+                std::cerr << "." << std::endl;
+
+                worker.stallReported = true;
+            }
+        }
+    }
+
+    std::cout << std::endl;
+
+    // stop the workers, the ones still loading the scene are killed
+    for(int i = 0; i < (int)workers.size(); i++)
+    {
+        if(!workers[i].alive)
+            continue;
+
+        if(!workers[i].ready)
+            kill(workers[i].pid, SIGKILL);
+
+        RenderMessage quit;
+        quit.type = RenderMessageType::QUIT;
+        quit.cameraIndex = -1;
+
+        sendRenderMessage(workers[i].fd, quit);
+        close(workers[i].fd);
+        waitpid(workers[i].pid, NULL, 0);
+    }
+
+    double totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    // report the throughput of each worker
+    for(int i = 0; i < (int)workers.size(); i++)
+    {
+        const RenderWorker & worker = workers[i];
+
+        printf("Worker %d (pid %d%s, respawned %d times): %d tiles, %ld pixels, %.2f pixels/s while busy\n",
+            i, (int)worker.pid, worker.alive ? "" : ", died", worker.numberOfRespawns,
+            worker.numberOfTiles, worker.numberOfPixels,
+            worker.busySeconds > 0.0 ? worker.numberOfPixels / worker.busySeconds : 0.0);
+    }
+
+    printf("Total: %d tiles in %.2fs\n", numberOfTiles, totalSeconds);
+
+    // write the images
+    for(int i = 0; i < (int)this->cameras.size(); i++)
+    {
+        Camera & camera = this->cameras[i];
+
+        ToneMappingParam toneMappingParam = camera.getToneMappingParam();
+        toneMappingParam.gamma = camera.getGammaCorrection();
+
+        images[i].writeOutput(camera.getImageName(), camera.doTonemap(), toneMappingParam);
+    }
+}
+
+void Scene::runRenderWorker(const RenderOptions& options)
+{
+    int fd = options.workerFd;
+
+    RenderMessage message;
+    message.type = RenderMessageType::READY;
+    message.cameraIndex = -1;
+
+    bool connected = sendRenderMessage(fd, message);
+
+    std::vector<float> colors;
+
+    while(connected && receiveRenderMessage(fd, message) && message.type == RenderMessageType::TILE)
+    {
+        if(message.cameraIndex < 0 || message.cameraIndex >= (int)this->cameras.size())
+            break;
+
+        Camera & camera = this->cameras[message.cameraIndex];
+        const ImageRegion & region = message.region;
+
+        // the tile is rendered into an image of its size, addressed by the
+        // .. pixel coordinates of the camera
+        Image tileImage(region.getWidth(), region.getHeight());
+        tileImage.setOrigin(region.x0, region.y0);
+
+        renderRegions(
+            camera,
+            tileImage,
+            std::vector<ImageRegion>(1, region),
+            std::vector<bool>(),
+            NULL,
+            options.numberOfThreads,
+            false
+        );
+
+        colors.clear();
+
+        for(int y = region.y0; y < region.y1; y++)
+        {
+            for(int x = region.x0; x < region.x1; x++)
+            {
+                Color color = tileImage.getColor(x, y);
+
+                colors.push_back(color.getFR());
+                colors.push_back(color.getFG());
+                colors.push_back(color.getFB());
+            }
+        }
+
+        message.type = RenderMessageType::RESULT;
+
+        connected = sendRenderMessage(fd, message) && sendColors(fd, colors);
+    }
+
+    if(this->geometryCache)
+    {
+        std::cout << "Worker (pid " << getpid() << "): ";
+        this->geometryCache->printStatistics(std::cout);
+    }
+
+    if(this->textureCache && this->textureCache->isOutOfCore())
+    {
+        std::cout << "Worker (pid " << getpid() << "): ";
+        this->textureCache->printStatistics(std::cout);
+    }
+
+    close(fd);
+}
@@ -3,14 +3,19 @@
 #include "../geometry/headers/geometry.hpp"
 #include "../image/image.hpp"
 #include "../image/color.hpp"
+#include "../utility/random_number_generator.hpp"
+#include "../utility/render_checkpoint.hpp"
+#include "../utility/partial_image.hpp"
+#include "../utility/image_region.hpp"
 #include <thread>
 #include <iostream>
 #include <chrono>
+#include <memory>
 
 
 #ifdef __CONCURRENT_BAG_TASK_DIST__
 
-void Scene::imageFiller(Camera * camera, Image * image, Scene * scene, ConcurrentBag<Vec2i> * missionsBag)
+void Scene::imageFiller(Camera * camera, Image * image, Scene * scene, ConcurrentBag<Vec2i> * missionsBag, RenderCheckpoint * checkpoint)
 {
     if(camera != NULL && image != NULL && scene != NULL && missionsBag != NULL)
     {
@@ -19,6 +24,10 @@ void Scene::imageFiller(Camera * camera, Image * image, Scene * scene, Concurren
         
         while(missionsBag->pop(pixelToFill))
         {
+            // make the samples of the pixel reproducible
+            if(checkpoint)
+                seedRandomNumberGenerator(checkpoint->getPixelSeed(pixelToFill.x, pixelToFill.y));
+
             const std::vector<Ray> & raysToSample = camera->getRays(pixelToFill.x, pixelToFill.y);
 
             Color rayColor = Color::Black();
@@ -33,6 +42,10 @@ void Scene::imageFiller(Camera * camera, Image * image, Scene * scene, Concurren
                 sumOfWeights += raysToSample[i].getWeight();
             }
 
+            // record accumulated samples before normalizing
+            if(checkpoint)
+                checkpoint->recordPixel(pixelToFill.x, pixelToFill.y, rayColor, sumOfWeights, raysToSample.size());
+
             // normalize color
             rayColor = rayColor / sumOfWeights;
 
@@ -48,14 +61,68 @@ void Scene::imageFiller(Camera * camera, Image * image, Scene * scene, Concurren
 
 #else
 
-void Scene::imageFiller(Camera * camera, Image * image, Scene * scene, PixelMissionGenerator * pixelMissionGenerator)
+void Scene::imageFiller(Camera * camera, Image * image, Scene * scene, PixelMissionGenerator * pixelMissionGenerator, RenderCheckpoint * checkpoint)
 {
-    if(camera != NULL && image != NULL && scene != NULL && pixelMissionGenerator != NULL)
+    if(camera != NULL && image != NULL && scene != NULL && scene->renderingOrder == RenderingOrder::WAVEFRONT)
+    {
+        wavefrontImageFiller(camera, image, scene, pixelMissionGenerator, checkpoint);
+    }
+    else if(camera != NULL && image != NULL && scene != NULL && pixelMissionGenerator != NULL)
     {
         Vec2i pixelToFill;
 
+        // pixels whose samples are taken, waiting for their queued shadow rays
+        struct PendingPixel
+        {
+            Vec2i pixel;
+            Color color;
+            float sumOfWeights;
+            int numberOfSamples;
+        };
+
+        std::vector<PendingPixel> pendingPixels;
+
+        ShadowRayQueue shadowRayQueue;
+        ShadowRayQueue * queue = scene->batchShadowRays ? &shadowRayQueue : nullptr;
+
+        std::vector<Color> queuedColors;
+
+        // traces the queued shadow rays and sets the colors of the pending pixels
+        auto completePendingPixels = [&]()
+        {
+            queuedColors.assign(pendingPixels.size(), Color::Black());
+            shadowRayQueue.trace(scene->compiledBVH, queuedColors);
+
+            for(int i = 0; i < (int)pendingPixels.size(); i++)
+            {
+                const PendingPixel & pendingPixel = pendingPixels[i];
+
+                Color rayColor = pendingPixel.color;
+                rayColor += queuedColors[i];
+
+                // record accumulated samples before normalizing
+                if(checkpoint)
+                    checkpoint->recordPixel(pendingPixel.pixel.x, pendingPixel.pixel.y, rayColor, pendingPixel.sumOfWeights, pendingPixel.numberOfSamples);
+
+                // normalize color
+                rayColor = rayColor / pendingPixel.sumOfWeights;
+
+                // if needed, apply gamma correction
+                // TODO
+
+                // set color
+                image->setColor(pendingPixel.pixel.x, pendingPixel.pixel.y, rayColor);
+            }
+
+            pendingPixels.clear();
+        };
+
         while(pixelMissionGenerator->getPixelToFill(pixelToFill))
         {
+            // make the samples of the pixel reproducible
+            if(checkpoint)
+                seedRandomNumberGenerator(checkpoint->getPixelSeed(pixelToFill.x, pixelToFill.y));
+
             // Debugging block
             /*int x = pixelToFill.x, y = pixelToFill.y;
 
@@ -81,21 +148,29 @@ void Scene::imageFiller(Camera * camera, Image * image, Scene * scene, PixelMiss
                 #ifdef BACKFACE_CULLING
                 backfaceCulling = true;
                 #endif
-                rayColor += scene->getRayColor(raysToSample[i], scene->maxRecursionDepth, backfaceCulling).intensify(rayWeight);
+
+                if(queue)
+                    queue->setTarget(pendingPixels.size(), rayWeight);
+
+                rayColor += scene->getRayColor(raysToSample[i], scene->maxRecursionDepth, backfaceCulling, queue).intensify(rayWeight);
 
                 // add the weight of the ray to sum of weights
                 sumOfWeights += rayWeight;
             }
 
-            // normalize color
-            rayColor = rayColor / sumOfWeights;
+            PendingPixel pendingPixel;
+            pendingPixel.pixel = pixelToFill;
+            pendingPixel.color = rayColor;
+            pendingPixel.sumOfWeights = sumOfWeights;
+            pendingPixel.numberOfSamples = raysToSample.size();
 
-            // if needed, apply gamma correction
-            // TODO
+            pendingPixels.push_back(pendingPixel);
 
-            // set color
-            image->setColor(pixelToFill.x, pixelToFill.y, rayColor);
+            if(!queue || shadowRayQueue.getSize() >= SHADOW_RAY_BATCH_SIZE)
+                completePendingPixels();
         }
+
+        completePendingPixels();
     }
     else
     {
@@ -153,96 +228,193 @@ void dumpInfoUntilCompletion(
     }
 }
 
-void Scene::generateImages(unsigned short numberOfThreads)
+void Scene::renderRegions(
+    Camera & camera,
+    Image & image,
+    const std::vector<ImageRegion> & regions,
+    const std::vector<bool> & completedPixels,
+    RenderCheckpoint * checkpoint,
+    unsigned short numberOfThreads,
+    bool dumpProgress
+)
 {
-    // generate one image for each camera
-    for(int i = 0; i < this->cameras.size(); i++)
-    {
-        Camera & camera = this->cameras[i];
-        
-        int imageWidth = camera.getImageWidth();
-        int imageHeight = camera.getImageHeight();
-        
-        // create the image object
-        Image image(imageWidth, imageHeight);
+    int imageWidth = camera.getImageWidth();
+    int imageHeight = camera.getImageHeight();
 
 #ifdef __CONCURRENT_BAG_TASK_DIST__
-        // create the missions bag, which will include a mission for each pixel
-        std::forward_list<Vec2i> missionsBag;
-        for(int x = 0; x < imageWidth; x++)
+    // create the missions bag, which will include a mission for each pixel
+    std::forward_list<Vec2i> missionsBag;
+    for(int j = 0; j < (int)regions.size(); j++)
+    {
+        for(int x = regions[j].x0; x < regions[j].x1; x++)
         {
-            for(int y = 0; y < imageHeight; y++)
+            for(int y = regions[j].y0; y < regions[j].y1; y++)
             {
+                // skip the pixels restored from the checkpoint
+                if(!completedPixels.empty() && completedPixels[y * imageWidth + x])
+                    continue;
+
                 Vec2i pixel { x, y };
                 missionsBag.push_front(pixel);
             }
         }
+    }
 
-        // create concurrent missions bag
-        ConcurrentBag<Vec2i> missionDist(missionsBag);
+    // create concurrent missions bag
+    ConcurrentBag<Vec2i> missionDist(missionsBag);
 #else
-        PixelMissionGenerator missionDist(imageWidth, imageHeight);
+    PixelMissionGenerator missionDist(imageWidth, imageHeight, regions, completedPixels);
 #endif
-        // check the number of threads
-            // if 0, do not create an extra thread but use the current
-        if(numberOfThreads == 0)
+    // check the number of threads
+        // if 0, do not create an extra thread but use the current
+    if(numberOfThreads == 0)
+    {
+        imageFiller(
+            &camera,
+            &image,
+            this,
+            &missionDist,
+            checkpoint
+        );
+    }
+    else
+    {
+        // create threads
+        std::vector<std::thread> threads;
+        
+        for(int i = 0; i < numberOfThreads; i++)
         {
-            imageFiller(
-                &camera,
-                &image,
-                this,
-                &missionDist
+            threads.push_back(
+                std::thread(
+                    imageFiller,
+                        &camera,
+                        &image,
+                        this,
+                        &missionDist,
+                        checkpoint
+                )
             );
         }
-        else
-        {
-            // create threads
-            std::vector<std::thread> threads;
-            
-            for(int i = 0; i < numberOfThreads; i++)
-            {
-                threads.push_back(
-                    std::thread(
-                        imageFiller,
-                            &camera,
-                            &image,
-                            this,
-                            &missionDist
-                    )
-                );
-            }
 
+        if(dumpProgress)
+        {
             dumpInfoUntilCompletion(missionDist);
 
             std::cout << std::endl;
+        }
+
+        // join threads (wait for all to finish their job)
+        for(int i = 0; i < (int)threads.size(); i++)
+        {
+            threads[i].join();
+        }
+    }
+}
+
+void Scene::generateImages(const RenderOptions& options)
+{
+    unsigned short numberOfThreads = options.numberOfThreads;
+
+    // generate one image for each camera
+    for(int i = 0; i < this->cameras.size(); i++)
+    {
+        Camera & camera = this->cameras[i];
+        
+        int imageWidth = camera.getImageWidth();
+        int imageHeight = camera.getImageHeight();
+        
+        // create the image object
+        Image image(imageWidth, imageHeight);
+
+        // the regions of the image to be rendered, the whole image unless
+        // .. a partial render is requested
+        std::vector<ImageRegion> regions = options.getRenderRegions(imageWidth, imageHeight);
+
+        int numberOfPixelsToRender = 0;
+        for(int j = 0; j < (int)regions.size(); j++)
+            numberOfPixelsToRender += regions[j].getArea();
+
+        if(options.renderTiles)
+        {
+            std::cout << camera.getImageName() << ": rendering tiles " << options.firstTile << "-"
+                      << options.lastTile << " of 0-"
+                      << ImageRegion::getNumberOfTiles(imageWidth, imageHeight, options.tileSize) - 1
+                      << " (" << numberOfPixelsToRender << " pixels)." << std::endl;
+        }
+
+        // create the checkpoint, restore the completed pixels if resuming
+        std::unique_ptr<RenderCheckpoint> checkpoint;
+        std::vector<bool> completedPixels;
 
-            // join threads (wait for all to finish their job)
-            for(int i = 0; i < (int)threads.size(); i++)
+        if(options.checkpoint)
+        {
+            // a checkpoint for each part, so that the processes rendering
+            // .. different parts of the same image do not overwrite each other
+            ImageRegion bounds = ImageRegion::getBounds(regions);
+
+            checkpoint.reset(
+                new RenderCheckpoint(
+                    camera.getImageName() + options.getPartialSuffix() + CHECKPOINT_FILE_EXTENSION,
+                    CHECKPOINT_RANDOM_SEED,
+                    i,
+                    imageWidth, imageHeight,
+                    bounds,
+                    camera.getNumSamples(),
+                    options.checkpointInterval
+                )
+            );
+
+            if(options.resume && checkpoint->load())
             {
-                threads[i].join();
+                completedPixels = checkpoint->getCompletedPixels();
+
+                for(int y = bounds.y0; y < bounds.y1; y++)
+                {
+                    for(int x = bounds.x0; x < bounds.x1; x++)
+                    {
+                        if(checkpoint->isPixelCompleted(x, y))
+                            image.setColor(x, y, checkpoint->getPixelColor(x, y));
+                    }
+                }
+
+                std::cout << "Resuming " << camera.getImageName() << ": "
+                          << checkpoint->getNumberOfCompletedPixels() << " of "
+                          << numberOfPixelsToRender << " pixels are restored." << std::endl;
             }
         }
 
+        renderRegions(camera, image, regions, completedPixels, checkpoint.get(), numberOfThreads, true);
+
+        // final checkpoint, which has every pixel completed
+        if(checkpoint)
+            checkpoint->save();
+
         // apply gamma correction
         //image.applyGammaCorrection(camera.getGammaCorrection());
 
-        image.write(camera.getImageName());
+        ToneMappingParam toneMappingParam = camera.getToneMappingParam();
+        toneMappingParam.gamma = camera.getGammaCorrection();
 
-        // check HDR
-        if(camera.doTonemap())
+        if(options.isPartial())
         {
-            // change image name
-            std::string imageName = camera.getImageName();
-            int extensionInd = imageName.find('.');
-            int strLen = imageName.length();
-            imageName = imageName.substr(0, extensionInd) + ".png";
+            // only the rendered part is written, the final image is written
+            // .. when the parts are merged
+            std::string partialImagePath = camera.getImageName() + options.getPartialSuffix() + PARTIAL_IMAGE_FILE_EXTENSION;
 
-            // tonemap&write image
-            ToneMappingParam toneMappingParam = camera.getToneMappingParam();
-            toneMappingParam.gamma = camera.getGammaCorrection();
+            PartialImage(camera.getImageName(), camera.doTonemap(), toneMappingParam, image, regions)
+                .write(partialImagePath);
 
-            image.write(imageName, toneMappingParam);
+            std::cout << "Partial image is written to " << partialImagePath << "." << std::endl;
+        }
+        else
+        {
+            image.writeOutput(camera.getImageName(), camera.doTonemap(), toneMappingParam);
         }
     }
-    
+
+    if(this->geometryCache)
+        this->geometryCache->printStatistics(std::cout);
+
+    if(this->textureCache && this->textureCache->isOutOfCore())
+        this->textureCache->printStatistics(std::cout);
 }
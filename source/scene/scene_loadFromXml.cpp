@@ -11,14 +11,22 @@
 #include "../geometry/headers/directional_light.hpp"
 #include "../geometry/headers/lightsphere.hpp"
 #include "../geometry/headers/lightmesh.hpp"
+#include "../geometry/headers/lazy_mesh.hpp"
+#include "../geometry/headers/geometry_cache.hpp"
+#include "../geometry/headers/texture_cache.hpp"
 #include "../geometry/headers/brdf.hpp"
 #include "../image/image.hpp"
 #include "../utility/ply_parser.hpp"
-#include "../utility/pair.hpp"
 #include "../utility/binf_parser.hpp"
+#include "../utility/scene_cache.hpp"
+#include "../utility/task_graph.hpp"
+#include "../utility/number_list_parser.hpp"
 #include <string>
 #include <sstream>
 #include <map>
+#include <deque>
+#include <chrono>
+#include <algorithm>
 
 
 // read Position3 from stream to Position3 instance
@@ -104,6 +112,113 @@ T parseChild(tinyxml2::XMLElement* element, std::string childNameHoldingInfo = "
     return _t;
 }
 
+// Baking the transformations
+//
+// A shape with a transformation intersects the rays in its own space, which
+// .. costs transforming each ray it is tested against. The static
+// .. transformations of the objects that are not instanced are applied to their
+// .. data at load time instead, so that they are intersected in the space of
+// .. the scene. It is not possible when
+//  - the object is instanced, its data is shared by the instances
+//  - it has a perlin texture, which is evaluated at the positions in its space
+//  - the transformation mirrors it, which would flip its winding
+// A sphere is baked only if it stays a sphere, its transformation scales it
+// .. uniformly, and if it has an image texture, it is not rotated either.
+
+bool hasMeshInstances(tinyxml2::XMLElement* objects, int meshId)
+{
+    for(auto instanceElem = objects->FirstChildElement("MeshInstance"); instanceElem; instanceElem = instanceElem->NextSiblingElement("MeshInstance"))
+    {
+        int baseMeshId = -1;
+        instanceElem->QueryAttribute("baseMeshId", &baseMeshId);
+
+        if(baseMeshId == meshId)
+            return true;
+    }
+
+    return false;
+}
+
+bool canBakeTransformation(const Transformation& transformation, const Texture* texture)
+{
+    return (!texture || texture->getTextureType() != TextureType::PERLIN) &&
+        transformation.getTransformationMatrix().getLinearDeterminant() > 0.f;
+}
+
+bool canBakeSphereTransformation(const Transformation& transformation, const Texture* texture, float& scale)
+{
+    if(!canBakeTransformation(transformation, texture))
+        return false;
+
+    const AffineTransform & matrix = transformation.getTransformationMatrix();
+
+    // the columns of the linear part should be orthogonal and of the same length
+    Vector3 columns[3];
+    for(int j = 0; j < 3; j++)
+        columns[j] = Vector3(matrix.getEl(0, j), matrix.getEl(1, j), matrix.getEl(2, j));
+
+    float scaleSq = columns[0] ^ columns[0];
+    float tolerance = 1e-5f * scaleSq;
+
+    for(int j = 0; j < 3; j++)
+    {
+        if(std::abs((columns[j] ^ columns[j]) - scaleSq) > tolerance ||
+           std::abs(columns[j] ^ columns[(j + 1) % 3]) > tolerance)
+            return false;
+    }
+
+    scale = std::sqrt(scaleSq);
+
+    // the texture coordinates of an image texture depend on the orientation
+    if(texture && texture->getTextureType() == TextureType::IMAGE)
+    {
+        for(int i = 0; i < 3; i++)
+            for(int j = 0; j < 3; j++)
+                if(i != j && std::abs(matrix.getEl(i, j)) > 1e-5f * scale)
+                    return false;
+    }
+
+    return true;
+}
+
+// the vertex in the space of the scene, with its normal
+Vertex bakeVertex(const Vertex& vertex, const Transformation& transformation)
+{
+    Vertex result(transformation.transform<Position3>(vertex));
+
+    if(!vertex.getNormal().isZeroVector())
+    {
+        result.addToNormal(transformation.normalTransform(vertex.getNormal()));
+        result.normalizeNormal();
+    }
+
+    return result;
+}
+
+std::string getObjectName(tinyxml2::XMLElement* element)
+{
+    const char * id = element->Attribute("id");
+
+    return std::string(element->Name()) + " " + (id ? id : "?");
+}
+
+// the normals of the vertices of a smooth mesh, computed in place since the
+// .. vertices are not shared with other meshes
+void computeSmoothNormals(std::vector<Vertex>& vertices, const std::vector<Vec3i>& faces)
+{
+    for(int i = 0; i < (int)faces.size(); i++)
+    {
+        Vector3 normal = Triangle::computeNormal(vertices[faces[i].x], vertices[faces[i].y], vertices[faces[i].z]);
+
+        vertices[faces[i].x].addToNormal(normal);
+        vertices[faces[i].y].addToNormal(normal);
+        vertices[faces[i].z].addToNormal(normal);
+    }
+
+    for(int i = 0; i < (int)vertices.size(); i++)
+        vertices[i].normalizeNormal();
+}
+
 std::vector<Shape*>
 createMeshTriangles(
     const std::vector<Vertex>& vertexData,
@@ -111,12 +226,14 @@ createMeshTriangles(
     ShadingMode shadingMode = ShadingMode::FLAT,
     Texture* texture = nullptr,
     const std::vector<Vec2f> & texCoordData = std::vector<Vec2f>(),
-    int textureOffset = 0
+    int textureOffset = 0,
+    const Transformation* bakedTransformation = nullptr,
+    bool hasVertexNormals = false
 )
 {
     std::vector<Shape*> trianglesOfMesh;
 
-    if(shadingMode == ShadingMode::SMOOTH)
+    if(shadingMode == ShadingMode::SMOOTH && !hasVertexNormals)
     {
         // if shading mode is SMOOTH, then, additional normal computation is
         // required. copy the vertex data to manipulate its normals
@@ -147,12 +264,19 @@ createMeshTriangles(
             vertexDataCopy[meshVertexIndices[i].z].normalizeNormal();
 
             // create triangle
-            Triangle * triangle = new Triangle(
-                vertexDataCopy[meshVertexIndices[i].x],  // v0
-                vertexDataCopy[meshVertexIndices[i].y],  // v1
-                vertexDataCopy[meshVertexIndices[i].z],  // v2
-                shadingMode
-            );
+            Triangle * triangle = bakedTransformation ?
+                new Triangle(
+                    bakeVertex(vertexDataCopy[meshVertexIndices[i].x], *bakedTransformation),
+                    bakeVertex(vertexDataCopy[meshVertexIndices[i].y], *bakedTransformation),
+                    bakeVertex(vertexDataCopy[meshVertexIndices[i].z], *bakedTransformation),
+                    shadingMode
+                ) :
+                new Triangle(
+                    vertexDataCopy[meshVertexIndices[i].x],  // v0
+                    vertexDataCopy[meshVertexIndices[i].y],  // v1
+                    vertexDataCopy[meshVertexIndices[i].z],  // v2
+                    shadingMode
+                );
 
             // check texture
             if(texture)
@@ -176,16 +300,23 @@ createMeshTriangles(
     }
     else
     {
-        // otherwise (FLAT), normal computation is not needed
+        // otherwise (FLAT, or the normals are given), normal computation is not needed
         for(int i = 0; i < (int)meshVertexIndices.size(); i++)
         {
             // create triangle
-            Triangle * triangle = new Triangle(
-                vertexData[meshVertexIndices[i].x],  // v0
-                vertexData[meshVertexIndices[i].y],  // v1
-                vertexData[meshVertexIndices[i].z],  // v2
-                shadingMode
-            );
+            Triangle * triangle = bakedTransformation ?
+                new Triangle(
+                    bakeVertex(vertexData[meshVertexIndices[i].x], *bakedTransformation),
+                    bakeVertex(vertexData[meshVertexIndices[i].y], *bakedTransformation),
+                    bakeVertex(vertexData[meshVertexIndices[i].z], *bakedTransformation),
+                    shadingMode
+                ) :
+                new Triangle(
+                    vertexData[meshVertexIndices[i].x],  // v0
+                    vertexData[meshVertexIndices[i].y],  // v1
+                    vertexData[meshVertexIndices[i].z],  // v2
+                    shadingMode
+                );
 
             // check texture
             if(texture)
@@ -211,6 +342,54 @@ createMeshTriangles(
     return trianglesOfMesh;
 }
 
+// the triangles of a mesh as they are cached
+std::vector<SceneCache::Triangle> getCachedTriangles(const std::vector<Shape*>& trianglesOfMesh)
+{
+    std::vector<SceneCache::Triangle> cachedTriangles(trianglesOfMesh.size());
+
+    for(int i = 0; i < (int)trianglesOfMesh.size(); i++)
+    {
+        const Triangle * triangle = static_cast<const Triangle*>(trianglesOfMesh[i]);
+
+        for(int j = 0; j < 3; j++)
+        {
+            Vertex vertex = triangle->getVertex(j);
+            Vector3 normal = vertex.getNormal();
+
+            cachedTriangles[i].positions[j][0] = vertex.getX();
+            cachedTriangles[i].positions[j][1] = vertex.getY();
+            cachedTriangles[i].positions[j][2] = vertex.getZ();
+
+            cachedTriangles[i].normals[j][0] = normal.getX();
+            cachedTriangles[i].normals[j][1] = normal.getY();
+            cachedTriangles[i].normals[j][2] = normal.getZ();
+
+            cachedTriangles[i].texCoords[j][0] = triangle->getTexCoord(j).x;
+            cachedTriangles[i].texCoords[j][1] = triangle->getTexCoord(j).y;
+        }
+    }
+
+    return cachedTriangles;
+}
+
+// the files the scene refers to, e.g. the ply files of the meshes
+void collectReferencedFiles(tinyxml2::XMLElement* element, std::vector<std::string>& filePaths)
+{
+    for(; element; element = element->NextSiblingElement())
+    {
+        const char * plyFileName = element->Attribute("plyFile");
+        const char * binFileName = element->Attribute("binaryFile");
+
+        if(plyFileName)
+            filePaths.push_back(plyFileName);
+
+        if(binFileName)
+            filePaths.push_back(binFileName);
+
+        collectReferencedFiles(element->FirstChildElement(), filePaths);
+    }
+}
+
 ToneMappingParam parseToneMapping(tinyxml2::XMLElement* element)
 {
     std::stringstream stream;
@@ -646,24 +825,12 @@ Material parseMaterial(tinyxml2::XMLElement* element, const std::vector<BRDF>& b
     return material;
 }
 
-// parses ImageTexture specific attributes
+// parses ImageTexture specific attributes, its image is decoded by the task
+// .. parseTexture() adds
 ImageTexture* parseImageTexture(tinyxml2::XMLElement* element)
 {
     ImageTexture* texture = new ImageTexture();
 
-    // Image
-    if(doesHaveChild(element, "ImageName"))
-    {
-        std::string imageName = parseChild<std::string>(element, "ImageName");
-        texture->setImage(imageName);
-    }
-
-    // Degamma
-    const char * degamma = element->Attribute("degamma");
-    bool isDegamma = degamma && degamma[0] == 't';
-
-    if(isDegamma) texture->degammaImage();
-
     // Interpolation
     if(doesHaveChild(element, "Interpolation"))
     {
@@ -800,9 +967,19 @@ PerlinTexture* parsePerlinTexture(tinyxml2::XMLElement* element)
     return texture;
 }
 
-Texture* parseTexture(tinyxml2::XMLElement* element)
+// decodeTask is the task loading the image of the texture, -1 if it has none.
+// .. an image of several textures is loaded by the task of the first one, see
+// .. imageLoads
+Texture* parseTexture(
+    tinyxml2::XMLElement* element,
+    TextureCache& textureCache,
+    TaskGraph& taskGraph,
+    std::map<const TextureCache::TiledImage*, TaskGraph::TaskId>& imageLoads,
+    TaskGraph::TaskId& decodeTask
+)
 {
     Texture* texture = nullptr;
+    decodeTask = -1;
 
     // image name
     if(doesHaveChild(element, "ImageName"))
@@ -831,12 +1008,104 @@ Texture* parseTexture(tinyxml2::XMLElement* element)
         element->QueryAttribute("bumpmapMultiplier", &multiplier);
         texture->setBumpMapMultiplier(multiplier);
     }
+
+    // the image is decoded and converted to tiles by a task
+    if(texture->getTextureType() == TextureType::IMAGE)
+    {
+        ImageTexture* imageTexture = (ImageTexture*)texture;
+        std::string imageName = parseChild<std::string>(element, "ImageName");
+
+        // Degamma
+        const char * degamma = element->Attribute("degamma");
+        bool isDegamma = degamma && degamma[0] == 't';
+
+        bool isAdded;
+        TextureCache::TiledImage* image = textureCache.addImage(imageName, isDegamma, isAdded);
+        imageTexture->setImage(image);
+
+        if(isAdded)
+        {
+            imageLoads[image] = taskGraph.add("textures", [&textureCache, image]()
+            {
+                textureCache.loadImage(*image);
+            });
+        }
+
+        decodeTask = imageLoads.at(image);
+    }
     
     return texture;
 }
 
-// parse a mesh and its instances
-std::vector<Shape*>
+// the task decoding the image of the texture, if it has one
+std::vector<TaskGraph::TaskId> getTextureDecodes(const Texture* texture, const std::map<const Texture*, TaskGraph::TaskId>& textureDecodes)
+{
+    std::vector<TaskGraph::TaskId> decodes;
+
+    auto decode = textureDecodes.find(texture);
+
+    if(decode != textureDecodes.end())
+        decodes.push_back(decode->second);
+
+    return decodes;
+}
+
+// an instance of a mesh, as it is described in the scene file
+struct MeshInstanceDescription
+{
+    int materialId;
+
+    bool hasTransformation = false;
+    Transformation transformation;
+
+    bool hasMotionBlur = false;
+    Vector3 motionBlur;
+};
+
+// a mesh as it is described in the scene file, with its instances. its
+// .. triangles and hiearchy are built by the tasks of the loader, see
+// .. buildMeshTriangles() and buildMeshHiearchy()
+struct MeshJob
+{
+    std::string name;
+    int materialId;
+    ShadingMode shadingMode = DEFAULT_SHADING_MODE;
+    Texture* texture = nullptr;
+
+    bool hasTransformation = false;
+    bool isTransformationBaked = false;
+    Transformation transformation;
+
+    bool hasMotionBlur = false;
+    Vector3 motionBlur;
+
+    // the faces are read from either of the files, or from the text of the
+    // .. scene file, which stays loaded until the mesh is built
+    std::string plyFileName;
+    std::string binFileName;
+    const char* faces = nullptr;
+    int vertexOffset = 0;
+    int textureOffset = 0;
+
+    // the triangles of a cached mesh are in the order of the leaves
+    const SceneCache::Mesh* cachedMesh = nullptr;
+
+    std::vector<MeshInstanceDescription> instances;
+
+    // built by the tasks
+    std::vector<Shape*> trianglesOfMesh;
+    std::vector<int32_t> leftSizes;
+    Shape* meshBVH = nullptr;
+    TaskGraph::TaskId hiearchyTask = -1;
+
+    // bounds of the triangles, of a mesh loaded out of core
+    Position3 minPosition, maxPosition;
+};
+
+// parse a mesh and its instances. everything read from the scene file is
+// .. read here, since the elements of tinyxml2 are not to be read by multiple
+// .. threads
+MeshJob
 parseMesh(
     tinyxml2::XMLElement* meshElement,
     tinyxml2::XMLElement* objects,
@@ -844,37 +1113,21 @@ parseMesh(
     const std::vector<Scaling>& scalings,
     const std::vector<Rotation>& rotations,
     const std::map<int, Texture*>& textures,
-    const std::vector<Vertex>& vertexData,
-    const std::vector<Vec2f>& texCoordData,
-    const std::vector<Material>& materials
+    std::vector<std::string>& bakedObjects,
+    SceneCache& sceneCache
     )
 {
-    std::vector<Shape*> shapes;
-
-    if(meshElement == nullptr)
-        return shapes;
-
-    std::stringstream stream;
-    
-        std::vector<Shape*> trianglesOfMesh;
-        Texture* texture = nullptr;
-
-        // flag for indicating transformation
-        bool hasTransformation = false;
-        bool hasMotionBlur = false;
-        Vector3 motionBlur;
-
-        int materialId;
+        MeshJob job;
         int meshId;
-        ShadingMode shadingMode = DEFAULT_SHADING_MODE;
-        Transformation transformation;
+
+        job.name = getObjectName(meshElement);
         
         // read mesh id
         meshElement->QueryAttribute("id", &meshId);
         
         // read material id
         if(doesHaveChild(meshElement, "Material"))
-            materialId = parseChild<int>(meshElement, "Material") - 1;
+            job.materialId = parseChild<int>(meshElement, "Material") - 1;
 
         // read shading mode
         const char * shadingModeString = meshElement->Attribute("shadingMode");
@@ -884,11 +1137,11 @@ parseMesh(
             {
                 case 's':
                 case 'S':
-                    shadingMode = ShadingMode::SMOOTH;
+                    job.shadingMode = ShadingMode::SMOOTH;
                     break;
                 case 'f':
                 case 'F':
-                    shadingMode = ShadingMode::FLAT;
+                    job.shadingMode = ShadingMode::FLAT;
                     break;
             }
         }
@@ -896,22 +1149,31 @@ parseMesh(
         // read transformations
         if(doesHaveChild(meshElement, "Transformations"))
         {
-            hasTransformation = true;
-            transformation = parseObjectTransformation(meshElement, translations, scalings, rotations);
+            job.hasTransformation = true;
+            job.transformation = parseObjectTransformation(meshElement, translations, scalings, rotations);
         }
 
         // read motion blur
         if(doesHaveChild(meshElement, "MotionBlur"))
         {
-            hasMotionBlur = true;
-            motionBlur = parseChild<Vector3>(meshElement, "MotionBlur");
+            job.hasMotionBlur = true;
+            job.motionBlur = parseChild<Vector3>(meshElement, "MotionBlur");
         }
 
         // read texture
         if(doesHaveChild(meshElement, "Texture"))
         {
             int textureId = parseChild<int>(meshElement, "Texture");
-            texture = textures.at(textureId);
+            job.texture = textures.at(textureId);
+        }
+
+        // bake the transformation if possible
+        if(job.hasTransformation && !hasMeshInstances(objects, meshId) && canBakeTransformation(job.transformation, job.texture))
+        {
+            job.isTransformationBaked = true;
+            job.hasTransformation = false;
+
+            bakedObjects.push_back(job.name);
         }
 
         // read faces
@@ -921,120 +1183,33 @@ parseMesh(
         // .. otherwise, parse in default mode
         const char * plyFileName = child->Attribute("plyFile");
         const char * binFileName = child->Attribute("binaryFile");
-        if(plyFileName)
-        {
-            // vertexData, meshVertexIndices, texCoordData(if applicable)
-            Triple< std::vector<Vec3f>, std::vector<Vec3i>, std::vector<Vec2f> > plyMesh = parsePly(plyFileName);
-
-            // copy position data as Vertex and copy meshVertexIndices
-            std::vector<Vertex> vertexData;
-            std::vector<Vec3i> meshVertexIndices(plyMesh.p2);
-            const std::vector<Vec2f>& texCoordData = plyMesh.p3;
-
-            for(int i = 0; i < plyMesh.p1.size(); i++)
-            {
-                vertexData.push_back(Vertex(plyMesh.p1[i].x, plyMesh.p1[i].y, plyMesh.p1[i].z));
-            }
-
-            trianglesOfMesh = createMeshTriangles(
-                vertexData,
-                meshVertexIndices,
-                shadingMode,
-                texture,
-                texCoordData
-            );
 
-            // if has texture, make each triangle have its own material
-            if(texture)
-            {
-                for(int i = 0; i < trianglesOfMesh.size(); i++)
-                {
-                    trianglesOfMesh[i]->setMaterial(materials[materialId]);
-                }
-            }
+        if(sceneCache.isReading())
+        {
+            job.cachedMesh = &sceneCache.readMesh();
+        }
+        else if(plyFileName)
+        {
+            job.plyFileName = plyFileName;
         }
         else if(binFileName)
         {
-            std::vector<Vec3i> meshVertexIndices = parseMeshFaces(binFileName);
-
-            trianglesOfMesh = createMeshTriangles(
-                vertexData,
-                meshVertexIndices,
-                shadingMode,
-                texture,
-                texCoordData
-            );
-
-            // if has texture, make each triangle have its own material
-            if(texture)
-            {
-                for(int i = 0; i < trianglesOfMesh.size(); i++)
-                {
-                    trianglesOfMesh[i]->setMaterial(materials[materialId]);
-                }
-            }
+            job.binFileName = binFileName;
         }
         else
         {
             // no ply file is supplied - get mesh information from xml file
-            child = meshElement->FirstChildElement("Faces");
-            stream << child->GetText() << std::endl;
+            job.faces = child->GetText();
 
             // get vertex offset
-            int vertexOffset = 0;
-            child->QueryAttribute("vertexOffset", &vertexOffset);
+            child->QueryAttribute("vertexOffset", &job.vertexOffset);
 
             // get texture offset
-            int textureOffset = 0;
-            child->QueryAttribute("textureOffset", &textureOffset);
-            textureOffset -= vertexOffset;
-
-            std::vector<Vec3i> meshVertexIndices;
-
-            // read vertex ids from stream
-            int v0_id, v1_id, v2_id;
-            while (!(stream >> v0_id).eof())
-            {
-                stream >> v1_id >> v2_id;
-                meshVertexIndices.push_back(
-                    Vec3i(
-                        v0_id + vertexOffset - 1,   // decrement by one for 0-based indexing
-                        v1_id + vertexOffset - 1,
-                        v2_id + vertexOffset - 1
-                        )
-                    );
-            }
-            stream.clear();
-
-            trianglesOfMesh = createMeshTriangles(
-                vertexData,
-                meshVertexIndices,
-                shadingMode,
-                texture,
-                texCoordData,
-                textureOffset
-            );
-
-            // if has texture, make each triangle have its own material
-            if(texture)
-            {
-                for(int i = 0; i < trianglesOfMesh.size(); i++)
-                {
-                    trianglesOfMesh[i]->setMaterial(materials[materialId]);
-                }
-            }
+            child->QueryAttribute("textureOffset", &job.textureOffset);
+            job.textureOffset -= job.vertexOffset;
         }
 
-
-        // from triangles of mesh, create a BVH
-        Shape* meshBVH = BoundingVolume::createBoundingVolumeHiearchy(trianglesOfMesh);
-
-        // set the material - if the material of each triangle is not set, which could happen
-        // .. if they have texture
-        if(!texture)
-            meshBVH->setMaterial(materials[materialId]);
-
-        // search if it has instances. if yes, create instances of it
+        // search if it has instances
         auto instanceElem = objects->FirstChildElement("MeshInstance");
         while(instanceElem)
         {
@@ -1042,102 +1217,324 @@ parseMesh(
             instanceElem->QueryAttribute("baseMeshId", &instanceId);
             if(instanceId == meshId)
             {
-                int instanceMaterialId;
-                Transformation instanceTransformation;
-                bool instanceHasTransformation = false;
+                MeshInstanceDescription instance;
 
-                bool instanceHasMotionBlur = false;
-                Vector3 instanceMotionBlur;
-
-                // found an instance of the mesh created above!
+                // found an instance of the mesh!
 
                 // read material id
                 if(doesHaveChild(instanceElem, "Material"))
-                    instanceMaterialId = parseChild<int>(instanceElem, "Material") - 1;
+                    instance.materialId = parseChild<int>(instanceElem, "Material") - 1;
 
                 // transformation
                     // check reset transform
                 const char* resetTransform = instanceElem->Attribute("resetTransform");
-                if((!resetTransform || (resetTransform && resetTransform[0] == 'f')) && hasTransformation)
+                if((!resetTransform || (resetTransform && resetTransform[0] == 'f')) && job.hasTransformation)
                 {
                     // add the transformation of the instanced mesh
-                    instanceHasTransformation = true;
-                    instanceTransformation += transformation;
+                    instance.hasTransformation = true;
+                    instance.transformation += job.transformation;
                 }
                     // read transformations
                 if(doesHaveChild(instanceElem, "Transformations"))
                 {
-                    instanceHasTransformation = true;
-                    instanceTransformation += parseObjectTransformation(instanceElem, translations, scalings, rotations);
+                    instance.hasTransformation = true;
+                    instance.transformation += parseObjectTransformation(instanceElem, translations, scalings, rotations);
                 }
 
                     // read motion blur
                 if(doesHaveChild(instanceElem, "MotionBlur"))
                 {
-                    instanceHasMotionBlur = true;
-                    instanceMotionBlur = parseChild<Vector3>(instanceElem, "MotionBlur");
+                    instance.hasMotionBlur = true;
+                    instance.motionBlur = parseChild<Vector3>(instanceElem, "MotionBlur");
                 }
 
-                // make instance
-                Shape* instanceBVH = BoundingVolume::makeInstanceOf((BoundingVolume*)meshBVH);
+                job.instances.push_back(instance);
+            }
 
-                    // set
+            instanceElem = instanceElem->NextSiblingElement("MeshInstance");
+        }
 
-                // if it has transformation, apply
-                if(instanceHasTransformation)
-                {
-                    instanceBVH->transform(instanceTransformation);
-                }
+        return job;
+}
 
-                // if it has motion blur, apply
-                if(instanceHasMotionBlur)
-                {
-                    instanceBVH->setMotionBlur(instanceMotionBlur);
-                }
+// creates the triangles of a mesh, run by a task
+void
+buildMeshTriangles(
+    MeshJob& job,
+    const std::vector<Vertex>& vertexData,
+    const std::vector<Vec2f>& texCoordData,
+    const std::vector<Material>& materials
+    )
+{
+        const Transformation* bakedTransformation = job.isTransformationBaked ? &job.transformation : nullptr;
+
+        if(job.cachedMesh)
+        {
+            job.trianglesOfMesh = createCachedMeshTriangles(*job.cachedMesh, job.shadingMode, job.texture);
+        }
+        else if(!job.plyFileName.empty())
+        {
+            // the buffers of the file are the ones the triangles are created
+            // .. from, the vertices have the normals of the file if it has them
+            PlyMesh plyMesh = parsePly(job.plyFileName);
+
+            if(job.shadingMode == ShadingMode::SMOOTH && !plyMesh.hasNormals)
+                computeSmoothNormals(plyMesh.vertices, plyMesh.faces);
+
+            job.trianglesOfMesh = createMeshTriangles(
+                plyMesh.vertices,
+                plyMesh.faces,
+                job.shadingMode,
+                job.texture,
+                plyMesh.texCoords,
+                0,
+                bakedTransformation,
+                job.shadingMode == ShadingMode::SMOOTH
+            );
+        }
+        else if(!job.binFileName.empty())
+        {
+            std::vector<Vec3i> meshVertexIndices = parseMeshFaces(job.binFileName);
+
+            job.trianglesOfMesh = createMeshTriangles(
+                vertexData,
+                meshVertexIndices,
+                job.shadingMode,
+                job.texture,
+                texCoordData,
+                0,
+                bakedTransformation
+            );
+        }
+        else
+        {
+            std::vector<int> ids = parseIntegerList(job.faces, "Faces of " + job.name);
+
+            if(ids.size() % 3 != 0)
+                throw std::runtime_error("Error: Faces of " + job.name + " has a triangle of fewer than three vertices.");
 
-                // set the material
-                instanceBVH->setMaterial(materials[instanceMaterialId]);
+            std::vector<Vec3i> meshVertexIndices(ids.size() / 3);
 
-                shapes.push_back(instanceBVH);
+            for(int i = 0; i < (int)meshVertexIndices.size(); i++)
+            {
+                meshVertexIndices[i] = Vec3i(
+                    ids[3 * i]     + job.vertexOffset - 1,   // decrement by one for 0-based indexing
+                    ids[3 * i + 1] + job.vertexOffset - 1,
+                    ids[3 * i + 2] + job.vertexOffset - 1
+                    );
             }
 
-            instanceElem = instanceElem->NextSiblingElement("MeshInstance");
+            job.trianglesOfMesh = createMeshTriangles(
+                vertexData,
+                meshVertexIndices,
+                job.shadingMode,
+                job.texture,
+                texCoordData,
+                job.textureOffset,
+                bakedTransformation
+            );
         }
-        
-        // if it has transformation, apply
-        if(hasTransformation)
+
+        // if has texture, make each triangle have its own material
+        if(job.texture)
         {
-            meshBVH->transform(transformation);
+            for(int i = 0; i < job.trianglesOfMesh.size(); i++)
+            {
+                job.trianglesOfMesh[i]->setMaterial(materials[job.materialId]);
+            }
         }
+}
 
-        // if it has motion blur, apply
-        if(hasMotionBlur)
+// from triangles of mesh, create a BVH, run by a task. the layout of the
+// .. hiearchy is recorded if it is to be cached
+void buildMeshHiearchy(MeshJob& job, bool isCacheWriting)
+{
+        if(job.cachedMesh)
+        {
+            job.meshBVH = BoundingVolume::createBoundingVolumeHiearchy(job.trianglesOfMesh, job.cachedMesh->leftSizes, job.cachedMesh->numberOfSplits);
+        }
+        else if(isCacheWriting)
         {
-            meshBVH->setMotionBlur(motionBlur);
+            job.meshBVH = BoundingVolume::createBoundingVolumeHiearchy(job.trianglesOfMesh, job.leftSizes);
         }
+        else
+        {
+            job.meshBVH = BoundingVolume::createBoundingVolumeHiearchy(job.trianglesOfMesh);
+        }
+}
 
-        // push the BVH of shape to main vector
-        shapes.push_back(meshBVH);
+// writes a built mesh to the cache
+void writeCachedMesh(const MeshJob& job, SceneCache& sceneCache)
+{
+        Position3 minPosition = job.meshBVH->getMinPosition();
+        Position3 maxPosition = job.meshBVH->getMaxPosition();
 
-        // return a vector of shapes
+        float minCoordinates[3] = { minPosition.getX(), minPosition.getY(), minPosition.getZ() };
+        float maxCoordinates[3] = { maxPosition.getX(), maxPosition.getY(), maxPosition.getZ() };
+
+        // the triangles of the mesh are not transformed, they are the
+        // .. primitives of its compiled hiearchy
+        CompiledBVH compiledMesh;
+        compiledMesh.compile(job.meshBVH);
+
+        if(!compiledMesh.isTriangleMesh())
+            throw std::runtime_error("Error: Mesh " + job.name + " cannot be cached, its compiled hiearchy is not of its triangles alone.");
+
+        sceneCache.writeMesh(getCachedTriangles(job.trianglesOfMesh), job.leftSizes, minCoordinates, maxCoordinates, compiledMesh.getMeshArrays());
 }
 
-Sphere*
-parseSphere(
-    tinyxml2::XMLElement* element,
-    const std::vector<Vertex>& vertexData,
-    const std::vector<Material>& materials,
-    const std::vector<Translation>& translations,
-    const std::vector<Scaling>& scalings,
-    const std::vector<Rotation>& rotations,
-    const std::map<int, Texture*>& textures
-    )
+// out of core, writes a built mesh to the cache and deletes it, only its
+// .. bounds are kept. in the order of the scene file
+void unloadMesh(MeshJob& job, SceneCache& sceneCache)
 {
-        int centerVertexId, materialId;
-        float radius;
+        job.minPosition = job.meshBVH->getMinPosition();
+        job.maxPosition = job.meshBVH->getMaxPosition();
 
-        // material id
-        if(doesHaveChild(element, "Material"))
+        writeCachedMesh(job, sceneCache);
+
+        std::vector<Shape*>().swap(job.trianglesOfMesh);
+        std::vector<int32_t>().swap(job.leftSizes);
+
+        delete job.meshBVH;
+        job.meshBVH = nullptr;
+}
+
+// out of core, creates a mesh of the geometry cache and its instances, in the
+// .. order of the scene file. returns the instances followed by the mesh
+std::vector<Shape*>
+instantiateLazyMesh(
+    const MeshJob& job,
+    int cachedMeshIndex,
+    const std::vector<Material>& materials,
+    GeometryCache& geometryCache
+    )
+{
+        std::vector<Shape*> shapes;
+
+        int meshIndex = geometryCache.addMesh(cachedMeshIndex, job.texture, materials[job.materialId]);
+
+        for(int i = 0; i < (int)job.instances.size(); i++)
+        {
+            const MeshInstanceDescription& instance = job.instances[i];
+
+            LazyMesh* lazyInstance = new LazyMesh(&geometryCache, meshIndex, job.minPosition, job.maxPosition);
+
+            if(instance.hasTransformation)
+                lazyInstance->transform(instance.transformation);
+
+            if(instance.hasMotionBlur)
+                lazyInstance->setMotionBlur(instance.motionBlur);
+
+            lazyInstance->setMaterial(materials[instance.materialId]);
+
+            shapes.push_back(lazyInstance);
+        }
+
+        LazyMesh* lazyMesh = new LazyMesh(&geometryCache, meshIndex, job.minPosition, job.maxPosition);
+
+        // the triangles of a textured mesh have the material themselves
+        if(!job.texture)
+            lazyMesh->setMaterial(materials[job.materialId]);
+
+        if(job.hasTransformation)
+            lazyMesh->transform(job.transformation);
+
+        if(job.hasMotionBlur)
+            lazyMesh->setMotionBlur(job.motionBlur);
+
+        shapes.push_back(lazyMesh);
+
+        return shapes;
+}
+
+// caches a built mesh and creates its instances, in the order of the scene
+// .. file. returns the instances followed by the mesh
+std::vector<Shape*>
+instantiateMesh(
+    MeshJob& job,
+    const std::vector<Material>& materials,
+    SceneCache& sceneCache
+    )
+{
+        std::vector<Shape*> shapes;
+        Shape* meshBVH = job.meshBVH;
+
+        if(sceneCache.isWriting())
+            writeCachedMesh(job, sceneCache);
+
+        // the triangles are owned by the hiearchy
+        std::vector<Shape*>().swap(job.trianglesOfMesh);
+        std::vector<int32_t>().swap(job.leftSizes);
+
+        // set the material - if the material of each triangle is not set, which could happen
+        // .. if they have texture
+        if(!job.texture)
+            meshBVH->setMaterial(materials[job.materialId]);
+
+        // create the instances of it
+        for(int i = 0; i < (int)job.instances.size(); i++)
+        {
+            const MeshInstanceDescription& instance = job.instances[i];
+
+            // make instance
+            Shape* instanceBVH = BoundingVolume::makeInstanceOf((BoundingVolume*)meshBVH);
+
+            // if it has transformation, apply
+            if(instance.hasTransformation)
+            {
+                instanceBVH->transform(instance.transformation);
+            }
+
+            // if it has motion blur, apply
+            if(instance.hasMotionBlur)
+            {
+                instanceBVH->setMotionBlur(instance.motionBlur);
+            }
+
+            // set the material
+            instanceBVH->setMaterial(materials[instance.materialId]);
+
+            shapes.push_back(instanceBVH);
+        }
+        
+        // if it has transformation, apply
+        if(job.hasTransformation)
+        {
+            meshBVH->transform(job.transformation);
+        }
+
+        // if it has motion blur, apply
+        if(job.hasMotionBlur)
+        {
+            meshBVH->setMotionBlur(job.motionBlur);
+        }
+
+        // push the BVH of shape to main vector
+        shapes.push_back(meshBVH);
+
+        // return a vector of shapes
+        return shapes;
+}
+
+Sphere*
+parseSphere(
+    tinyxml2::XMLElement* element,
+    const std::vector<Vertex>& vertexData,
+    const std::vector<Material>& materials,
+    const std::vector<Translation>& translations,
+    const std::vector<Scaling>& scalings,
+    const std::vector<Rotation>& rotations,
+    const std::map<int, Texture*>& textures,
+    std::vector<std::string>& bakedObjects,
+    TaskGraph& taskGraph,
+    const std::map<const Texture*, TaskGraph::TaskId>& textureDecodes
+    )
+{
+        int centerVertexId, materialId;
+        float radius;
+
+        // material id
+        if(doesHaveChild(element, "Material"))
             materialId = parseChild<int>(element, "Material") - 1;
         
         // center vertex id
@@ -1154,16 +1551,40 @@ parseSphere(
         if(doesHaveChild(element, "Radius"))
             radius = parseChild<float>(element, "Radius");
         
-        // create a new sphere
-        Sphere * sphere = new Sphere(center, radius, materials[materialId]);
+        Texture* texture = nullptr;
+
+        if(doesHaveChild(element, "Texture"))
+            texture = textures.at(parseChild<int>(element, "Texture"));
 
         // transformations
+        bool hasTransformation = false;
+        Transformation transformation;
+
         if(doesHaveChild(element, "Transformations"))
         {
-            Transformation transformation = parseObjectTransformation(element, translations, scalings, rotations);
-            sphere->transform(transformation);
+            hasTransformation = true;
+            transformation = parseObjectTransformation(element, translations, scalings, rotations);
+
+            // bake the transformation if possible
+            float scale;
+
+            if(canBakeSphereTransformation(transformation, texture, scale))
+            {
+                center = transformation.transform(center);
+                radius *= scale;
+
+                hasTransformation = false;
+
+                bakedObjects.push_back(getObjectName(element));
+            }
         }
 
+        // create a new sphere
+        Sphere * sphere = new Sphere(center, radius, materials[materialId]);
+
+        if(hasTransformation)
+            sphere->transform(transformation);
+
         // motion blur
         if(doesHaveChild(element, "MotionBlur"))
         {
@@ -1171,33 +1592,49 @@ parseSphere(
             sphere->setMotionBlur(motionBlur);
         }
 
-        // texture
-        if(doesHaveChild(element, "Texture"))
+        // texture, set once its image is decoded
+        if(texture)
         {
-            int textureId = parseChild<int>(element, "Texture");
-            
-            sphere->setTexture(textures.at(textureId));
+            taskGraph.wait(getTextureDecodes(texture, textureDecodes));
+            sphere->setTexture(texture);
         }
 
         return sphere;
 }
 
-void Scene::loadFromXml(const std::string& filepath)
+void Scene::loadFromXml(const std::string& filepath, const RenderOptions& options)
 {
+    TaskGraph::Clock::time_point loadingStart = TaskGraph::Clock::now();
+    TaskGraph::Clock::time_point stageStart = loadingStart;
+
     tinyxml2::XMLDocument file;
     std::stringstream stream;
 
     std::vector<Shape*> shapes;
 
+    // the objects whose transformations are applied to their data
+    std::vector<std::string> bakedObjects;
+
     // transformation vectors
     std::vector<Scaling> scalings;
     std::vector<Translation> translations;
     std::vector<Rotation> rotations;
-    //std::vector<Texture*> textures; // to be cleaned after required assignments
-    std::map<int, Texture*> textures; // textures with ids
+    std::map<int, Texture*> textures; // textures with ids, owned by the scene
     std::vector<Vec2f> texCoordData;
 
     std::vector<BRDF> brdfs;
+
+    // the tasks decoding the images of the textures, by texture and by image
+    std::map<const Texture*, TaskGraph::TaskId> textureDecodes;
+    std::map<const TextureCache::TiledImage*, TaskGraph::TaskId> imageLoads;
+
+    // the meshes, built by the tasks and instantiated once all are built
+    std::deque<MeshJob> meshJobs;
+    std::deque<MeshJob> lightMeshJobs;
+    std::vector<Vector3> lightMeshRadiances;
+
+    // the place of the environment light, added once its map is decoded
+    int environmentLightIndex = -1;
     
     auto res = file.LoadFile(filepath.data());
     if (res)
@@ -1212,6 +1649,46 @@ void Scene::loadFromXml(const std::string& filepath)
         throw std::runtime_error("Error: Root is not found.");
     }
 
+    // the meshes are read from the cache if it is valid, otherwise it is
+    // .. written while they are loaded
+    SceneCache sceneCache;
+
+    if(options.sceneCache)
+    {
+        std::vector<std::string> referencedFiles;
+        collectReferencedFiles(root->FirstChildElement(), referencedFiles);
+
+        sceneCache.open(filepath, SceneCache::computeKey(filepath, referencedFiles));
+    }
+
+    // out of core, the meshes are loaded from the cache while rendering, so
+    // .. they are only written to it while the scene is loaded, if they are
+    // .. not cached yet
+    bool isOutOfCore = options.outOfCore;
+
+    if(isOutOfCore)
+    {
+        if(!sceneCache.isReading() && !sceneCache.isWriting())
+            throw std::runtime_error("Error: Scene cache " + sceneCache.getFilePath() + " cannot be written, the meshes are loaded from it out of core.");
+
+        this->geometryCache = new GeometryCache(options.geometryBudget);
+    }
+
+    // the tiles of the images are kept in memory unless there is a budget
+    this->textureCache = new TextureCache(options.textureCache ? options.textureBudget : 0);
+
+    // the meshes written to the cache out of core are deleted in order, so
+    // .. that at most this many of them are built at a time
+    int unloadingWindow = std::max(2 * (int)options.numberOfThreads, 1);
+    int numberOfUnloadedMeshes = 0;
+
+    // the images are decoded, and the meshes are built, by the tasks while
+    // .. the scene file is read. the scene file is read by this thread only
+    TaskGraph taskGraph(options.numberOfThreads);
+
+    taskGraph.addStageTime("scene file", stageStart);
+    stageStart = TaskGraph::Clock::now();
+
     //
     // BackgroundColor
     //
@@ -1232,29 +1709,30 @@ void Scene::loadFromXml(const std::string& filepath)
 
         if(text == "PathTracing")
         {
-            // check IntegratorParams
+            // default path tracing: uniform
+            this->integrator = Integrator::UNIFORM_PATHTRACING;
+
+            // check IntegratorParams, a list of options
             element = root->FirstChildElement("IntegratorParams");
 
-            if(element)
+            if(element && element->GetText())
             {
                 stream << element->GetText() << std::endl;
-                stream >> text;
-                stream.clear();
 
-                if(text == "ImportanceSampling")
+                while(stream >> text)
                 {
-                    // importance
-                    this->integrator = Integrator::IMPORTANCE_PATHTRACING;
+                    if(text == "ImportanceSampling")
+                    {
+                        // importance
+                        this->integrator = Integrator::IMPORTANCE_PATHTRACING;
+                    }
+                    else if(text == "MultipleImportanceSampling")
+                    {
+                        this->multipleImportanceSampling = true;
+                    }
                 }
-                else
-                {
-                    this->integrator = Integrator::UNIFORM_PATHTRACING;
-                }
-            }
-            else 
-            {
-                // default path tracing: uniform
-                this->integrator = Integrator::UNIFORM_PATHTRACING;
+
+                stream.clear();
             }
         }
         else 
@@ -1299,6 +1777,148 @@ void Scene::loadFromXml(const std::string& filepath)
 
     stream >> this->maxRecursionDepth;
 
+    //
+    // MaxDiffuseDepth, MaxSpecularDepth, MaxTransmissionDepth
+    //
+    {
+        // maximum number of bounces of each type on a path
+        // .. if not specified, only MaxRecursionDepth limits the paths
+        const char* maxBounceDepthElements[NUMBER_OF_BOUNCE_TYPES] = {
+            "MaxDiffuseDepth", "MaxSpecularDepth", "MaxTransmissionDepth"
+        };
+
+        for(int i = 0; i < NUMBER_OF_BOUNCE_TYPES; i++)
+        {
+            element = root->FirstChildElement(maxBounceDepthElements[i]);
+            if (element)
+            {
+                stream << element->GetText() << std::endl;
+                stream >> this->maxBounceDepth[i];
+            }
+            else
+            {
+                this->maxBounceDepth[i] = this->maxRecursionDepth;
+            }
+        }
+    }
+
+    //
+    // RussianRouletteDepth
+    //
+    element = root->FirstChildElement("RussianRouletteDepth");
+    if (element)
+    {
+        stream << element->GetText() << std::endl;
+    }
+    else
+    {
+        stream << DEFAULT_RUSSIAN_ROULETTE_DEPTH << std::endl;
+    }
+
+    stream >> this->russianRouletteDepth;
+
+    //
+    // FresnelSampling, FresnelSplittingFactor
+    //
+    element = root->FirstChildElement("FresnelSampling");
+    if (element)
+    {
+        stream << element->GetText() << std::endl;
+
+        std::string text;
+        stream >> text;
+        stream.clear();
+
+        // "Split": both of the reflection and refraction rays are traced (default)
+        // "Stochastic": one of them is chosen by the reflectance
+        if(text == "Stochastic")
+            this->stochasticFresnel = true;
+        else if(text != "Split")
+            throw std::runtime_error("Error: Unknown FresnelSampling: " + text);
+    }
+
+    //
+    // LightSampling, LightSamples
+    //
+    element = root->FirstChildElement("LightSampling");
+    if (element)
+    {
+        stream << element->GetText() << std::endl;
+
+        std::string text;
+        stream >> text;
+        stream.clear();
+
+        // "All": every light is sampled at each hit (default)
+        // "Power", "BVH": LightSamples of them are chosen by the light sampler
+        if(text == "Power")
+            this->lightSampling = POWER_LIGHT_SAMPLING;
+        else if(text == "BVH")
+            this->lightSampling = BVH_LIGHT_SAMPLING;
+        else if(text != "All")
+            throw std::runtime_error("Error: Unknown LightSampling: " + text);
+    }
+
+    element = root->FirstChildElement("LightSamples");
+    if (element)
+    {
+        stream << element->GetText() << std::endl;
+        stream >> this->lightSamplesPerHit;
+
+        if(this->lightSamplesPerHit < 1)
+            throw std::runtime_error("Error: LightSamples should be at least 1.");
+    }
+
+    element = root->FirstChildElement("FresnelSplittingFactor");
+    if (element)
+    {
+        stream << element->GetText() << std::endl;
+        stream >> this->fresnelSplittingFactor;
+
+        if(this->fresnelSplittingFactor < 1)
+            throw std::runtime_error("Error: FresnelSplittingFactor should be at least 1.");
+    }
+
+    //
+    // ShadowRays
+    //
+    element = root->FirstChildElement("ShadowRays");
+    if (element)
+    {
+        stream << element->GetText() << std::endl;
+
+        std::string text;
+        stream >> text;
+        stream.clear();
+
+        // "Immediate": traced while shading (default)
+        // "Batched": queued per thread and traced together
+        if(text == "Batched")
+            this->batchShadowRays = true;
+        else if(text != "Immediate")
+            throw std::runtime_error("Error: Unknown ShadowRays: " + text);
+    }
+
+    //
+    // RenderingOrder
+    //
+    element = root->FirstChildElement("RenderingOrder");
+    if (element)
+    {
+        stream << element->GetText() << std::endl;
+
+        std::string text;
+        stream >> text;
+        stream.clear();
+
+        // "DepthFirst": each path is traced to its end (default)
+        // "Wavefront": the paths of a batch of pixels advance a bounce at a time
+        if(text == "Wavefront")
+            this->renderingOrder = RenderingOrder::WAVEFRONT;
+        else if(text != "DepthFirst")
+            throw std::runtime_error("Error: Unknown RenderingOrder: " + text);
+    }
+
     //
     // Camera
     //
@@ -1342,11 +1962,21 @@ void Scene::loadFromXml(const std::string& filepath)
         {
             std::string imagePath = parseChild<std::string>(child, "EnvMapName");
 
-            // add as environment map
-            this->sphericalEnvLight = new SphericalEnvLight(imagePath);
+            // shadow check
+            bool shadowCheck = DEFAULT_ENV_MAP_SHADOW_CHECK;
+            if(doesHaveChild(child, "ShadowCheck"))
+                shadowCheck = parseChild<std::string>(child, "ShadowCheck") == "true";
 
-            // add as light
-            lights.push_back(new SphericalEnvLight(*this->sphericalEnvLight));
+            // add as environment map, its sampling tables are built with it
+            taskGraph.add("environment map", [this, imagePath, shadowCheck]()
+            {
+                this->sphericalEnvLight = new SphericalEnvLight(imagePath);
+                this->sphericalEnvLight->setShadowCheck(shadowCheck);
+            });
+
+            // add as light, once it is loaded
+            environmentLightIndex = lights.size();
+            lights.push_back(nullptr);
         }
     }
     
@@ -1543,9 +2173,13 @@ void Scene::loadFromXml(const std::string& filepath)
         element->QueryAttribute("id", &textureId);
 
         // parse texture
-        Texture* texture = parseTexture(element);
+        TaskGraph::TaskId decodeTask;
+        Texture* texture = parseTexture(element, *this->textureCache, taskGraph, imageLoads, decodeTask);
         textures.insert( std::pair<int, Texture*>(textureId, texture) );
-        //textures.push_back(texture);
+        this->textures.push_back(texture);
+
+        if(decodeTask >= 0)
+            textureDecodes[texture] = decodeTask;
         
         element = element->NextSiblingElement("Texture");
     }
@@ -1568,15 +2202,13 @@ void Scene::loadFromXml(const std::string& filepath)
         }
         else
         {
-            stream << element->GetText() << std::endl;
+            std::vector<float> coordinates = parseRealList(element->GetText(), "TexCoordData");
 
-            // read from stream and push to texCoordData vector
-            int x, y;
-            while (!(stream >> x).eof())
-            {
-                stream >> y;
-                texCoordData.push_back(Vec2f(x, y)); // 0-index
-            }
+            // a last incomplete pair is ignored
+            texCoordData.reserve(coordinates.size() / 2);
+
+            for(size_t i = 0; i + 1 < coordinates.size(); i += 2)
+                texCoordData.push_back(Vec2f(coordinates[i], coordinates[i + 1])); // 0-index
         }
     }
 
@@ -1654,21 +2286,41 @@ void Scene::loadFromXml(const std::string& filepath)
         }
         else
         {
-            stream << element->GetText() << std::endl;
-                // read from stream and push to vertex data vector
-            Position3 vertex;
-            while (!(stream >> vertex).eof())
-            {
-                vertexData.push_back(vertex);
-            }
+            std::vector<float> coordinates = parseRealList(element->GetText(), "VertexData");
+
+            // a last incomplete vertex is ignored
+            vertexData.reserve(coordinates.size() / 3);
 
-            stream.clear();
+            for(size_t i = 0; i + 2 < coordinates.size(); i += 3)
+                vertexData.push_back(Position3(coordinates[i], coordinates[i + 1], coordinates[i + 2]));
         }
 
 
     }
 
 
+    taskGraph.addStageTime("parsing", stageStart);
+    stageStart = TaskGraph::Clock::now();
+
+    // the triangles of a mesh are created once the image of its texture is
+    // .. decoded, since it is copied to them, then its hiearchy is built
+    auto addMeshTasks = [&](MeshJob& job)
+    {
+        TaskGraph::TaskId trianglesTask = taskGraph.add(
+            "mesh triangles",
+            [this, &job, &texCoordData]() { buildMeshTriangles(job, vertexData, texCoordData, materials); },
+            getTextureDecodes(job.texture, textureDecodes)
+            );
+
+        bool isCacheWriting = sceneCache.isWriting();
+
+        job.hiearchyTask = taskGraph.add(
+            "mesh BVHs",
+            [&job, isCacheWriting]() { buildMeshHiearchy(job, isCacheWriting); },
+            { trianglesTask }
+            );
+    };
+
     //
     // Mesh
     //
@@ -1676,16 +2328,36 @@ void Scene::loadFromXml(const std::string& filepath)
     element = objects->FirstChildElement("Mesh");
     while (element)
     {
-        std::vector<Shape*> meshes = 
+        meshJobs.push_back(
             parseMesh(
                 element, objects,
                 translations, scalings, rotations,
                 textures,
-                vertexData, texCoordData,
-                materials
-                );
-    
-        shapes.insert(shapes.end(), meshes.begin(), meshes.end());
+                bakedObjects,
+                sceneCache
+                )
+            );
+
+        MeshJob& job = meshJobs.back();
+
+        if(isOutOfCore && job.cachedMesh)
+        {
+            // only the bounds are read
+            job.minPosition = Position3(job.cachedMesh->minPosition[0], job.cachedMesh->minPosition[1], job.cachedMesh->minPosition[2]);
+            job.maxPosition = Position3(job.cachedMesh->maxPosition[0], job.cachedMesh->maxPosition[1], job.cachedMesh->maxPosition[2]);
+        }
+        else
+        {
+            addMeshTasks(job);
+        }
+
+        while(isOutOfCore && !job.cachedMesh && (int)meshJobs.size() - numberOfUnloadedMeshes > unloadingWindow)
+        {
+            MeshJob& builtJob = meshJobs[numberOfUnloadedMeshes++];
+
+            taskGraph.wait(builtJob.hiearchyTask);
+            unloadMesh(builtJob, sceneCache);
+        }
 
         element = element->NextSiblingElement("Mesh");
     }
@@ -1711,20 +2383,39 @@ void Scene::loadFromXml(const std::string& filepath)
         stream << child->GetText() << std::endl;
         stream >> v0_id >> v1_id >> v2_id;
 
+        Vertex vertices[3] = { Position3(vertexData[v0_id - 1]), Position3(vertexData[v1_id - 1]), Position3(vertexData[v2_id - 1]) };
+
+        // transformations
+        bool hasTransformation = false;
+        Transformation transformation;
+
+        if(doesHaveChild(element, "Transformations"))
+        {
+            hasTransformation = true;
+            transformation = parseObjectTransformation(element, translations, scalings, rotations);
+
+            // bake the transformation if possible
+            if(canBakeTransformation(transformation, nullptr))
+            {
+                for(int i = 0; i < 3; i++)
+                    vertices[i] = bakeVertex(vertices[i], transformation);
+
+                hasTransformation = false;
+
+                bakedObjects.push_back(getObjectName(element));
+            }
+        }
+
         // create triangle
         Triangle * triangle = new Triangle(
             materials[materialId],          // material
-            Position3(vertexData[v0_id - 1]),   // v0
-            Position3(vertexData[v1_id - 1]),   // v1
-            Position3(vertexData[v2_id - 1])    // v2
+            vertices[0],                    // v0
+            vertices[1],                    // v1
+            vertices[2]                     // v2
         );
 
-        // transformations
-        if(doesHaveChild(element, "Transformations"))
-        {
-            Transformation transformation = parseObjectTransformation(element, translations, scalings, rotations);
+        if(hasTransformation)
             triangle->transform(transformation);
-        }
 
         // motion blur
         if(doesHaveChild(element, "MotionBlur"))
@@ -1751,7 +2442,7 @@ void Scene::loadFromXml(const std::string& filepath)
     {
         // push the sphere to the surfaces vector
         shapes.push_back(
-            (Shape*)(parseSphere(element, vertexData, materials, translations, scalings, rotations, textures))
+            (Shape*)(parseSphere(element, vertexData, materials, translations, scalings, rotations, textures, bakedObjects, taskGraph, textureDecodes))
             );
 
         // read the next sphere sibling
@@ -1768,7 +2459,7 @@ void Scene::loadFromXml(const std::string& filepath)
     {
         Vector3 radiance;
 
-        Sphere* sphere = parseSphere(element, vertexData, materials, translations, scalings, rotations, textures);
+        Sphere* sphere = parseSphere(element, vertexData, materials, translations, scalings, rotations, textures, bakedObjects, taskGraph, textureDecodes);
 
         // radiance
         if(doesHaveChild(element, "Radiance"))
@@ -1783,6 +2474,9 @@ void Scene::loadFromXml(const std::string& filepath)
         shapes.push_back(lightSphere);
         lights.push_back(light);
 
+        // the instance hit by the rays stands for the light
+        lightSphere->setIndex(lights.size() - 1);
+
         // read the next sphere sibling
         element = element->NextSiblingElement("LightSphere");
     }
@@ -1801,36 +2495,133 @@ void Scene::loadFromXml(const std::string& filepath)
         if(doesHaveChild(element, "Radiance"))
             radiance = parseChild<Vector3>(element, "Radiance");
 
-        // Mesh BVH
-        std::vector<Shape*> lightMeshes = 
+        // Mesh BVH, the light is created once it is built
+        lightMeshJobs.push_back(
             parseMesh(
                 element, objects,
                 translations, scalings, rotations,
                 textures,
-                vertexData, texCoordData,
-                materials
-                );
-        
+                bakedObjects,
+                sceneCache
+                )
+            );
+
+        addMeshTasks(lightMeshJobs.back());
+        lightMeshRadiances.push_back(radiance);
+
+        element = element->NextSiblingElement("LightMesh");
+    }
+
+    taskGraph.addStageTime("objects", stageStart);
+
+    // the textures, the environment map and the meshes
+    taskGraph.waitAll();
+
+    stageStart = TaskGraph::Clock::now();
+
+    // the light sampler and the misses share the environment light, it is
+    // .. deleted once by ~Scene
+    if(environmentLightIndex >= 0)
+        lights[environmentLightIndex] = this->sphericalEnvLight;
+
+    // the meshes precede the other shapes, in the order of the scene file
+    std::vector<Shape*> meshes;
+
+    for(int i = 0; i < (int)meshJobs.size(); i++)
+    {
+        std::vector<Shape*> meshShapes;
+
+        if(isOutOfCore)
+        {
+            if(!meshJobs[i].cachedMesh && i >= numberOfUnloadedMeshes)
+                unloadMesh(meshJobs[i], sceneCache);
+
+            // the meshes precede the light meshes in the cache
+            meshShapes = instantiateLazyMesh(meshJobs[i], i, materials, *this->geometryCache);
+        }
+        else
+        {
+            meshShapes = instantiateMesh(meshJobs[i], materials, sceneCache);
+        }
+
+        meshes.insert(meshes.end(), meshShapes.begin(), meshShapes.end());
+    }
+
+    shapes.insert(shapes.begin(), meshes.begin(), meshes.end());
+
+    for(int i = 0; i < (int)lightMeshJobs.size(); i++)
+    {
+        std::vector<Shape*> lightMeshes = instantiateMesh(lightMeshJobs[i], materials, sceneCache);
+
         // TODO: Memory leak?
         BoundingVolume* lightMeshBVH = (BoundingVolume*)lightMeshes[0];
         
-        LightMesh* light = new LightMesh(lightMeshBVH, radiance);
-        LightMesh* mesh  = new LightMesh(lightMeshBVH, radiance);    
+        LightMesh* light = new LightMesh(lightMeshBVH, lightMeshRadiances[i]);
+        LightMesh* mesh  = new LightMesh(lightMeshBVH, lightMeshRadiances[i]);
 
         // push the lightmesh to the required vectors
         shapes.push_back(mesh);
         lights.push_back(light);
 
-        element = element->NextSiblingElement("LightMesh");
+        // the instance hit by the rays stands for the light
+        mesh->setIndex(lights.size() - 1);
     }
 
+    taskGraph.addStageTime("instances", stageStart);
+
+    if(!bakedObjects.empty())
+    {
+        std::cout << "Baked the transformations of " << bakedObjects.size() << " objects:";
+
+        for(int i = 0; i < (int)bakedObjects.size(); i++)
+            std::cout << (i ? ", " : " ") << bakedObjects[i];
+
+        std::cout << std::endl;
+    }
+
+    if(sceneCache.isReading())
+        std::cout << "Read " << sceneCache.getNumberOfMeshes() << " meshes from the scene cache " << sceneCache.getFilePath() << std::endl;
+    else if(sceneCache.isWriting())
+        std::cout << "Writing " << sceneCache.getNumberOfMeshes() << " meshes to the scene cache " << sceneCache.getFilePath() << std::endl;
+
+    sceneCache.close();
+
+    if(isOutOfCore)
+    {
+        this->geometryCache->open(filepath, sceneCache.getKey());
+
+        std::cout << "Loading " << this->geometryCache->getNumberOfMeshes() << " meshes out of core, within "
+                  << this->geometryCache->getBudget() / (1024 * 1024) << " MB" << std::endl;
+    }
+
+    if(this->textureCache->isOutOfCore())
+    {
+        std::cout << "Loading " << this->textureCache->getNumberOfImages() << " texture images out of core, within "
+                  << this->textureCache->getBudget() / (1024 * 1024) << " MB" << std::endl;
+    }
+    else if(this->textureCache->getNumberOfImages() > 0)
+    {
+        std::cout << "Converted " << this->textureCache->getNumberOfImages() << " texture images to "
+                  << this->textureCache->getSize() / (1024.0 * 1024.0) << " MB of tiles" << std::endl;
+    }
     
     // create bounding volume hiearchy
+    stageStart = TaskGraph::Clock::now();
     this->BVH = BoundingVolume::createBoundingVolumeHiearchy(shapes);
+    taskGraph.addStageTime("top-level BVH", stageStart);
+
+    // index the lights
+    for(int i = 0; i < (int)lights.size(); i++)
+        lights[i]->setIndex(i);
+
+    stageStart = TaskGraph::Clock::now();
+    compile();
+    taskGraph.addStageTime("compilation", stageStart);
+
+    double loadingSeconds = std::chrono::duration<double>(TaskGraph::Clock::now() - loadingStart).count();
 
-    // clean textures
-    for(int i = 0; i < textures.size(); i++)
-        delete textures[i];
+    std::cout << "Loaded the scene in " << loadingSeconds << " s by " << options.numberOfThreads << " threads:" << std::endl;
+    taskGraph.printStageTimes(std::cout);
 }
 
 std::stringstream &operator>>(std::stringstream &st, Position3 & position)
@@ -6,6 +6,7 @@
 #include "../utility/concurrent_bag.hpp"
 #include "../utility/pixel_mission_generator.hpp"
 #include "../utility/random_number_generator.hpp"
+#include "../utility/shading_math.hpp"
 #include <forward_list>
 #include <cmath>
 
@@ -34,7 +35,7 @@ Color Scene::getSpecular(const Ray & ray, const Material & material, const HitIn
     
     float max = hitInfo.normal ^ h;
     max = max < 0.0f ? 0.0f : max;
-    max = pow(max, material.getPhongExponent());
+    max = shadingPow(max, material.getPhongExponent());
     
     Vector3 colorVector = material.getSpecular().intensify(incidentLight.intensity) * max;
     
@@ -46,37 +47,17 @@ Color Scene::getAmbientColor(const Material & material, const Vector3 & ambientL
     return Color(ambientLight.intensify(material.getAmbient()));
 }
 
-Color Scene::getReflectionColor(const Ray & ray, const HitInfo & hitInfo, int recursionDepth) const
-{
-    if(recursionDepth == 0)
-    {
-        return Color::Black();
-    }
-
-    Ray reflectionRay = ray.createReflectionRay(hitInfo);
-
-    // set time
-    reflectionRay.setTimeCreated(ray.getTimeCreated());
-
-    return getRayColor(reflectionRay, recursionDepth - 1, true);
-}
-
 bool isRefracted(float refractionIndexRatio, float cosTheta)
 {
-    float delta = 1 -  pow(refractionIndexRatio, 2) * (1 - pow(cosTheta, 2));
+    float delta = 1 - square(refractionIndexRatio) * (1 - square(cosTheta));
 
     return delta > 0.f;
 }
 
 
-Color Scene::getRefractionColor(const Ray & hittingRay, const HitInfo & hitInfo, int recursionDepth) const
+DielectricSplit Scene::splitOnDielectric(const Ray & hittingRay, const HitInfo & hitInfo) const
 {
-    if(recursionDepth == 0)
-    {
-        return Color::Black();
-    }
-
-    Color color = Color::Black();
+    DielectricSplit split;
 
     bool isEntering;
     float refractionIndexRatio;
@@ -90,52 +71,51 @@ Color Scene::getRefractionColor(const Ray & hittingRay, const HitInfo & hitInfo,
     if(cosTheta >= 0.f) // entering
     {
         isEntering = true;
-        refractionIndexRatio = AIR_REFRACTION_INDEX / hitInfo.material.getRefractionIndex();
+        refractionIndexRatio = AIR_REFRACTION_INDEX / hitInfo.material->getRefractionIndex();
         normal = hitInfo.normal;
     }
     else // was already inside the refractive object
     {
         isEntering = false;
-        refractionIndexRatio = hitInfo.material.getRefractionIndex() / AIR_REFRACTION_INDEX;
+        refractionIndexRatio = hitInfo.material->getRefractionIndex() / AIR_REFRACTION_INDEX;
         normal = -hitInfo.normal;
         reflectionRayHitInfo.normal = - reflectionRayHitInfo.normal;
     }
 
-    float theta = acos(cosTheta);
-    float sinTheta = sin(theta);
-    float sinPhi = refractionIndexRatio * sinTheta;
-    float phi = asin(sinPhi);
-    float cosPhi = cos(phi);
-    
-    // take abs of cosPhi and cosTheta since we are looking for the acute angle
-    cosPhi = cosPhi < 0.f ? -cosPhi : cosPhi;
+    // take abs of cosTheta since we are looking for the acute angle
     cosTheta = cosTheta < 0.f ? -cosTheta : cosTheta;
 
+    // sines from the cosines, rather than through the angles
+    float sinTheta = sqrt(std::fmax(0.f, 1 - square(cosTheta)));
+    float sinPhi = refractionIndexRatio * sinTheta;
+
+    // no refraction angle in case of total internal reflection
+    bool hasRefractionAngle = sinPhi <= 1.f;
+    float cosPhi = hasRefractionAngle ? sqrt(1 - square(sinPhi)) : 0.f;
+
     // compute R_0
-    float R_0 = pow(
-        (hitInfo.material.getRefractionIndex() - AIR_REFRACTION_INDEX)
-        / (hitInfo.material.getRefractionIndex() + AIR_REFRACTION_INDEX)
-    , 2);
+    float R_0 = square(
+        (hitInfo.material->getRefractionIndex() - AIR_REFRACTION_INDEX)
+        / (hitInfo.material->getRefractionIndex() + AIR_REFRACTION_INDEX)
+    );
 
     // compute R_theta
-    float R_theta = R_0 + (1 - R_0) * pow(1 - cosTheta, 5);
-    if(!std::isnan(cosPhi) && cosPhi < cosTheta)
+    float R_theta = R_0 + (1 - R_0) * powFive(1 - cosTheta);
+    if(hasRefractionAngle && cosPhi < cosTheta)
     {
-        R_theta = R_0 + (1 - R_0) * pow(1 - cosPhi, 5);
+        R_theta = R_0 + (1 - R_0) * powFive(1 - cosPhi);
     }
 
-    // init refraction and reflection color as black
-    Color refractionColor = Color::Black();
-    Color reflectionColor = Color::Black();
-
     // create reflection ray
-    Ray reflectionRay = hittingRay.createReflectionRay(reflectionRayHitInfo);
+    split.reflectionRay = hittingRay.createReflectionRay(reflectionRayHitInfo);
 
     // set time
-    reflectionRay.setTimeCreated(hittingRay.getTimeCreated());
+    split.reflectionRay.setTimeCreated(hittingRay.getTimeCreated());
 
-    // get reflected ray's color
-    reflectionColor = getRayColor(reflectionRay, recursionDepth - 1, false);
+    // all of the light is reflected unless it is refracted
+    split.reflectionWeight = Vector3(1.f);
+    split.refractionWeight = Vector3(0.f);
+    split.reflectance = 1.f;
 
     if(isRefracted(refractionIndexRatio, cosTheta))
     {
@@ -144,52 +124,135 @@ Color Scene::getRefractionColor(const Ray & hittingRay, const HitInfo & hitInfo,
             ((hittingRay.getDirection() + (normal * cosTheta)) *  refractionIndexRatio) - (normal * cosPhi);
         
         // create the refracted ray, origined at hit position(+epsilon) and directed as t
-        Ray refractedRay = Ray(hitInfo.hitPosition, t).translateRayOrigin(shadowRayEpsilon);
+        split.refractionRay = Ray(hitInfo.hitPosition, t).translateRayOrigin(shadowRayEpsilon);
 
         // set time
-        refractedRay.setTimeCreated(hittingRay.getTimeCreated());
+        split.refractionRay.setTimeCreated(hittingRay.getTimeCreated());
 
-        // set refracted ray's color
-        refractionColor = getRayColor(refractedRay, recursionDepth - 1, false)
-            .intensify(Vector3(1 - R_theta));
-
-        // intensify reflection color
-        reflectionColor.intensify(Vector3(R_theta));
+        split.reflectionWeight = Vector3(R_theta);
+        split.refractionWeight = Vector3(1 - R_theta);
+        split.reflectance = R_theta;
     }
 
     if(!isEntering)
     {
         // if the ray was inside, attenuation should be applied to the color
-        Vector3 attenuation = hitInfo.material.getTransparency().power(hitInfo.t);
+        Vector3 attenuation = hitInfo.material->getTransparency().power(hitInfo.t);
 
-        refractionColor.intensify(attenuation);
-        reflectionColor.intensify(attenuation);
+        split.reflectionWeight = split.reflectionWeight.intensify(attenuation);
+        split.refractionWeight = split.refractionWeight.intensify(attenuation);
     }
 
-    color += refractionColor;
-    color += reflectionColor;
+    return split;
+}
+
+// weight of a sample taken with pdf, while the other sampling technique would
+// .. have taken it with otherPdf (power heuristic, beta = 2)
+float powerHeuristic(float pdf, float otherPdf)
+{
+    float pdfSq = pdf * pdf;
+    float otherPdfSq = otherPdf * otherPdf;
+
+    if(pdfSq + otherPdfSq <= 0.f)
+        return 0.f;
+
+    return pdfSq / (pdfSq + otherPdfSq);
+}
+
+bool Scene::canBounce(const PathRay & pathRay, int maxDepth, BounceType type) const
+{
+    return pathRay.depth + 1 < maxDepth && pathRay.numberOfBounces[type] < this->maxBounceDepth[type];
+}
+
+float Scene::getLightSelectionProbability(const Light * light, const Position3 & position, const Vector3 & normal) const
+{
+    if(this->lightSampling == ALL_LIGHTS || this->lightSampler.isAlwaysSampled(light))
+        return 1.f;
+
+    // the others are chosen lightSamplesPerHit times
+    return this->lightSampler.getProbability(light, position, normal) * this->lightSamplesPerHit;
+}
+
+Color Scene::getRayColor(const Ray & ray, int maxDepth, bool backfaceCulling, ShadowRayQueue * shadowRayQueue) const
+{
+    Color color = Color::Black();
+
+    // rays of the path waiting to be traced, a path continues with more than
+    // .. one ray at a dielectric or a mirror-like diffuse surface
+    std::vector<PathRay> pathRays;
+    pathRays.push_back(PathRay(ray, backfaceCulling));
+
+    while(!pathRays.empty())
+    {
+        PathRay pathRay = pathRays.back();
+        pathRays.pop_back();
+
+        color += shadePathRay(pathRay, maxDepth, pathRays, shadowRayQueue).intensify(pathRay.throughput);
+    }
 
     return color;
 }
 
-Color Scene::getRayColor(const Ray & ray, int recursionDepth, bool backfaceCulling, bool onlyOpaque) const
+bool Scene::intersectPathRay(const PathRay & pathRay, HitInfo & hitInfo) const
 {
-    if(recursionDepth == 0)
-        return Color::Black();
+    return compiledBVH.hit(pathRay.ray, hitInfo, pathRay.backfaceCulling, pathRay.onlyOpaque);
+}
 
+Color Scene::shadePathRay(const PathRay & pathRay, int maxDepth, std::vector<PathRay> & pathRays, ShadowRayQueue * shadowRayQueue) const
+{
     HitInfo hitInfo;
-    
-    if( BVH && BVH->hit(ray, hitInfo, backfaceCulling, onlyOpaque) )
+
+    bool isHit = intersectPathRay(pathRay, hitInfo);
+
+    return shadeHit(pathRay, isHit, hitInfo, maxDepth, pathRays, shadowRayQueue);
+}
+
+Color Scene::shadeHit(const PathRay & pathRay, bool isHit, HitInfo & hitInfo, int maxDepth, std::vector<PathRay> & pathRays, ShadowRayQueue * shadowRayQueue) const
+{
+    const Ray & ray = pathRay.ray;
+    bool backfaceCulling = pathRay.backfaceCulling;
+
+    if(isHit)
     {
         if(hitInfo.isLight)
+        {
+            // the light is sampled by the hit the ray is generated from as well
+            if(pathRay.isHemisphereSample && hitInfo.light)
+            {
+                HitInfo sampledHitInfo;
+                sampledHitInfo.hitPosition = pathRay.sampledPosition;
+                sampledHitInfo.normal = pathRay.sampledNormal;
+
+                float lightPdf = hitInfo.light->getPdf(sampledHitInfo, ray.getDirection(), hitInfo) *
+                    getLightSelectionProbability(hitInfo.light, pathRay.sampledPosition, pathRay.sampledNormal);
+
+                return hitInfo.lightColor.intensify(powerHeuristic(pathRay.pdf, lightPdf));
+            }
+
             return hitInfo.lightColor;
+        }
 
-        Material & material = hitInfo.material;
+        const Material & material = *hitInfo.material;
 
         bool shapeIsFacing = (hitInfo.normal ^ ray.getDirection()) < 0;
 
         Color color(0.0f, 0.0f, 0.0f);
 
+        // russian roulette: after russianRouletteDepth bounces, the path
+        // .. survives with a probability proportional to its throughput and
+        // .. the rays continuing it are divided by that probability
+        float survivalProbability = 1.f;
+
+        if(this->integrator != Integrator::DEFAULT && pathRay.depth >= this->russianRouletteDepth)
+        {
+            const Vector3 & throughput = pathRay.throughput;
+
+            survivalProbability = std::fmin(1.f,
+                std::fmax(throughput.getX(), std::fmax(throughput.getY(), throughput.getZ())));
+        }
+
+        bool survives = survivalProbability >= 1.f || getRandomBtw01() < survivalProbability;
+
         // ambient, diffuse, specular and reflection - if shape is facing
         if(!backfaceCulling || shapeIsFacing)
         {
@@ -201,92 +264,219 @@ Color Scene::getRayColor(const Ray & ray, int recursionDepth, bool backfaceCulli
             // ambient
             color += getAmbientColor(material, this->ambientLight);
 
+            // random factor of path tracing, i.e. how the hemisphere is sampled
+            RandomFactor randomFactor = this->integrator == Integrator::IMPORTANCE_PATHTRACING ?
+                RandomFactor::IMPORTANCE : RandomFactor::UNIFORM;
+
+            // probability of continuing the path from the hemisphere, with
+            // .. which the lights can also be found by the path tracing ray
+            float hemisphereSampleProbability =
+                this->integrator != Integrator::DEFAULT && shapeIsFacing && canBounce(pathRay, maxDepth, DIFFUSE_BOUNCE) ?
+                survivalProbability : 0.f;
+
+            bool weightLightSamples = this->multipleImportanceSampling && hemisphereSampleProbability > 0.f;
+
             // direct lighting - diffuse and specular
             if(shapeIsFacing)
             {
-                // traverse lights
-                for(int i = 0; i < this->lights.size(); i++)
+                // the lights are sampled first, their brdfs are evaluated together
+                // .. by the kernel of the material's brdf
+                thread_local static std::vector<IncidentLight> incidentLights;
+                thread_local static std::vector<float> selectionProbabilities;
+                thread_local static std::vector<Color> lightColors;
+
+                incidentLights.clear();
+                selectionProbabilities.clear();
+
+                // samples a light, which is chosen with selectionProbability
+                auto sampleLight = [&](const Light * light, float selectionProbability)
+                {
+                    incidentLights.push_back(light->sampleIncidentLight(*this, hitInfo, ray.getTimeCreated()));
+                    selectionProbabilities.push_back(selectionProbability);
+                };
+
+                // adds the light a sample brings, lightColor is the light it reflects
+                auto addLightSample = [&](IncidentLight & incidentLight, float selectionProbability, Color lightColor)
+                {
+                    // the light could be found by path tracing as well, unless it is a point-like light
+                    if(weightLightSamples && incidentLight.pdf > 0.f && !incidentLight.inShadow)
+                    {
+                        float hemispherePdf = hemisphereSampleProbability *
+                            hitInfo.normal.getPdfWithinHemisphere(incidentLight.hitToLightDirection, randomFactor);
+
+                        lightColor.intensify(powerHeuristic(selectionProbability * incidentLight.pdf, hemispherePdf));
+                    }
+
+                    lightColor.intensify(1 / selectionProbability);
+
+                    // the shadow ray is required only if the light brings any, it is
+                    // .. either traced now or queued with the light it brings
+                    if(lightColor.isBlack() || !incidentLight.hasShadowRay)
+                    {
+                        color += lightColor;
+                    }
+                    else if(shadowRayQueue)
+                    {
+                        shadowRayQueue->push(incidentLight, lightColor.intensify(pathRay.throughput));
+                    }
+                    else
+                    {
+                        Light::traceShadowRay(*this, incidentLight);
+
+                        if(!incidentLight.inShadow)
+                            color += lightColor;
+                    }
+                };
+
+                if(this->lightSampling == ALL_LIGHTS)
+                {
+                    // traverse lights
+                    for(int i = 0; i < this->lights.size(); i++)
+                        sampleLight(lights[i], 1.f);
+                }
+                else
                 {
-                    // get incident light
-                    IncidentLight incidentLight = lights[i]->getIncidentLight(*this, hitInfo, ray.getTimeCreated());
+                    const std::vector<const Light*> & unboundedLights = this->lightSampler.getUnboundedLights();
 
-                    color += hitInfo.material.getBRDF().computeReflectedLight(ray, hitInfo, incidentLight);
+                    for(int i = 0; i < (int)unboundedLights.size(); i++)
+                        sampleLight(unboundedLights[i], 1.f);
+
+                    // choose the others
+                    for(int i = 0; i < this->lightSamplesPerHit; i++)
+                    {
+                        LightSelection selection;
+
+                        if(this->lightSampler.sample(hitInfo.hitPosition, hitInfo.normal, getRandomBtw01(), selection))
+                            sampleLight(selection.light, selection.probability * this->lightSamplesPerHit);
+                    }
                 }
+
+                int numberOfSamples = incidentLights.size();
+
+                lightColors.resize(numberOfSamples);
+                material.getBRDF().computeReflectedLight(ray, hitInfo, incidentLights.data(), lightColors.data(), numberOfSamples);
+
+                for(int i = 0; i < numberOfSamples; i++)
+                    addLightSample(incidentLights[i], selectionProbabilities[i], lightColors[i]);
             }
 
             // indirect lighting - path tracing
-            if(this->integrator != Integrator::DEFAULT && shapeIsFacing)
+            if(hemisphereSampleProbability > 0.f && survives)
             {
-                // decide the random factor
-                RandomFactor randomFactor;
-                switch(this->integrator)
-                {
-                    case Integrator::UNIFORM_PATHTRACING:
-                        randomFactor = RandomFactor::UNIFORM;
-                        break;
-                    case Integrator::IMPORTANCE_PATHTRACING:
-                        randomFactor = RandomFactor::IMPORTANCE;
-                        break;
-                }
-
                 // generate random around normal
                 Vector3 w_i = hitInfo.normal.generateRandomVectorWithinHemisphere(randomFactor);
 
-                // create ray
-                Ray sampleRay = Ray(hitInfo.hitPosition, w_i).translateRayOrigin(getShadowRayEpsilon());
+                // p(w)
+                float p_w = hitInfo.normal.getPdfWithinHemisphere(w_i, randomFactor);
 
-                // get color of sampled ray
-                Color sampleColor = getRayColor(sampleRay, recursionDepth - 1, backfaceCulling, true);
-
-                if(!sampleColor.isBlack())
+                if(p_w > 0.f)
                 {
-                    // create incident light
+                    // create ray
+                    Ray sampleRay = Ray(hitInfo.hitPosition, w_i).translateRayOrigin(getShadowRayEpsilon());
+                    sampleRay.setTimeCreated(ray.getTimeCreated());
+
+                    // reflected portion of unit light arriving from w_i
                     IncidentLight incidentLight;
 
-                    incidentLight.intensity = sampleColor.getVector3();
+                    incidentLight.intensity = Vector3(1.f);
                     incidentLight.inShadow = false;
                     incidentLight.hitToLightDirection = w_i;
 
-                    // compute and add the color
-                    Color pathTracedColor = hitInfo.material.getBRDF().computeReflectedLight(sampleRay, hitInfo, incidentLight);
+                    Vector3 brdfCos = hitInfo.material->getBRDF().computeReflectedLight(ray, hitInfo, incidentLight).getVector3();
 
-                    // 1 / p(w)
-                    float _1_pw = 1.f;
-
-                    // divide by prop
-                    switch(this->integrator)
+                    if(!brdfCos.isZeroVector())
                     {
-                        case Integrator::UNIFORM_PATHTRACING:
-                            _1_pw = 1 / SPHERE_UNIFORM_SAMPLING_PROP;
-                            break;
-                        case Integrator::IMPORTANCE_PATHTRACING:
-                            _1_pw = 1 / SPHERE_UNIFORM_SAMPLING_PROP; // TODO
-                            break;
+                        PathRay sample = pathRay.bounce(sampleRay, brdfCos / (p_w * survivalProbability), DIFFUSE_BOUNCE, backfaceCulling);
+
+                        // lights are sampled directly, therefore, they are skipped by the sampled ray
+                        // .. unless multiple importance sampling weights the two
+                        if(this->multipleImportanceSampling)
+                        {
+                            sample.isHemisphereSample = true;
+                            sample.sampledPosition = hitInfo.hitPosition;
+                            sample.sampledNormal = hitInfo.normal;
+                            sample.pdf = p_w * survivalProbability;
+                        }
+                        else
+                        {
+                            sample.onlyOpaque = true;
+                        }
+
+                        pathRays.push_back(sample);
                     }
-
-                    color += pathTracedColor.intensify(_1_pw);
                 }
             }
-            
            
             // reflection
                 // check if it has mirrorish material 
-            if(!material.getMirror().isZeroVector())
+            if(!material.getMirror().isZeroVector() && survives && canBounce(pathRay, maxDepth, SPECULAR_BOUNCE))
             {
-                if(recursionDepth)
-                    color += getReflectionColor(ray, hitInfo, recursionDepth).intensify(material.getMirror());
+                Ray reflectionRay = ray.createReflectionRay(hitInfo);
+
+                pathRays.push_back(
+                    pathRay.bounce(reflectionRay, material.getMirror() / survivalProbability, SPECULAR_BOUNCE, true)
+                );
             }
         }
         
         // refraction
             // check if the material has refractive character
-        if(!material.getTransparency().isZeroVector())
+        if(!material.getTransparency().isZeroVector() && survives)
         {
-            if(recursionDepth)
+            DielectricSplit split = splitOnDielectric(ray, hitInfo);
+
+            if(this->stochasticFresnel)
+            {
+                // choose one of the rays for each split, weighted by the
+                // .. inverse of its probability
+                int numberOfSplits = pathRay.depth == 0 ? this->fresnelSplittingFactor : 1;
+
+                float reflectionProbability = split.reflectance;
+                float splitWeight = 1.f / (numberOfSplits * survivalProbability);
+
+                // all of the light is reflected under total internal
+                // .. reflection and at grazing angles, the refraction ray is
+                // .. not even created then
+                bool onlyReflects = reflectionProbability >= 1.f || split.refractionWeight.isZeroVector();
+
+                for(int i = 0; i < numberOfSplits; i++)
+                {
+                    if(onlyReflects || getRandomBtw01() < reflectionProbability)
+                    {
+                        if(canBounce(pathRay, maxDepth, SPECULAR_BOUNCE))
+                        {
+                            pathRays.push_back(
+                                pathRay.bounce(split.reflectionRay, split.reflectionWeight * (splitWeight / reflectionProbability), SPECULAR_BOUNCE, false)
+                            );
+                        }
+                    }
+                    else if(canBounce(pathRay, maxDepth, TRANSMISSION_BOUNCE))
+                    {
+                        pathRays.push_back(
+                            pathRay.bounce(split.refractionRay, split.refractionWeight * (splitWeight / (1 - reflectionProbability)), TRANSMISSION_BOUNCE, false)
+                        );
+                    }
+
+                    // glossy reflections are sampled again for each split
+                    if(i + 1 < numberOfSplits && material.getRoughness() != 0.f)
+                        split.reflectionRay = splitOnDielectric(ray, hitInfo).reflectionRay;
+                }
+            }
+            else
             {
-                Color refractionColor = this->getRefractionColor(ray, hitInfo, recursionDepth);
-                
-                color += refractionColor;
+                if(canBounce(pathRay, maxDepth, SPECULAR_BOUNCE))
+                {
+                    pathRays.push_back(
+                        pathRay.bounce(split.reflectionRay, split.reflectionWeight / survivalProbability, SPECULAR_BOUNCE, false)
+                    );
+                }
+
+                if(!split.refractionWeight.isZeroVector() && canBounce(pathRay, maxDepth, TRANSMISSION_BOUNCE))
+                {
+                    pathRays.push_back(
+                        pathRay.bounce(split.refractionRay, split.refractionWeight / survivalProbability, TRANSMISSION_BOUNCE, false)
+                    );
+                }
             }
         }
 
@@ -294,9 +484,29 @@ Color Scene::getRayColor(const Ray & ray, int recursionDepth, bool backfaceCulli
     }
     else
     {
+        // the environment is sampled directly as a light, therefore, it is
+        // .. skipped by the sampled ray unless multiple importance sampling
+        // .. weights the two
+        if(sphericalEnvLight && pathRay.onlyOpaque)
+            return Color(0.f, 0.f, 0.f);
+
         if(sphericalEnvLight)
         {
-            return sphericalEnvLight->getColor(ray.getDirection());
+            Color envColor = sphericalEnvLight->getColor(ray.getDirection());
+
+            // the environment is sampled by the hit the ray is generated from as well
+            if(pathRay.isHemisphereSample)
+            {
+                HitInfo sampledHitInfo;
+                sampledHitInfo.hitPosition = pathRay.sampledPosition;
+                sampledHitInfo.normal = pathRay.sampledNormal;
+
+                float lightPdf = sphericalEnvLight->getPdf(sampledHitInfo, ray.getDirection(), HitInfo());
+
+                envColor.intensify(powerHeuristic(pathRay.pdf, lightPdf));
+            }
+
+            return envColor;
         }
         else return this->backgroundColor;
     }
@@ -0,0 +1,208 @@
+#include "../config.h"
+#include "../scene.hpp"
+#include "../geometry/headers/geometry.hpp"
+#include "../image/image.hpp"
+#include "../image/color.hpp"
+#include "../utility/random_number_generator.hpp"
+#include "../utility/render_checkpoint.hpp"
+#include <vector>
+
+#ifndef __CONCURRENT_BAG_TASK_DIST__
+
+// Wavefront path tracing
+//
+// Rather than tracing the path of a camera ray to its end before the next one,
+// .. the paths of a batch of pixels advance together, a bounce at a time:
+//  - intersect: the rays are intersected in the order of their origins and
+// ..   directions (see RaySorter), so that the consecutive rays traverse the
+// ..   same nodes of the bounding volume hiearchy
+//  - shade: the hits are shaded in the order of their materials, the rays
+// ..   continuing the paths make the next wavefront
+//  - shadow: the shadow rays of the light samples are traced together
+// The light a path brings is the same as in the depth first order, only the
+// .. order of the random numbers differs.
+
+// the misses first, then the lights, then the hits by their brdf, whether they
+// .. are transparent and whether they are mirrors
+static uint32_t getShadingKey(bool isHit, const HitInfo & hitInfo)
+{
+    if(!isHit)
+        return 0;
+
+    if(hitInfo.isLight)
+        return 1;
+
+    const Material & material = *hitInfo.material;
+
+    return 2 + material.getBRDF().getMode() * 4 +
+        (material.getTransparency().isZeroVector() ? 0 : 2) +
+        (material.getMirror().isZeroVector() ? 0 : 1);
+}
+
+void Scene::traceWavefront(int maxDepth, std::vector<Color> & colors, WavefrontBuffers & buffers) const
+{
+    Wavefront & current = buffers.current;
+    Wavefront & next = buffers.next;
+
+    RaySorter & raySorter = buffers.raySorter;
+    ShadowRayQueue & shadowRayQueue = buffers.shadowRayQueue;
+
+    while(current.getSize() > 0)
+    {
+        int size = current.getSize();
+
+        //
+        // intersect
+        //
+        Position3 minPosition = current.pathRays[0].ray.getOrigin();
+        Position3 maxPosition = minPosition;
+
+        for(int i = 1; i < size; i++)
+        {
+            minPosition = Position3::generateMinPosition(minPosition, current.pathRays[i].ray.getOrigin());
+            maxPosition = Position3::generateMaxPosition(maxPosition, current.pathRays[i].ray.getOrigin());
+        }
+
+        raySorter.setBounds(minPosition, maxPosition);
+        raySorter.resize(size);
+
+        for(int i = 0; i < size; i++)
+            raySorter.setRayKey(i, current.pathRays[i].ray);
+
+        current.hitInfos.resize(size);
+        current.isHit.resize(size);
+
+        {
+            const std::vector<int> & order = raySorter.sort();
+
+            for(int i = 0; i < size; i++)
+            {
+                int path = order[i];
+
+                current.hitInfos[path] = HitInfo();
+                current.isHit[path] = intersectPathRay(current.pathRays[path], current.hitInfos[path]);
+            }
+        }
+
+        //
+        // shade
+        //
+        for(int i = 0; i < size; i++)
+            raySorter.setKey(i, getShadingKey(current.isHit[i], current.hitInfos[i]));
+
+        {
+            const std::vector<int> & order = raySorter.sort(8);
+
+            for(int i = 0; i < size; i++)
+            {
+                int path = order[i];
+
+                const PathRay & pathRay = current.pathRays[path];
+                int target = current.targets[path];
+                float weight = current.weights[path];
+
+                shadowRayQueue.setTarget(target, weight);
+
+                buffers.continuingRays.clear();
+
+                Color color = shadeHit(pathRay, current.isHit[path], current.hitInfos[path], maxDepth, buffers.continuingRays, &shadowRayQueue);
+
+                colors[target] += color.intensify(pathRay.throughput).intensify(weight);
+
+                for(int j = 0; j < (int)buffers.continuingRays.size(); j++)
+                    next.push(buffers.continuingRays[j], target, weight);
+            }
+        }
+
+        //
+        // shadow
+        //
+        shadowRayQueue.trace(compiledBVH, colors);
+
+        std::swap(current.pathRays, next.pathRays);
+        std::swap(current.targets, next.targets);
+        std::swap(current.weights, next.weights);
+
+        next.clear();
+    }
+}
+
+void Scene::wavefrontImageFiller(Camera * camera, Image * image, Scene * scene, PixelMissionGenerator * pixelMissionGenerator, RenderCheckpoint * checkpoint)
+{
+    if(camera != NULL && image != NULL && scene != NULL && pixelMissionGenerator != NULL)
+    {
+        std::vector<Vec2i> pixelsToFill;
+
+        WavefrontBuffers buffers;
+
+        std::vector<Color> colors;
+        std::vector<float> sumsOfWeights;
+        std::vector<int> numbersOfSamples;
+
+        // backfaceCulling is applied to primary rays if defined
+        bool backfaceCulling = false;
+        #ifdef BACKFACE_CULLING
+        backfaceCulling = true;
+        #endif
+
+        while(pixelMissionGenerator->getBlockToFill(pixelsToFill, WAVEFRONT_BATCH_SIZE))
+        {
+            int numberOfPixels = pixelsToFill.size();
+
+            // the paths of the batch share the random numbers. a batch is a
+            // .. fixed block of pixels, traced whole even if some of its pixels
+            // .. are restored from the checkpoint, so that it is reproducible
+            if(checkpoint)
+                seedRandomNumberGenerator(checkpoint->getPixelSeed(pixelsToFill[0].x, pixelsToFill[0].y));
+
+            colors.assign(numberOfPixels, Color::Black());
+            sumsOfWeights.assign(numberOfPixels, 0.f);
+            numbersOfSamples.assign(numberOfPixels, 0);
+
+            //
+            // generate
+            //
+            buffers.current.clear();
+
+            for(int i = 0; i < numberOfPixels; i++)
+            {
+                const std::vector<Ray> raysToSample = camera->getRays(pixelsToFill[i].x, pixelsToFill[i].y);
+
+                for(int j = 0; j < (int)raysToSample.size(); j++)
+                {
+                    float rayWeight = raysToSample[j].getWeight();
+
+                    buffers.current.push(PathRay(raysToSample[j], backfaceCulling), i, rayWeight);
+
+                    sumsOfWeights[i] += rayWeight;
+                }
+
+                numbersOfSamples[i] = raysToSample.size();
+            }
+
+            scene->traceWavefront(scene->maxRecursionDepth, colors, buffers);
+
+            for(int i = 0; i < numberOfPixels; i++)
+            {
+                Color rayColor = colors[i];
+
+                // record accumulated samples before normalizing, the restored
+                // .. pixels are traced again to the same colors
+                if(checkpoint && !checkpoint->isPixelCompleted(pixelsToFill[i].x, pixelsToFill[i].y))
+                    checkpoint->recordPixel(pixelsToFill[i].x, pixelsToFill[i].y, rayColor, sumsOfWeights[i], numbersOfSamples[i]);
+
+                // normalize color
+                rayColor = rayColor / sumsOfWeights[i];
+
+                // set color
+                image->setColor(pixelsToFill[i].x, pixelsToFill[i].y, rayColor);
+            }
+        }
+    }
+    else
+    {
+        throw "Scene::wavefrontImageFiller(): NULL object!";
+    }
+}
+
+#endif
@@ -0,0 +1,140 @@
+// Accuracy of the approximations of shading_math.hpp against the standard
+// .. functions, over the ranges and within the bounds documented there.
+// Built and run by "make test-shading-math", fails unless all of them are
+// .. within their bounds.
+
+#define __FAST_SHADING_MATH__
+#include "../utility/shading_math.hpp"
+
+#include <cstdio>
+#include <cmath>
+#include <random>
+#include <string>
+
+static const int NUMBER_OF_SAMPLES = 1000000;
+
+// the largest error of a function, and the argument it is at
+struct Accuracy
+{
+    std::string name;
+    double bound;
+    double maxError = 0.0;
+    double worstArgument = 0.0;
+
+    Accuracy(const std::string& name, double bound) : name(name), bound(bound) { }
+
+    void add(double error, double argument)
+    {
+        // nan is an error beyond any bound
+        if(!(error <= maxError))
+        {
+            maxError = error;
+            worstArgument = argument;
+        }
+    }
+
+    bool report() const
+    {
+        bool isPassed = maxError <= bound;
+
+        std::printf("%-32s max error %.3g (at %.9g), bound %.3g: %s\n",
+            name.c_str(), maxError, worstArgument, bound, isPassed ? "passed" : "FAILED");
+
+        return isPassed;
+    }
+};
+
+static double relativeError(double value, double reference)
+{
+    return std::fabs(value - reference) / std::fabs(reference);
+}
+
+int main()
+{
+    std::mt19937 engine(1);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    Accuracy log2Accuracy("fastLog2, relative", 1e-6);
+    Accuracy exp2Accuracy("fastExp2 [-126, 127], relative", 1e-6);
+    Accuracy sinAccuracy("fastSinCos sin [-4pi, 4pi]", 1e-6);
+    Accuracy cosAccuracy("fastSinCos cos [-4pi, 4pi]", 1e-6);
+    Accuracy powAccuracy("shadingPow [0, 200], relative", 2e-5);
+    Accuracy integerPowAccuracy("shadingPow integers, relative", 2e-5);
+    Accuracy expAccuracy("shadingExp [-80, 80], relative", 1e-5);
+
+    for(int i = 0; i < NUMBER_OF_SAMPLES; i++)
+    {
+        // the positive normal floats, relative to the magnitude of the log
+        // .. since log2 is 0 at 1
+        float x = (float)std::exp2(uniform(engine) * 252.0 - 126.0);
+        double log2x = std::log2((double)x);
+        log2Accuracy.add(std::fabs(fastLog2(x) - log2x) / std::fmax(1.0, std::fabs(log2x)), x);
+
+        float y = (float)(uniform(engine) * 253.0 - 126.0);
+        exp2Accuracy.add(relativeError(fastExp2(y), std::exp2((double)y)), y);
+
+        float angle = (float)((uniform(engine) * 8.0 - 4.0) * M_PI);
+        float sine, cosine;
+        fastSinCos(angle, sine, cosine);
+        sinAccuracy.add(std::fabs(sine - std::sin((double)angle)), angle);
+        cosAccuracy.add(std::fabs(cosine - std::cos((double)angle)), angle);
+
+        // the bases of the shading, e.g. the cosines of the phong lobes.
+        // .. the results below the smallest normal float are not compared,
+        // .. they are flushed to 0 rather than rounded
+        float base = (float)uniform(engine);
+        float exponent = (float)(uniform(engine) * 200.0);
+        double power = std::pow((double)base, (double)exponent);
+
+        if(power > 1e-30)
+            powAccuracy.add(relativeError(shadingPow(base, exponent), power), exponent);
+
+        float signedBase = (float)(uniform(engine) * 2.0 - 1.0);
+        float integerExponent = (float)(int)(uniform(engine) * 201.0);
+        double integerPower = std::pow((double)signedBase, (double)integerExponent);
+
+        if(std::fabs(integerPower) > 1e-30)
+            integerPowAccuracy.add(relativeError(shadingPow(signedBase, integerExponent), integerPower), integerExponent);
+
+        float z = (float)(uniform(engine) * 160.0 - 80.0);
+        expAccuracy.add(relativeError(shadingExp(z), std::exp((double)z)), z);
+    }
+
+    // the exact arguments
+    for(int e = -126; e <= 127; e++)
+    {
+        log2Accuracy.add(std::fabs(fastLog2(std::ldexp(1.f, e)) - e) / std::fmax(1.0, std::abs(e)), std::ldexp(1.0, e));
+        exp2Accuracy.add(relativeError(fastExp2((float)e), std::ldexp(1.0, e)), e);
+    }
+
+    for(int k = -16; k <= 16; k++)
+    {
+        float angle = (float)(k * M_PI / 4.0);
+        float sine, cosine;
+        fastSinCos(angle, sine, cosine);
+        sinAccuracy.add(std::fabs(sine - std::sin((double)angle)), angle);
+        cosAccuracy.add(std::fabs(cosine - std::cos((double)angle)), angle);
+    }
+
+    // the edge cases, of no error
+    Accuracy edgeCases("shadingPow edge cases", 0.0);
+    edgeCases.add(shadingPow(0.f, 2.5f) == 0.f ? 0.0 : 1.0, 2.5);
+    edgeCases.add(shadingPow(0.3f, 0.f) == 1.f ? 0.0 : 1.0, 0.0);
+    edgeCases.add(shadingPow(-2.f, 3.f) == -8.f ? 0.0 : 1.0, 3.0);
+    edgeCases.add(std::isnan(shadingPow(-2.f, 2.5f)) ? 0.0 : 1.0, 2.5);
+
+    bool isPassed = true;
+
+    isPassed = log2Accuracy.report() && isPassed;
+    isPassed = exp2Accuracy.report() && isPassed;
+    isPassed = sinAccuracy.report() && isPassed;
+    isPassed = cosAccuracy.report() && isPassed;
+    isPassed = powAccuracy.report() && isPassed;
+    isPassed = integerPowAccuracy.report() && isPassed;
+    isPassed = expAccuracy.report() && isPassed;
+    isPassed = edgeCases.report() && isPassed;
+
+    std::printf(isPassed ? "All shading math approximations are within their bounds.\n" : "Some shading math approximations are beyond their bounds.\n");
+
+    return isPassed ? 0 : 1;
+}
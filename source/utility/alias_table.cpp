@@ -0,0 +1,90 @@
+#include "alias_table.hpp"
+
+AliasTable::AliasTable(const std::vector<float>& weights)
+{
+    int size = weights.size();
+
+    double sumOfWeights = 0.0;
+    for(int i = 0; i < size; i++)
+        sumOfWeights += weights[i];
+
+    if(size == 0 || sumOfWeights <= 0.0)
+        return;
+
+    pdfs.resize(size);
+    probabilities.resize(size);
+    aliases.resize(size);
+
+    // scale the weights so that their average is 1, then pair the bins
+    // .. below the average with the ones above it
+    std::vector<double> scaled(size);
+    std::vector<int> small, large;
+
+    for(int i = 0; i < size; i++)
+    {
+        pdfs[i] = weights[i] / sumOfWeights;
+        scaled[i] = pdfs[i] * size;
+
+        if(scaled[i] < 1.0)
+            small.push_back(i);
+        else
+            large.push_back(i);
+    }
+
+    while(!small.empty() && !large.empty())
+    {
+        int s = small.back();
+        small.pop_back();
+
+        int l = large.back();
+
+        probabilities[s] = scaled[s];
+        aliases[s] = l;
+
+        // the large bin fills the rest of the small one
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+
+        if(scaled[l] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // the remaining ones are full, up to the rounding errors
+    for(int i = 0; i < (int)large.size(); i++)
+    {
+        probabilities[large[i]] = 1.f;
+        aliases[large[i]] = large[i];
+    }
+
+    // .. unless they have no weight, which should never be sampled
+    int heaviest = 0;
+    for(int i = 1; i < size; i++)
+    {
+        if(weights[i] > weights[heaviest])
+            heaviest = i;
+    }
+
+    for(int i = 0; i < (int)small.size(); i++)
+    {
+        probabilities[small[i]] = weights[small[i]] > 0.f ? 1.f : 0.f;
+        aliases[small[i]] = weights[small[i]] > 0.f ? small[i] : heaviest;
+    }
+}
+
+int AliasTable::sample(float u) const
+{
+    int size = pdfs.size();
+
+    // the integer part selects the bin, the fraction decides on the alias
+    float scaledU = u * size;
+    int bin = (int)scaledU;
+
+    if(bin >= size)
+        bin = size - 1;
+
+    float remainder = scaledU - bin;
+
+    return remainder < probabilities[bin] ? bin : aliases[bin];
+}
@@ -0,0 +1,34 @@
+#ifndef __ALIAS_TABLE_H__
+#define __ALIAS_TABLE_H__
+
+#include <vector>
+
+// samples an index with probability proportional to its weight in constant
+// .. time (Walker's alias method, built with Vose's algorithm)
+class AliasTable
+{
+    private:
+        // each bin holds its own index with the probability, its alias otherwise
+        std::vector<float> probabilities;
+        std::vector<int> aliases;
+
+        // normalized weights, i.e. the probability of sampling each index
+        std::vector<float> pdfs;
+
+    public:
+        AliasTable() { }
+
+        // weights should be non-negative, the table is empty if they sum to 0
+        AliasTable(const std::vector<float>& weights);
+
+        bool isEmpty() const { return pdfs.empty(); }
+        int getSize() const { return pdfs.size(); }
+
+        // samples an index, u is uniform in [0, 1)
+        int sample(float u) const;
+
+        // probability of sampling the index
+        float getPdf(int index) const { return pdfs[index]; }
+};
+
+#endif
@@ -1,91 +1,87 @@
 #include "binf_parser.hpp"
+#include "mapped_file.hpp"
 #include "../geometry/headers/structs.hpp"
 #include "../geometry/headers/vertex.hpp"
 #include "../geometry/headers/position3.hpp"
-#include <fstream>
-#include <iostream>
 #include <vector>
 #include <string>
-
-std::vector<Vec3i> parseMeshFaces(std::string binaryFilePath)
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+// A binary file is the number of elements (int) followed by the elements, e.g.
+// .. x, y, z (float) of each vertex. It is mapped to the memory and the
+// .. elements are read in place into the final buffer, rather than read one
+// .. value at a time through a stream.
+
+// maps the file and checks that its size is of the number of elements it
+// .. declares, returns the number of elements
+static int mapBinaryFile(const std::string& binaryFilePath, size_t elementSize, MappedFile& mappedFile)
 {
-    std::vector<Vec3i> faces;
-
-    // create stream from file
-    std::ifstream stream (binaryFilePath.data(), std::ifstream::binary);
+    if(!mappedFile.open(binaryFilePath))
+        throw std::runtime_error("Error: Binary file " + binaryFilePath + " cannot be opened.");
 
-    // read number of vertices
-    int numberOfData = 0;
-    stream.read(reinterpret_cast<char*>(&numberOfData), sizeof(int));
-
-    int x, y, z;
-    for(int i = 0; i < numberOfData; i++)
-    {
-        // read
-		stream.read(reinterpret_cast<char*>(&x), sizeof(int)); // x
-		stream.read(reinterpret_cast<char*>(&y), sizeof(int)); // y
-        stream.read(reinterpret_cast<char*>(&z), sizeof(int)); // z
+    int32_t numberOfElements = -1;
 
-        // push
-        faces.push_back(Vec3i(x, y, z));
-    }
+    if(mappedFile.getSize() >= sizeof(int32_t))
+        std::memcpy(&numberOfElements, mappedFile.getData(), sizeof(int32_t));
 
-    stream.close();
+    if(numberOfElements < 0 ||
+       mappedFile.getSize() != sizeof(int32_t) + (size_t)numberOfElements * elementSize)
+        throw std::runtime_error("Error: Size of the binary file " + binaryFilePath + " does not match its number of elements.");
 
-    return faces;
+    return numberOfElements;
 }
 
-std::vector<Vec2f> parseTexCoordData(std::string binaryFilePath)
+// the elements of a file whose layout is the one of T
+template<class T>
+static std::vector<T> parseBinaryArray(const std::string& binaryFilePath)
 {
-    std::vector<Vec2f> texCoordData;
+    static_assert(std::is_trivially_copyable<T>::value, "elements are copied as bytes");
 
-    // create stream from file
-    std::ifstream stream (binaryFilePath.data(), std::ifstream::binary);
+    MappedFile mappedFile;
+    int numberOfElements = mapBinaryFile(binaryFilePath, sizeof(T), mappedFile);
 
-    // read number of vertices
-    int numberOfData = 0;
-    stream.read(reinterpret_cast<char*>(&numberOfData), sizeof(int));
+    std::vector<T> elements(numberOfElements);
+    std::memcpy(elements.data(), mappedFile.getData() + sizeof(int32_t), numberOfElements * sizeof(T));
 
-    float u, v;
-    for(int i = 0; i < numberOfData; i++)
-    {
-        // read
-		stream.read(reinterpret_cast<char*>(&u), sizeof(float)); // u
-		stream.read(reinterpret_cast<char*>(&v), sizeof(float)); // v
+    return elements;
+}
 
-        // push
-        texCoordData.push_back(Vec2f(u, v));
-    }
+std::vector<Vec3i> parseMeshFaces(std::string binaryFilePath)
+{
+    static_assert(sizeof(Vec3i) == 3 * sizeof(int32_t), "a face is three indices");
 
-    stream.close();
+    return parseBinaryArray<Vec3i>(binaryFilePath);
+}
 
-    return texCoordData;
+std::vector<Vec2f> parseTexCoordData(std::string binaryFilePath)
+{
+    static_assert(sizeof(Vec2f) == 2 * sizeof(float), "a texture coordinate is u, v");
+
+    return parseBinaryArray<Vec2f>(binaryFilePath);
 }
 
 std::vector<Vertex> parseVertexData(std::string binaryFilePath)
 {
-    std::vector<Vertex> vertexData;
+    // a vertex has a normal as well, therefore the positions are not copied
+    // .. as they are
+    MappedFile mappedFile;
+    int numberOfVertices = mapBinaryFile(binaryFilePath, 3 * sizeof(float), mappedFile);
 
-    // create stream from file
-    std::ifstream stream (binaryFilePath.data(), std::ifstream::binary);
+    const char* data = mappedFile.getData() + sizeof(int32_t);
 
-    // read number of vertices
-    int numberOfVertices = 0;
-    stream.read(reinterpret_cast<char*>(&numberOfVertices), sizeof(int));
+    std::vector<Vertex> vertexData;
+    vertexData.reserve(numberOfVertices);
 
-    float x, y, z;
     for(int i = 0; i < numberOfVertices; i++)
     {
-        // read
-		stream.read(reinterpret_cast<char*>(&x), sizeof(float)); // x
-		stream.read(reinterpret_cast<char*>(&y), sizeof(float)); // y
-		stream.read(reinterpret_cast<char*>(&z), sizeof(float)); // z
+        float xyz[3];
+        std::memcpy(xyz, data + i * sizeof(xyz), sizeof(xyz));
 
-        // push
-        vertexData.push_back(Position3(x, y, z));
+        vertexData.push_back(Vertex(xyz[0], xyz[1], xyz[2]));
     }
 
-    stream.close();
-
     return vertexData;
 }
@@ -0,0 +1,86 @@
+#ifndef __HALF_FLOAT_H__
+#define __HALF_FLOAT_H__
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+// IEEE 754 half precision floats, e.g. the texels of the textures that are
+// .. not of 8 bits, see TextureCache. a float is rounded to the nearest half,
+// .. and the ones beyond the largest half, 65504, are clamped to it rather
+// .. than rounded to infinity
+
+inline uint16_t floatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint16_t sign = (bits >> 16) & 0x8000;
+    uint32_t magnitude = bits & 0x7FFFFFFF;
+
+    // nan
+    if(magnitude > 0x7F800000)
+        return sign | 0x7E00;
+
+    // 65504 and beyond, infinity as well
+    if(magnitude >= 0x477FE000)
+        return sign | 0x7BFF;
+
+    // normal halves, the exponent is biased by 15 rather than 127
+    if(magnitude >= 0x38800000)
+    {
+        uint32_t half = (magnitude - 0x38000000) >> 13;
+        uint32_t rest = magnitude & 0x1FFF;
+
+        // to the nearest, ties to even
+        if(rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+            half++;
+
+        return sign | half;
+    }
+
+    // below half of the smallest subnormal half
+    if(magnitude < 0x33000000)
+        return sign;
+
+    // subnormal halves, in units of 2^-24
+    uint32_t mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+    int shift = 126 - (int)(magnitude >> 23);
+
+    uint32_t half = mantissa >> shift;
+    uint32_t rest = mantissa & ((1u << shift) - 1);
+    uint32_t tie = 1u << (shift - 1);
+
+    if(rest > tie || (rest == tie && (half & 1)))
+        half++;
+
+    return sign | half;
+}
+
+inline float halfToFloat(uint16_t half)
+{
+    uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FF;
+
+    // zero and the subnormals
+    if(exponent == 0)
+    {
+        float value = std::ldexp((float)mantissa, -24);
+        return sign ? -value : value;
+    }
+
+    uint32_t bits;
+
+    if(exponent == 31)
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    else
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+
+    return value;
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef __IMAGE_REGION_H__
+#define __IMAGE_REGION_H__
+
+#include <vector>
+#include <algorithm>
+
+// axis aligned rectangle of pixels, [x0, x1) x [y0, y1)
+struct ImageRegion
+{
+    int x0, y0, x1, y1;
+
+    ImageRegion() : x0(0), y0(0), x1(0), y1(0) { }
+    ImageRegion(int x0, int y0, int x1, int y1) : x0(x0), y0(y0), x1(x1), y1(y1) { }
+
+    int getWidth() const { return x1 - x0; }
+    int getHeight() const { return y1 - y0; }
+    int getArea() const { return isEmpty() ? 0 : getWidth() * getHeight(); }
+    bool isEmpty() const { return x1 <= x0 || y1 <= y0; }
+
+    bool contains(int x, int y) const { return x >= x0 && x < x1 && y >= y0 && y < y1; }
+
+    ImageRegion intersect(const ImageRegion& rhs) const
+    {
+        return ImageRegion(
+            std::max(x0, rhs.x0), std::max(y0, rhs.y0),
+            std::min(x1, rhs.x1), std::min(y1, rhs.y1)
+        );
+    }
+
+    // smallest region enclosing all of the given regions
+    static ImageRegion getBounds(const std::vector<ImageRegion>& regions)
+    {
+        if(regions.empty())
+            return ImageRegion();
+
+        ImageRegion bounds = regions[0];
+
+        for(int i = 1; i < (int)regions.size(); i++)
+        {
+            bounds.x0 = std::min(bounds.x0, regions[i].x0);
+            bounds.y0 = std::min(bounds.y0, regions[i].y0);
+            bounds.x1 = std::max(bounds.x1, regions[i].x1);
+            bounds.y1 = std::max(bounds.y1, regions[i].y1);
+        }
+
+        return bounds;
+    }
+
+    // number of tiles of size tileSize x tileSize covering the image
+    static int getNumberOfTiles(int imageWidth, int imageHeight, int tileSize)
+    {
+        int tilesX = (imageWidth + tileSize - 1) / tileSize;
+        int tilesY = (imageHeight + tileSize - 1) / tileSize;
+
+        return tilesX * tilesY;
+    }
+
+    // tile with the given index, tiles are indexed row by row
+    // .. tiles at the right and bottom borders are clipped by the image
+    static ImageRegion getTile(int imageWidth, int imageHeight, int tileSize, int tileIndex)
+    {
+        int tilesX = (imageWidth + tileSize - 1) / tileSize;
+
+        int x0 = (tileIndex % tilesX) * tileSize;
+        int y0 = (tileIndex / tilesX) * tileSize;
+
+        return ImageRegion(x0, y0, x0 + tileSize, y0 + tileSize)
+            .intersect(ImageRegion(0, 0, imageWidth, imageHeight));
+    }
+};
+
+#endif
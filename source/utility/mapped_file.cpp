@@ -0,0 +1,65 @@
+#include "mapped_file.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cstdint>
+
+bool MappedFile::open(const std::string& filePath, Access access)
+{
+    close();
+
+    int fd = ::open(filePath.data(), O_RDONLY);
+
+    if(fd < 0)
+        return false;
+
+    struct stat fileStat;
+
+    if(fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // the mapping stays valid after the file is closed
+    ::close(fd);
+
+    if(mapping == MAP_FAILED)
+        return false;
+
+    // the pages behind a sequential reader are dropped and the ones ahead of it
+    // .. are read early. the parts read in any order are left to the default
+    // .. read ahead, which suits a part read sequentially itself, unlike
+    // .. MADV_RANDOM that reads each of its pages on its own
+    if(access == SEQUENTIAL)
+        madvise(mapping, fileStat.st_size, MADV_SEQUENTIAL);
+
+    data = static_cast<const char*>(mapping);
+    size = fileStat.st_size;
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if(data)
+        munmap(const_cast<char*>(data), size);
+
+    data = nullptr;
+    size = 0;
+}
+
+void MappedFile::release(const char* begin, size_t size) const
+{
+    // only the pages entirely within the part, the others may be read for
+    // .. the parts next to it
+    uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+    uintptr_t first = ((uintptr_t)begin + pageSize - 1) / pageSize * pageSize;
+    uintptr_t last = ((uintptr_t)begin + size) / pageSize * pageSize;
+
+    if(first < last)
+        madvise(reinterpret_cast<void*>(first), last - first, MADV_DONTNEED);
+}
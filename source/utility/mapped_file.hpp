@@ -0,0 +1,47 @@
+#ifndef __MAPPED_FILE_H__
+#define __MAPPED_FILE_H__
+
+#include <string>
+#include <cstddef>
+
+// a file mapped to the memory as read-only, which is read in place rather
+// .. than copied through a stream. the mapping is released when it is closed
+// .. or destructed
+class MappedFile
+{
+    private:
+        const char* data = nullptr;
+        size_t size = 0;
+
+    public:
+        // how the file is read, by which the system reads its pages ahead
+        enum Access
+        {
+            // from the beginning to the end once, e.g. a mesh file
+            SEQUENTIAL,
+            // parts of it, each from its beginning to its end, in any order,
+            // .. e.g. the meshes of the scene cache loaded out of core
+            ANY_ORDER
+        };
+
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile() { close(); }
+
+        // returns false if the file cannot be opened or mapped
+        bool open(const std::string& filePath, Access access = SEQUENTIAL);
+        void close();
+
+        bool isOpen() const { return this->data != nullptr; }
+
+        // drops the pages within the part from the memory of the process, e.g.
+        // .. of a mesh that is evicted. they are read from the file again if
+        // .. the part is read again
+        void release(const char* begin, size_t size) const;
+
+        const char* getData() const { return this->data; }
+        size_t getSize() const { return this->size; }
+};
+
+#endif
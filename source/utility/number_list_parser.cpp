@@ -0,0 +1,138 @@
+#include "number_list_parser.hpp"
+#include "number_parser.hpp"
+#include "run_in_parallel.hpp"
+
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <algorithm>
+
+// the texts smaller than this are parsed by one thread
+#define NUMBER_LIST_MIN_CHUNK_SIZE (1 << 20)
+
+struct NumberListChunk
+{
+    const char* begin;
+    const char* end;
+    size_t firstNumber;
+};
+
+// splits the text into chunks at the whitespace and counts their numbers
+static std::vector<NumberListChunk> splitNumberList(const char* begin, const char* end, size_t& numberOfNumbers)
+{
+    int maxNumberOfChunks = std::max(1u, std::thread::hardware_concurrency());
+
+    // fewer chunks for a small text, since starting a thread is not free
+    int numberOfChunks = std::min<int64_t>(maxNumberOfChunks, (end - begin) / NUMBER_LIST_MIN_CHUNK_SIZE + 1);
+
+    std::vector<NumberListChunk> chunks(numberOfChunks);
+    const char* p = begin;
+
+    for(int i = 0; i < numberOfChunks; i++)
+    {
+        chunks[i].begin = p;
+
+        // the chunk ends after the token its share of the text ends in
+        p = std::max(p, begin + (end - begin) * (i + 1) / numberOfChunks);
+
+        while(p < end && !isNumberSpace(*p))
+            p++;
+
+        chunks[i].end = p;
+    }
+
+    std::vector<size_t> numbersOfChunks(numberOfChunks, 0);
+
+    runInParallel(numberOfChunks, [&](int i)
+    {
+        const char* q = chunks[i].begin;
+
+        while(true)
+        {
+            skipNumberSpaces(q, chunks[i].end);
+
+            if(q == chunks[i].end)
+                break;
+
+            skipToken(q, chunks[i].end);
+            numbersOfChunks[i]++;
+        }
+    });
+
+    numberOfNumbers = 0;
+
+    for(int i = 0; i < numberOfChunks; i++)
+    {
+        chunks[i].firstNumber = numberOfNumbers;
+        numberOfNumbers += numbersOfChunks[i];
+    }
+
+    return chunks;
+}
+
+template<class T, class NumberParser>
+static std::vector<T> parseNumberList(const char* text, const std::string& description, const NumberParser& parseNumber)
+{
+    std::vector<T> numbers;
+
+    if(!text)
+        return numbers;
+
+    const char* end = text + std::strlen(text);
+
+    size_t numberOfNumbers;
+    std::vector<NumberListChunk> chunks = splitNumberList(text, end, numberOfNumbers);
+
+    numbers.resize(numberOfNumbers);
+
+    runInParallel(chunks.size(), [&](int i)
+    {
+        const char* p = chunks[i].begin;
+        size_t index = chunks[i].firstNumber;
+
+        while(true)
+        {
+            skipNumberSpaces(p, chunks[i].end);
+
+            if(p == chunks[i].end)
+                break;
+
+            const char* token = p;
+
+            // the number is to be the whole token
+            if(!parseNumber(p, chunks[i].end, numbers[index++]) || (p < chunks[i].end && !isNumberSpace(*p)))
+            {
+                const char* tokenEnd = token;
+                skipToken(tokenEnd, chunks[i].end);
+
+                throw std::runtime_error("Error: " + description + " has a token that is not a number: " + std::string(token, tokenEnd) + ".");
+            }
+        }
+    });
+
+    return numbers;
+}
+
+std::vector<float> parseRealList(const char* text, const std::string& description)
+{
+    return parseNumberList<float>(text, description, [](const char*& p, const char* end, float& value)
+    {
+        return parseReal(p, end, value);
+    });
+}
+
+std::vector<int> parseIntegerList(const char* text, const std::string& description)
+{
+    return parseNumberList<int>(text, description, [](const char*& p, const char* end, int& value)
+    {
+        int64_t integer;
+
+        if(!parseInteger(p, end, integer) || integer < INT32_MIN || integer > INT32_MAX)
+            return false;
+
+        value = (int)integer;
+
+        return true;
+    });
+}
@@ -0,0 +1,19 @@
+#ifndef __NUMBER_LIST_PARSER_H__
+#define __NUMBER_LIST_PARSER_H__
+
+#include <vector>
+#include <string>
+
+// Parsing the whitespace separated numbers of a text in place, e.g. the data
+// .. written inline in the scene file. A large text is split into chunks at
+// .. the whitespace, the numbers of each are counted and then parsed into
+// .. their places in the list, by a thread per chunk.
+//
+// A token that is not a number throws, the error names the text by its
+// .. description. A null text is an empty list.
+
+std::vector<float> parseRealList(const char* text, const std::string& description);
+
+std::vector<int> parseIntegerList(const char* text, const std::string& description);
+
+#endif
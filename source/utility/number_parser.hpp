@@ -0,0 +1,226 @@
+#ifndef __NUMBER_PARSER_H__
+#define __NUMBER_PARSER_H__
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+#include <string>
+
+// Parsing the numbers of a text in place, e.g. of a mapped file, which is not
+// .. null terminated. A number is parsed from p up to end, skipping the
+// .. whitespace before it, and p is advanced to the character following it.
+//
+// A real number of at most 19 significant digits and a power of ten up to 22
+// .. is the quotient or the product of two doubles that are exact, which is
+// .. the correctly rounded value. The rest, e.g. the ones with more digits,
+// .. hexadecimal floats, inf or nan, are parsed by strtod. The same holds for
+// .. a float of at most 24 bits and a power of ten up to 10, and strtof.
+
+inline bool isNumberSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline void skipNumberSpaces(const char*& p, const char* end)
+{
+    while(p < end && isNumberSpace(*p))
+        p++;
+}
+
+// skips the token, e.g. a number that is not needed
+inline void skipToken(const char*& p, const char* end)
+{
+    skipNumberSpaces(p, end);
+
+    while(p < end && !isNumberSpace(*p))
+        p++;
+}
+
+inline bool parseInteger(const char*& p, const char* end, int64_t& value)
+{
+    skipNumberSpaces(p, end);
+
+    const char* s = p;
+    bool isNegative = false;
+
+    if(s < end && (*s == '-' || *s == '+'))
+        isNegative = *s++ == '-';
+
+    const char* digitsStart = s;
+    uint64_t magnitude = 0;
+
+    while(s < end && *s >= '0' && *s <= '9')
+        magnitude = magnitude * 10 + (*s++ - '0');
+
+    if(s == digitsStart)
+        return false;
+
+    value = isNegative ? -(int64_t)magnitude : (int64_t)magnitude;
+    p = s;
+
+    return true;
+}
+
+// strtod or strtof on a null terminated copy of the token, on the stack
+// .. unless it is long
+template<class Real>
+inline bool parseRealByConversion(const char*& p, const char* end, Real& value, Real (*convert)(const char*, char**))
+{
+    const char* tokenEnd = p;
+
+    while(tokenEnd < end && !isNumberSpace(*tokenEnd))
+        tokenEnd++;
+
+    char buffer[64];
+    std::string longToken;
+    const char* token = buffer;
+
+    if(tokenEnd - p < (std::ptrdiff_t)sizeof(buffer))
+    {
+        std::memcpy(buffer, p, tokenEnd - p);
+        buffer[tokenEnd - p] = '\0';
+    }
+    else
+    {
+        longToken.assign(p, tokenEnd);
+        token = longToken.c_str();
+    }
+
+    char* parsedEnd;
+
+    value = convert(token, &parsedEnd);
+
+    if(parsedEnd == token)
+        return false;
+
+    p += parsedEnd - token;
+
+    return true;
+}
+
+// the digits of a decimal number, at most 19 of which are significant
+struct DecimalDigits
+{
+    bool isNegative = false;
+    uint64_t mantissa = 0;
+    int numberOfSignificantDigits = 0;
+    int exponent = 0;
+};
+
+// scans a decimal number, returns where it ends, or nullptr if it is to be
+// .. parsed by strtod, e.g. it is a hexadecimal float, inf or nan
+inline const char* scanDecimal(const char* p, const char* end, DecimalDigits& digits)
+{
+    const char* s = p;
+    int numberOfDigits = 0;
+
+    if(s < end && (*s == '-' || *s == '+'))
+        digits.isNegative = *s++ == '-';
+
+    // integer part
+    for(; s < end && *s >= '0' && *s <= '9'; s++, numberOfDigits++)
+    {
+        if(digits.mantissa == 0 && *s == '0')
+            continue;
+
+        if(digits.numberOfSignificantDigits++ < 19)
+            digits.mantissa = digits.mantissa * 10 + (*s - '0');
+        else
+            digits.exponent++;
+    }
+
+    // fraction
+    if(s < end && *s == '.')
+    {
+        for(s++; s < end && *s >= '0' && *s <= '9'; s++, numberOfDigits++)
+        {
+            if(digits.mantissa == 0 && *s == '0')
+            {
+                digits.exponent--;
+                continue;
+            }
+
+            if(digits.numberOfSignificantDigits++ < 19)
+            {
+                digits.mantissa = digits.mantissa * 10 + (*s - '0');
+                digits.exponent--;
+            }
+        }
+    }
+
+    if(numberOfDigits == 0)
+        return nullptr;
+
+    // exponent
+    if(s < end && (*s == 'e' || *s == 'E'))
+    {
+        const char* exponentStart = s + 1;
+        int64_t writtenExponent;
+
+        if(exponentStart < end && !isNumberSpace(*exponentStart) && parseInteger(exponentStart, end, writtenExponent))
+        {
+            if(writtenExponent > 100000 || writtenExponent < -100000)
+                return nullptr;
+
+            digits.exponent += (int)writtenExponent;
+            s = exponentStart;
+        }
+    }
+
+    if(digits.numberOfSignificantDigits > 19 || (s < end && (*s == 'x' || *s == 'X')))
+        return nullptr;
+
+    return s;
+}
+
+inline bool parseReal(const char*& p, const char* end, double& value)
+{
+    static const double powersOfTen[23] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    skipNumberSpaces(p, end);
+
+    DecimalDigits digits;
+    const char* s = scanDecimal(p, end, digits);
+
+    if(!s || digits.mantissa > (1ULL << 53) || digits.exponent < -22 || digits.exponent > 22)
+        return parseRealByConversion<double>(p, end, value, std::strtod);
+
+    double result = (double)digits.mantissa;
+    result = digits.exponent < 0 ? result / powersOfTen[-digits.exponent] : result * powersOfTen[digits.exponent];
+
+    value = digits.isNegative ? -result : result;
+    p = s;
+
+    return true;
+}
+
+// a float is parsed by itself rather than through a double, which could round
+// .. it twice. its exact operands are of at most 24 bits
+inline bool parseReal(const char*& p, const char* end, float& value)
+{
+    static const float powersOfTen[11] = {
+        1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+    };
+
+    skipNumberSpaces(p, end);
+
+    DecimalDigits digits;
+    const char* s = scanDecimal(p, end, digits);
+
+    if(!s || digits.mantissa > (1ULL << 24) || digits.exponent < -10 || digits.exponent > 10)
+        return parseRealByConversion<float>(p, end, value, std::strtof);
+
+    float result = (float)digits.mantissa;
+    result = digits.exponent < 0 ? result / powersOfTen[-digits.exponent] : result * powersOfTen[digits.exponent];
+
+    value = digits.isNegative ? -result : result;
+    p = s;
+
+    return true;
+}
+
+#endif
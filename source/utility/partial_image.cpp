@@ -0,0 +1,236 @@
+#include "partial_image.hpp"
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <cstring>
+
+// file layout: magic, version, image name (length, chars), tonemapping
+// .. settings, width, height, number of regions, then for each region
+// .. x0 y0 x1 y1 (int) followed by its pixels as R G B (float)
+static const char PARTIAL_IMAGE_MAGIC[8] = { 'R', 'T', 'P', 'A', 'R', 'T', '\0', '\0' };
+static const int PARTIAL_IMAGE_VERSION = 1;
+
+template<class T>
+static void writeBinary(std::ofstream & stream, const T & value)
+{
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<class T>
+static void readBinary(std::ifstream & stream, T & value)
+{
+    stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+PartialImage::PartialImage(const std::string& filePath)
+{
+    std::ifstream stream(filePath.data(), std::ifstream::binary);
+
+    if(!stream)
+        throw std::runtime_error("Error: Cannot open partial image " + filePath);
+
+    char magic[8];
+    int version, imageNameLength, numberOfRegions;
+
+    stream.read(magic, sizeof(magic));
+    readBinary(stream, version);
+
+    if(!stream || std::memcmp(magic, PARTIAL_IMAGE_MAGIC, sizeof(magic)) || version != PARTIAL_IMAGE_VERSION)
+        throw std::runtime_error("Error: " + filePath + " is not a valid partial image.");
+
+    readBinary(stream, imageNameLength);
+
+    if(!stream || imageNameLength <= 0)
+        throw std::runtime_error("Error: " + filePath + " is not a valid partial image.");
+
+    imageName.resize(imageNameLength);
+    stream.read(&imageName[0], imageNameLength);
+
+    readBinary(stream, doTonemap);
+    readBinary(stream, toneMappingParam.keyValue);
+    readBinary(stream, toneMappingParam.burnoutPercentage);
+    readBinary(stream, toneMappingParam.saturation);
+    readBinary(stream, toneMappingParam.gamma);
+    readBinary(stream, width);
+    readBinary(stream, height);
+    readBinary(stream, numberOfRegions);
+
+    if(!stream || width <= 0 || height <= 0 || numberOfRegions < 0)
+        throw std::runtime_error("Error: " + filePath + " is not a valid partial image.");
+
+    ImageRegion wholeImage(0, 0, width, height);
+
+    for(int i = 0; i < numberOfRegions; i++)
+    {
+        ImageRegion region;
+
+        readBinary(stream, region.x0);
+        readBinary(stream, region.y0);
+        readBinary(stream, region.x1);
+        readBinary(stream, region.y1);
+
+        // a region out of the image would be written out of bounds
+        if(!stream || region.isEmpty() || region.intersect(wholeImage).getArea() != region.getArea())
+            throw std::runtime_error("Error: " + filePath + " has an invalid region.");
+
+        regions.push_back(region);
+
+        for(int j = 0; j < region.getArea(); j++)
+        {
+            float r, g, b;
+
+            readBinary(stream, r);
+            readBinary(stream, g);
+            readBinary(stream, b);
+
+            colors.push_back(Color(r, g, b));
+        }
+    }
+
+    if(!stream)
+        throw std::runtime_error("Error: Partial image " + filePath + " is truncated.");
+}
+
+PartialImage::PartialImage(
+    const std::string& imageName,
+    bool doTonemap,
+    const ToneMappingParam& toneMappingParam,
+    const Image& image,
+    const std::vector<ImageRegion>& regions
+) : imageName(imageName),
+    doTonemap(doTonemap),
+    toneMappingParam(toneMappingParam),
+    width(image.getWidth()), height(image.getHeight()),
+    regions(regions)
+{
+    for(int i = 0; i < (int)regions.size(); i++)
+    {
+        const ImageRegion & region = regions[i];
+
+        for(int y = region.y0; y < region.y1; y++)
+            for(int x = region.x0; x < region.x1; x++)
+                colors.push_back(image.getColor(x, y));
+    }
+}
+
+void PartialImage::write(const std::string& filePath) const
+{
+    std::ofstream stream(filePath.data(), std::ofstream::binary | std::ofstream::trunc);
+
+    int imageNameLength = imageName.length();
+    int numberOfRegions = regions.size();
+
+    stream.write(PARTIAL_IMAGE_MAGIC, sizeof(PARTIAL_IMAGE_MAGIC));
+    writeBinary(stream, PARTIAL_IMAGE_VERSION);
+    writeBinary(stream, imageNameLength);
+    stream.write(imageName.data(), imageNameLength);
+    writeBinary(stream, doTonemap);
+    writeBinary(stream, toneMappingParam.keyValue);
+    writeBinary(stream, toneMappingParam.burnoutPercentage);
+    writeBinary(stream, toneMappingParam.saturation);
+    writeBinary(stream, toneMappingParam.gamma);
+    writeBinary(stream, width);
+    writeBinary(stream, height);
+    writeBinary(stream, numberOfRegions);
+
+    int colorIndex = 0;
+
+    for(int i = 0; i < numberOfRegions; i++)
+    {
+        const ImageRegion & region = regions[i];
+
+        writeBinary(stream, region.x0);
+        writeBinary(stream, region.y0);
+        writeBinary(stream, region.x1);
+        writeBinary(stream, region.y1);
+
+        for(int j = 0; j < region.getArea(); j++, colorIndex++)
+        {
+            writeBinary(stream, colors[colorIndex].getFR());
+            writeBinary(stream, colors[colorIndex].getFG());
+            writeBinary(stream, colors[colorIndex].getFB());
+        }
+    }
+
+    stream.flush();
+
+    if(!stream)
+        throw std::runtime_error("Error: Partial image " + filePath + " could not be written.");
+}
+
+void PartialImage::copyTo(Image& image) const
+{
+    int colorIndex = 0;
+
+    for(int i = 0; i < (int)regions.size(); i++)
+    {
+        const ImageRegion & region = regions[i];
+
+        for(int y = region.y0; y < region.y1; y++)
+            for(int x = region.x0; x < region.x1; x++)
+                image.setColor(x, y, colors[colorIndex++]);
+    }
+}
+
+void PartialImage::merge(const std::vector<std::string>& filePaths)
+{
+    std::vector<PartialImage> partialImages;
+
+    for(int i = 0; i < (int)filePaths.size(); i++)
+        partialImages.push_back(PartialImage(filePaths[i]));
+
+    std::vector<bool> isMerged(partialImages.size(), false);
+
+    // each image name is an output image, merge its partial images
+    for(int i = 0; i < (int)partialImages.size(); i++)
+    {
+        if(isMerged[i])
+            continue;
+
+        const PartialImage & first = partialImages[i];
+
+        Image image(first.width, first.height);
+        std::vector<bool> isCovered(first.width * first.height, false);
+        int numberOfPartialImages = 0;
+
+        for(int j = i; j < (int)partialImages.size(); j++)
+        {
+            const PartialImage & partialImage = partialImages[j];
+
+            if(partialImage.imageName != first.imageName)
+                continue;
+
+            if(partialImage.width != first.width || partialImage.height != first.height)
+                throw std::runtime_error("Error: Partial images of " + first.imageName + " have different sizes.");
+
+            partialImage.copyTo(image);
+
+            for(int k = 0; k < (int)partialImage.regions.size(); k++)
+            {
+                const ImageRegion & region = partialImage.regions[k];
+
+                for(int y = region.y0; y < region.y1; y++)
+                    for(int x = region.x0; x < region.x1; x++)
+                        isCovered[y * first.width + x] = true;
+            }
+
+            isMerged[j] = true;
+            numberOfPartialImages++;
+        }
+
+        int numberOfMissingPixels = 0;
+
+        for(int k = 0; k < (int)isCovered.size(); k++)
+            if(!isCovered[k]) numberOfMissingPixels++;
+
+        // still write the image, missing pixels stay black
+        if(numberOfMissingPixels > 0)
+            std::cerr << "Warning: " << numberOfMissingPixels << " pixels of "
+                      << first.imageName << " are missing in the partial images." << std::endl;
+
+        image.writeOutput(first.imageName, first.doTonemap, first.toneMappingParam);
+
+        std::cout << "Merged " << numberOfPartialImages << " partial images into "
+                  << first.imageName << "." << std::endl;
+    }
+}
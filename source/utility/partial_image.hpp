@@ -0,0 +1,57 @@
+#ifndef __PARTIAL_IMAGE_H__
+#define __PARTIAL_IMAGE_H__
+
+#include "../image/image.hpp"
+#include "../image/color.hpp"
+#include "image_region.hpp"
+#include <string>
+#include <vector>
+
+// Part of an image rendered by a single process, e.g. a region or a range of
+// .. tiles of the frame. The colors are stored as floats together with their
+// .. placement in the frame and the output settings of the camera, so that the
+// .. partial images can be merged into the final image without the scene.
+class PartialImage
+{
+    private:
+        // output settings of the camera
+        std::string imageName;
+        bool doTonemap;
+        ToneMappingParam toneMappingParam;
+
+        // size of the whole image
+        int width, height;
+
+        std::vector<ImageRegion> regions;
+
+        // colors of the regions one after another, each row-major
+        std::vector<Color> colors;
+
+    public:
+        // reads a partial image file
+        PartialImage(const std::string& filePath);
+
+        // copies the given regions of the image
+        PartialImage(
+            const std::string& imageName,
+            bool doTonemap,
+            const ToneMappingParam& toneMappingParam,
+            const Image& image,
+            const std::vector<ImageRegion>& regions
+        );
+
+        void write(const std::string& filePath) const;
+
+        // copies the colors into their place in the image
+        void copyTo(Image& image) const;
+
+        const std::string& getImageName() const { return imageName; }
+        int getWidth() const { return width; }
+        int getHeight() const { return height; }
+        const std::vector<ImageRegion>& getRegions() const { return regions; }
+
+        // merges the partial images of each image name and writes the results
+        static void merge(const std::vector<std::string>& filePaths);
+};
+
+#endif
@@ -2,8 +2,10 @@
 #define __PIXEL_MISSION_GENERATOR__
 
 #include "../geometry/headers/geometry.hpp"
+#include "image_region.hpp"
 #include <mutex>
 #include <condition_variable>
+#include <vector>
 
 class PixelMissionGenerator
 {
@@ -16,11 +18,92 @@ class PixelMissionGenerator
         int totalNumOfPixels;
         int filled = 0.f;
         int filledNotNotified = 0.f;
+
+        // regions to be filled, traversed one after another row by row
+        std::vector<ImageRegion> regions;
+        int regionIndex;
+
+        // pixels already filled before, e.g. restored from a checkpoint
+        // .. they are skipped, indexed as y * width + x
+        std::vector<bool> completedPixels;
+
+        bool isCompleted(int x, int y) const
+        {
+            return !completedPixels.empty() && completedPixels[y * width + x];
+        }
+
+        // advances to the next pixel, caller should hold bagMutex
+        bool getNextPixel(Vec2i & pixelToFill)
+        {
+            while(!done)
+            {
+                const ImageRegion & region = regions[regionIndex];
+
+                if(x < region.x1 && y < region.y1)
+                {
+                    pixelToFill.x = x;
+                    pixelToFill.y = y;
+                    x++;
+                    filled++; filledNotNotified++;
+                    //if(filledNotNotified > totalNumOfPixels / 300.f)
+                        change_on_filled.notify_one();
+                    return true;
+                }
+                else if(++y < region.y1)
+                {
+                    // next row of the region
+                    x = region.x0;
+                }
+                else if(++regionIndex < (int)regions.size())
+                {
+                    // next region
+                    x = regions[regionIndex].x0;
+                    y = regions[regionIndex].y0;
+                }
+                else
+                {
+                    done = true;
+                    change_on_filled.notify_one();
+                }
+            }
+
+            return false;
+        }
     public:
         PixelMissionGenerator(int width, int height)
-            : width(width), height(height), done(false), x(0), y(0)
+            : PixelMissionGenerator(width, height, std::vector<ImageRegion>(1, ImageRegion(0, 0, width, height)))
+            { }
+
+        PixelMissionGenerator(int width, int height, const std::vector<ImageRegion> & regions)
+            : width(width), height(height), done(false), x(0), y(0), regionIndex(0)
+            {
+                totalNumOfPixels = 0;
+
+                // empty regions would break the traversal
+                for(int i = 0; i < (int)regions.size(); i++)
+                {
+                    if(!regions[i].isEmpty())
+                    {
+                        this->regions.push_back(regions[i]);
+                        totalNumOfPixels += regions[i].getArea();
+                    }
+                }
+
+                if(this->regions.empty())
+                {
+                    done = true;
+                }
+                else
+                {
+                    x = this->regions[0].x0;
+                    y = this->regions[0].y0;
+                }
+            }
+
+        PixelMissionGenerator(int width, int height, const std::vector<ImageRegion> & regions, const std::vector<bool> & completedPixels)
+            : PixelMissionGenerator(width, height, regions)
             {
-                totalNumOfPixels = width * height;
+                this->completedPixels = completedPixels;
             }
         
         bool getFilledPerc(float & perc)
@@ -35,7 +118,7 @@ class PixelMissionGenerator
 
             filledNotNotified = 0;
 
-            perc = filled / (float)totalNumOfPixels;
+            perc = totalNumOfPixels > 0 ? filled / (float)totalNumOfPixels : 1.f;
 
             if(perc > 1.f) perc = 1.f;
             if(perc < 0.f) perc = 0.f;
@@ -49,39 +132,50 @@ class PixelMissionGenerator
         {
             std::lock_guard<std::mutex> guard(bagMutex);
 
-            if(done)
-                return false;
-            
-            if(x < width)
+            while(getNextPixel(pixelToFill))
             {
-                pixelToFill.x = x;
-                pixelToFill.y = y;
-                x++;
-                filled++; filledNotNotified++;
-                //if(filledNotNotified > totalNumOfPixels / 300.f)
-                    change_on_filled.notify_one();
-                return true;
+                if(!isCompleted(pixelToFill.x, pixelToFill.y))
+                    return true;
             }
-            else
+
+            return false;
+        }
+
+        // the pixels of the next block to fill, the columns
+        // .. [k * blockWidth, (k + 1) * blockWidth) of a row of the image
+        // .. clipped to the region. the blocks do not depend on the pixels
+        // .. completed before: the ones of which all pixels are completed are
+        // .. skipped, the others are returned whole, with their completed
+        // .. pixels as well
+        bool getBlockToFill(std::vector<Vec2i> & pixelsToFill, int blockWidth)
+        {
+            std::lock_guard<std::mutex> guard(bagMutex);
+
+            pixelsToFill.clear();
+
+            Vec2i pixelToFill;
+            bool isBlockCompleted = true;
+
+            while(getNextPixel(pixelToFill))
             {
-                x = 0;
-                if(++y < height)
-                {
-                    pixelToFill.x = x;
-                    pixelToFill.y = y;
-                    x++;
-                    filled++; filledNotNotified++;
-                    //if(filledNotNotified > totalNumOfPixels / 300.f)
-                        change_on_filled.notify_one();
-                    return true;
-                }
-                else
+                pixelsToFill.push_back(pixelToFill);
+                isBlockCompleted = isBlockCompleted && isCompleted(pixelToFill.x, pixelToFill.y);
+
+                // the block ends at an aligned column or at the end of the row
+                // .. of the region, x is the column of the next pixel
+                if(x % blockWidth == 0 || x >= regions[regionIndex].x1)
                 {
-                    done = true;
-                    change_on_filled.notify_one();
-                    return false;
+                    if(!isBlockCompleted)
+                        return true;
+
+                    pixelsToFill.clear();
+                    isBlockCompleted = true;
                 }
             }
+
+            pixelsToFill.clear();
+
+            return false;
         }
 };
 
@@ -1,130 +1,722 @@
 #include "ply_parser.hpp"
-#include "pair.hpp"
-#include "tinyply-2.0/source/tinyply.h"
+#include "mapped_file.hpp"
+#include "number_parser.hpp"
+#include "run_in_parallel.hpp"
 #include "../geometry/headers/structs.hpp"
-#include "../geometry/headers/position3.hpp"
+#include "../geometry/headers/vertex.hpp"
+#include "../geometry/headers/vector3.hpp"
 
 #include <vector>
+#include <string>
 #include <sstream>
-#include <fstream>
-#include <iostream>
 #include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <exception>
+#include <thread>
+#include <algorithm>
 
-using namespace tinyply;
+// Ply files are mapped to the memory and their elements are read in place
+// .. into the buffers of the mesh:
+//  - binary: the values are read where they are, the faces are walked twice,
+// ..   first to count the triangles, so that they are written to a buffer of
+// ..   their final size
+//  - ascii: the lines of an element are split into chunks, which are parsed
+// ..   by a thread each. the faces are parsed twice for the same reason
+// The elements other than the vertices and the faces are skipped.
 
-// vertexData, meshVertexIndices, texCoordData(if applicable)
-Triple< std::vector<Vec3f>, std::vector<Vec3i>, std::vector<Vec2f> >
-parsePly(const std::string& filename)
+// the lines of an ascii element smaller than this are parsed by one thread
+#define PLY_MIN_CHUNK_SIZE (1 << 20)
+
+enum class PlyFormat { ASCII, BINARY_LITTLE_ENDIAN, BINARY_BIG_ENDIAN };
+
+enum class PlyType { INT8, UINT8, INT16, UINT16, INT32, UINT32, FLOAT32, FLOAT64 };
+
+// the vertex properties the mesh is made of
+enum PlyField { FIELD_NONE = -1, FIELD_X, FIELD_Y, FIELD_Z, FIELD_NX, FIELD_NY, FIELD_NZ, FIELD_U, FIELD_V, NUMBER_OF_FIELDS };
+
+struct PlyProperty
+{
+    std::string name;
+    PlyType type;
+
+    // a list has the number of its values, of countType, before them
+    bool isList;
+    PlyType countType;
+};
+
+struct PlyElement
+{
+    std::string name;
+    int64_t count;
+    std::vector<PlyProperty> properties;
+};
+
+struct PlyHeader
+{
+    PlyFormat format;
+    std::vector<PlyElement> elements;
+
+    // where the elements start, following the header
+    const char* body;
+};
+
+// lines of an ascii element parsed by a thread
+struct PlyChunk
 {
-    std::ifstream ss(filename, std::ios::binary);
+    const char* begin;
+    const char* end;
+    int64_t firstLine;
 
-    if (ss.fail()) 
+    // the triangles of the faces in the chunk
+    int64_t firstTriangle;
+    int64_t numberOfTriangles;
+};
+
+static std::runtime_error plyError(const std::string& fileName, const std::string& problem)
+{
+    return std::runtime_error("Error: Ply file " + fileName + " " + problem + ".");
+}
+
+static bool parseType(const std::string& name, PlyType& type)
+{
+    if(name == "char" || name == "int8")
+        type = PlyType::INT8;
+    else if(name == "uchar" || name == "uint8")
+        type = PlyType::UINT8;
+    else if(name == "short" || name == "int16")
+        type = PlyType::INT16;
+    else if(name == "ushort" || name == "uint16")
+        type = PlyType::UINT16;
+    else if(name == "int" || name == "int32")
+        type = PlyType::INT32;
+    else if(name == "uint" || name == "uint32")
+        type = PlyType::UINT32;
+    else if(name == "float" || name == "float32")
+        type = PlyType::FLOAT32;
+    else if(name == "double" || name == "float64")
+        type = PlyType::FLOAT64;
+    else
+        return false;
+
+    return true;
+}
+
+static int getTypeSize(PlyType type)
+{
+    switch(type)
     {
-        throw std::runtime_error("failed to open ply file" + filename);
+        case PlyType::INT8:
+        case PlyType::UINT8:
+            return 1;
+        case PlyType::INT16:
+        case PlyType::UINT16:
+            return 2;
+        case PlyType::INT32:
+        case PlyType::UINT32:
+        case PlyType::FLOAT32:
+            return 4;
+        case PlyType::FLOAT64:
+            return 8;
     }
 
-    PlyFile file;
+    return 0;
+}
+
+static PlyField getVertexField(const std::string& name)
+{
+    if(name == "x") return FIELD_X;
+    if(name == "y") return FIELD_Y;
+    if(name == "z") return FIELD_Z;
+    if(name == "nx") return FIELD_NX;
+    if(name == "ny") return FIELD_NY;
+    if(name == "nz") return FIELD_NZ;
+    if(name == "u" || name == "s" || name == "texture_u" || name == "texture_s") return FIELD_U;
+    if(name == "v" || name == "t" || name == "texture_v" || name == "texture_t") return FIELD_V;
+
+    return FIELD_NONE;
+}
 
-    // parse header
-    file.parse_header(ss);
+static PlyHeader parseHeader(const std::string& fileName, const char* data, const char* end)
+{
+    PlyHeader header;
+    bool hasFormat = false;
 
-    // will read vertex and face information
-    std::shared_ptr<PlyData> tinyply_vertices, tinyply_faces, tinply_uvs;
+    const char* p = data;
 
-    // read data from file
-        // vertex data
-    try 
+    for(int lineNumber = 0; ; lineNumber++)
     {
-        tinyply_vertices = file.request_properties_from_element("vertex", { "x", "y", "z" });
+        if(p >= end)
+            throw plyError(fileName, "has no end_header");
+
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if(!lineEnd)
+            lineEnd = end;
+
+        std::istringstream line(std::string(p, lineEnd));
+        p = lineEnd < end ? lineEnd + 1 : end;
+
+        std::string keyword;
+        line >> keyword;
+
+        if(lineNumber == 0)
+        {
+            if(keyword != "ply")
+                throw plyError(fileName, "does not start with ply");
+        }
+        else if(keyword == "format")
+        {
+            std::string format;
+            line >> format;
+
+            if(format == "ascii")
+                header.format = PlyFormat::ASCII;
+            else if(format == "binary_little_endian")
+                header.format = PlyFormat::BINARY_LITTLE_ENDIAN;
+            else if(format == "binary_big_endian")
+                header.format = PlyFormat::BINARY_BIG_ENDIAN;
+            else
+                throw plyError(fileName, "has an unknown format " + format);
+
+            hasFormat = true;
+        }
+        else if(keyword == "element")
+        {
+            PlyElement element;
+            line >> element.name >> element.count;
+
+            if(!line || element.count < 0)
+                throw plyError(fileName, "has an invalid element");
+
+            header.elements.push_back(element);
+        }
+        else if(keyword == "property")
+        {
+            PlyProperty property;
+            std::string typeName;
+
+            line >> typeName;
+
+            property.isList = typeName == "list";
+
+            if(property.isList)
+            {
+                std::string countTypeName;
+                line >> countTypeName >> typeName;
+
+                if(!parseType(countTypeName, property.countType))
+                    throw plyError(fileName, "has an unknown type " + countTypeName);
+            }
+
+            line >> property.name;
+
+            if(!line || header.elements.empty())
+                throw plyError(fileName, "has an invalid property");
+
+            if(!parseType(typeName, property.type))
+                throw plyError(fileName, "has an unknown type " + typeName);
+
+            header.elements.back().properties.push_back(property);
+        }
+        else if(keyword == "end_header")
+        {
+            break;
+        }
+
+        // comment, obj_info and the rest are ignored
     }
-    catch (const std::exception & e) 
+
+    if(!hasFormat)
+        throw plyError(fileName, "has no format");
+
+    header.body = p;
+
+    return header;
+}
+
+// the value of the type at p, whose bytes are reversed if the file is big
+// .. endian
+template<class T>
+static inline T readRaw(const char* p, bool swapBytes)
+{
+    T value;
+
+    if(swapBytes)
     {
-        std::cerr << "tinyply exception: " << e.what() << std::endl;
+        char bytes[sizeof(T)];
+
+        for(int i = 0; i < (int)sizeof(T); i++)
+            bytes[i] = p[sizeof(T) - 1 - i];
+
+        std::memcpy(&value, bytes, sizeof(T));
     }
-        // face data
-    try
+    else
     {
-        tinyply_faces = file.request_properties_from_element("face", { "vertex_indices" });
+        std::memcpy(&value, p, sizeof(T));
     }
-    catch (const std::exception & e)
+
+    return value;
+}
+
+static inline double readBinaryValue(const char* p, PlyType type, bool swapBytes)
+{
+    switch(type)
     {
-        try
+        case PlyType::INT8:    return readRaw<int8_t>(p, swapBytes);
+        case PlyType::UINT8:   return readRaw<uint8_t>(p, swapBytes);
+        case PlyType::INT16:   return readRaw<int16_t>(p, swapBytes);
+        case PlyType::UINT16:  return readRaw<uint16_t>(p, swapBytes);
+        case PlyType::INT32:   return readRaw<int32_t>(p, swapBytes);
+        case PlyType::UINT32:  return readRaw<uint32_t>(p, swapBytes);
+        case PlyType::FLOAT32: return readRaw<float>(p, swapBytes);
+        case PlyType::FLOAT64: return readRaw<double>(p, swapBytes);
+    }
+
+    return 0.0;
+}
+
+static inline Vertex makeVertex(const double* values, bool hasNormals)
+{
+    Vertex vertex((float)values[FIELD_X], (float)values[FIELD_Y], (float)values[FIELD_Z]);
+
+    if(hasNormals)
+    {
+        vertex.addToNormal(Vector3((float)values[FIELD_NX], (float)values[FIELD_NY], (float)values[FIELD_NZ]));
+        vertex.normalizeNormal();
+    }
+
+    return vertex;
+}
+
+// the index of the face list, checked against the number of vertices
+static inline int getVertexIndex(double value, int64_t numberOfVertices, const std::string& fileName)
+{
+    if(!(value >= 0.0 && value < (double)numberOfVertices))
+        throw plyError(fileName, "has a face of a missing vertex");
+
+    return (int)value;
+}
+
+//
+// binary
+//
+
+// the binary elements, returns where the next element starts
+static const char* readBinaryElement(
+    const PlyElement& element,
+    const char* p, const char* end,
+    bool swapBytes,
+    const std::string& fileName,
+    const std::vector<int>& fields,     // vertex field of each property, if the vertices
+    int indexProperty,                  // property of the vertex indices, if the faces
+    int64_t numberOfVertices,
+    PlyMesh& mesh
+)
+{
+    bool isVertex = !fields.empty();
+    bool isFace = indexProperty >= 0;
+    bool hasTexCoords = isVertex && std::count(fields.begin(), fields.end(), FIELD_U) > 0;
+
+    // the triangles of the faces are counted first
+    int64_t numberOfTriangles = 0;
+
+    for(int pass = isFace ? 0 : 1; pass < 2; pass++)
+    {
+        const char* q = p;
+        int64_t triangle = 0;
+
+        if(pass == 1 && isFace)
+            mesh.faces.resize(numberOfTriangles);
+
+        if(isVertex)
         {
-            tinyply_faces = file.request_properties_from_element("face", { "vertex_index" });
+            mesh.vertices.reserve(element.count);
+
+            if(hasTexCoords)
+                mesh.texCoords.reserve(element.count);
         }
-        catch (const std::exception & e)
+
+        for(int64_t i = 0; i < element.count; i++)
         {
-            std::cerr << "tinyply exception: " << e.what() << std::endl;
+            double values[NUMBER_OF_FIELDS] = { 0.0 };
+
+            for(int j = 0; j < (int)element.properties.size(); j++)
+            {
+                const PlyProperty & property = element.properties[j];
+                int size = getTypeSize(property.type);
+
+                if(!property.isList)
+                {
+                    if(end - q < size)
+                        throw plyError(fileName, "is truncated");
+
+                    if(isVertex && fields[j] != FIELD_NONE)
+                        values[fields[j]] = readBinaryValue(q, property.type, swapBytes);
+
+                    q += size;
+                    continue;
+                }
+
+                int countSize = getTypeSize(property.countType);
+
+                if(end - q < countSize)
+                    throw plyError(fileName, "is truncated");
+
+                double count = readBinaryValue(q, property.countType, swapBytes);
+                q += countSize;
+
+                if(!(count >= 0.0) || (double)(end - q) < count * size)
+                    throw plyError(fileName, "is truncated");
+
+                int numberOfValues = (int)count;
+
+                if(j == indexProperty && numberOfValues >= 3)
+                {
+                    if(pass == 0)
+                    {
+                        numberOfTriangles += numberOfValues - 2;
+                    }
+                    else
+                    {
+                        // fan triangulation
+                        int first = getVertexIndex(readBinaryValue(q, property.type, swapBytes), numberOfVertices, fileName);
+                        int previous = getVertexIndex(readBinaryValue(q + size, property.type, swapBytes), numberOfVertices, fileName);
+
+                        for(int k = 2; k < numberOfValues; k++)
+                        {
+                            int current = getVertexIndex(readBinaryValue(q + k * size, property.type, swapBytes), numberOfVertices, fileName);
+
+                            mesh.faces[triangle++] = Vec3i(first, previous, current);
+                            previous = current;
+                        }
+                    }
+                }
+
+                q += numberOfValues * size;
+            }
+
+            if(isVertex)
+            {
+                mesh.vertices.push_back(makeVertex(values, mesh.hasNormals));
+
+                if(hasTexCoords)
+                    mesh.texCoords.push_back(Vec2f((float)values[FIELD_U], (float)values[FIELD_V]));
+            }
         }
-        
+
+        if(pass == 1)
+            return q;
     }
-        // texCoordData - if applicable
-    bool hasTexCoord = false;
-    try 
+
+    return p;
+}
+
+//
+// ascii
+//
+
+// splits the lines of the element into chunks, returns where the next element
+// .. starts
+static const char* splitAsciiElement(
+    const PlyElement& element,
+    const char* p, const char* end,
+    const std::string& fileName,
+    std::vector<PlyChunk>& chunks
+)
+{
+    int maxNumberOfChunks = std::max(1u, std::thread::hardware_concurrency());
+
+    // the first lines of the chunks, the lines are found one by one
+    std::vector<const char*> boundaries(maxNumberOfChunks + 1, nullptr);
+    int nextBoundary = 0;
+
+    const char* begin = p;
+
+    for(int64_t line = 0; line <= element.count; line++)
     {
-        tinply_uvs = file.request_properties_from_element("vertex", { "u", "v" });
-        hasTexCoord = true;
+        while(nextBoundary <= maxNumberOfChunks && element.count * nextBoundary / maxNumberOfChunks == line)
+            boundaries[nextBoundary++] = p;
+
+        if(line == element.count)
+            break;
+
+        if(p >= end)
+            throw plyError(fileName, "is truncated");
+
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        p = lineEnd ? lineEnd + 1 : end;
     }
-    catch (const std::exception & e) 
+
+    // fewer chunks for a small element, since starting a thread is not free
+    int numberOfChunks = std::min<int64_t>(maxNumberOfChunks, (p - begin) / PLY_MIN_CHUNK_SIZE + 1);
+
+    chunks.resize(numberOfChunks);
+
+    for(int i = 0; i < numberOfChunks; i++)
     {
-        hasTexCoord = false;
+        int first = i * maxNumberOfChunks / numberOfChunks;
+        int last = (i + 1) * maxNumberOfChunks / numberOfChunks;
+
+        chunks[i].begin = boundaries[first];
+        chunks[i].end = boundaries[last];
+        chunks[i].firstLine = element.count * first / maxNumberOfChunks;
+        chunks[i].firstTriangle = 0;
+        chunks[i].numberOfTriangles = 0;
     }
-    
-file.read(ss);
 
-int numberPerElement = (tinyply_faces->buffer.size_bytes() / sizeof(int)) / tinyply_faces->count;
+    return p;
+}
 
-if(numberPerElement > 4 || numberPerElement < 3)
+// parses the lines of the chunk, calling parseLine(line index, line) for each
+template<class LineParser>
+static void parseAsciiChunk(const PlyChunk& chunk, const LineParser& parseLine)
 {
-    throw std::runtime_error("Unsupported ply file");
+    const char* p = chunk.begin;
+
+    for(int64_t line = chunk.firstLine; p < chunk.end; line++)
+    {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', chunk.end - p));
+        if(!lineEnd)
+            lineEnd = chunk.end;
+
+        parseLine(line, p, lineEnd);
+
+        p = lineEnd + 1;
+    }
 }
-    // get vertices
-    const size_t numVerticesBytes = tinyply_vertices->buffer.size_bytes();
-    std::vector<Vec3f> vertices(tinyply_vertices->count);
-    std::memcpy(vertices.data(), tinyply_vertices->buffer.get(), numVerticesBytes);
-
-    // get texcoorddata
-    std::vector<Vec2f> texCoordData;
-    if(hasTexCoord)
+
+static void parseAsciiVertices(
+    const PlyElement& element,
+    const std::vector<PlyChunk>& chunks,
+    const std::vector<int>& fields,
+    const std::string& fileName,
+    PlyMesh& mesh
+)
+{
+    bool hasTexCoords = std::count(fields.begin(), fields.end(), FIELD_U) > 0;
+
+    mesh.vertices.assign(element.count, Vertex(0.f, 0.f, 0.f));
+
+    if(hasTexCoords)
+        mesh.texCoords.resize(element.count);
+
+    runInParallel(chunks.size(), [&](int i)
     {
-        const size_t numTexCoordDataBytes = tinply_uvs->buffer.size_bytes();
-        texCoordData = std::vector<Vec2f>(tinply_uvs->count);
-        std::memcpy(texCoordData.data(), tinply_uvs->buffer.get(), numTexCoordDataBytes);
+        parseAsciiChunk(chunks[i], [&](int64_t line, const char* p, const char* lineEnd)
+        {
+            double values[NUMBER_OF_FIELDS] = { 0.0 };
+
+            for(int j = 0; j < (int)element.properties.size(); j++)
+            {
+                const PlyProperty & property = element.properties[j];
+
+                if(property.isList)
+                {
+                    int64_t count;
+
+                    if(!parseInteger(p, lineEnd, count))
+                        throw plyError(fileName, "has an invalid vertex");
+
+                    for(int64_t k = 0; k < count; k++)
+                        skipToken(p, lineEnd);
+                }
+                else if(fields[j] != FIELD_NONE)
+                {
+                    if(!parseReal(p, lineEnd, values[fields[j]]))
+                        throw plyError(fileName, "has an invalid vertex");
+                }
+                else
+                {
+                    skipToken(p, lineEnd);
+                }
+            }
+
+            mesh.vertices[line] = makeVertex(values, mesh.hasNormals);
+
+            if(hasTexCoords)
+                mesh.texCoords[line] = Vec2f((float)values[FIELD_U], (float)values[FIELD_V]);
+        });
+    });
+}
+
+static void parseAsciiFaces(
+    const PlyElement& element,
+    std::vector<PlyChunk>& chunks,
+    int indexProperty,
+    int64_t numberOfVertices,
+    const std::string& fileName,
+    PlyMesh& mesh
+)
+{
+    // the triangles of the chunks are counted first, then they are written
+    // .. to the buffer from the first triangles of the chunks
+    for(int pass = 0; pass < 2; pass++)
+    {
+        if(pass == 1)
+        {
+            int64_t numberOfTriangles = 0;
+
+            for(int i = 0; i < (int)chunks.size(); i++)
+            {
+                chunks[i].firstTriangle = numberOfTriangles;
+                numberOfTriangles += chunks[i].numberOfTriangles;
+            }
+
+            mesh.faces.resize(numberOfTriangles);
+        }
+
+        runInParallel(chunks.size(), [&](int i)
+        {
+            PlyChunk & chunk = chunks[i];
+            int64_t triangle = chunk.firstTriangle;
+
+            parseAsciiChunk(chunk, [&](int64_t line, const char* p, const char* lineEnd)
+            {
+                for(int j = 0; j < (int)element.properties.size(); j++)
+                {
+                    const PlyProperty & property = element.properties[j];
+
+                    if(!property.isList)
+                    {
+                        skipToken(p, lineEnd);
+                        continue;
+                    }
+
+                    int64_t count;
+
+                    if(!parseInteger(p, lineEnd, count) || count < 0)
+                        throw plyError(fileName, "has an invalid face");
+
+                    if(j != indexProperty)
+                    {
+                        for(int64_t k = 0; k < count; k++)
+                            skipToken(p, lineEnd);
+
+                        continue;
+                    }
+
+                    if(count < 3)
+                        break;
+
+                    if(pass == 0)
+                    {
+                        chunk.numberOfTriangles += count - 2;
+                        break;
+                    }
+
+                    // fan triangulation
+                    int indices[3];
+
+                    for(int k = 0; k < count; k++)
+                    {
+                        int64_t index;
+
+                        if(!parseInteger(p, lineEnd, index))
+                            throw plyError(fileName, "has an invalid face");
+
+                        indices[k < 2 ? k : 2] = getVertexIndex(index, numberOfVertices, fileName);
+
+                        if(k >= 2)
+                        {
+                            mesh.faces[triangle++] = Vec3i(indices[0], indices[1], indices[2]);
+                            indices[1] = indices[2];
+                        }
+                    }
+
+                    break;
+                }
+            });
+        });
     }
+}
+
+PlyMesh parsePly(const std::string& fileName)
+{
+    MappedFile mappedFile;
 
-    // create indices vector
-    const size_t numFacesBytes = tinyply_faces->buffer.size_bytes();
-    std::vector<Vec3i> indices;
-    
-    int* indexBuffer = (int*)tinyply_faces->buffer.get();
+    if(!mappedFile.open(fileName))
+        throw std::runtime_error("Error: Ply file " + fileName + " cannot be opened.");
 
-    int bufferIndex = 0;
-    
-    // fill indices vector
-    for(int i = 0; i < tinyply_faces->count; i++)
+    const char* end = mappedFile.getData() + mappedFile.getSize();
+
+    PlyHeader header = parseHeader(fileName, mappedFile.getData(), end);
+
+    PlyMesh mesh;
+
+    // the number of vertices, for checking the faces
+    int64_t numberOfVertices = 0;
+
+    for(int i = 0; i < (int)header.elements.size(); i++)
+        if(header.elements[i].name == "vertex")
+            numberOfVertices = header.elements[i].count;
+
+    const char* p = header.body;
+
+    for(int i = 0; i < (int)header.elements.size(); i++)
     {
-        if(numberPerElement == 3)
+        const PlyElement & element = header.elements[i];
+
+        std::vector<int> fields;
+        int indexProperty = -1;
+
+        if(element.name == "vertex")
         {
-            indices.push_back(
-                Vec3i(indexBuffer[bufferIndex], indexBuffer[bufferIndex + 1], indexBuffer[bufferIndex + 2])
-            );
+            fields.resize(element.properties.size());
+
+            bool hasField[NUMBER_OF_FIELDS] = { false };
+
+            for(int j = 0; j < (int)element.properties.size(); j++)
+            {
+                fields[j] = element.properties[j].isList ? FIELD_NONE : getVertexField(element.properties[j].name);
+
+                if(fields[j] != FIELD_NONE)
+                    hasField[fields[j]] = true;
+            }
+
+            if(!hasField[FIELD_X] || !hasField[FIELD_Y] || !hasField[FIELD_Z])
+                throw plyError(fileName, "has no vertex positions");
+
+            mesh.hasNormals = hasField[FIELD_NX] && hasField[FIELD_NY] && hasField[FIELD_NZ];
+
+            // a vertex is read as a whole, the fields of the missing ones are
+            // .. not taken from the rest
+            if(!mesh.hasNormals)
+                std::replace_if(fields.begin(), fields.end(), [](int field) { return field >= FIELD_NX && field <= FIELD_NZ; }, FIELD_NONE);
+
+            if(!hasField[FIELD_U] || !hasField[FIELD_V])
+                std::replace_if(fields.begin(), fields.end(), [](int field) { return field == FIELD_U || field == FIELD_V; }, FIELD_NONE);
         }
-        else if(numberPerElement == 4)
+        else if(element.name == "face")
         {
-            indices.push_back(
-                Vec3i(indexBuffer[bufferIndex], indexBuffer[bufferIndex + 1], indexBuffer[bufferIndex + 2])
-            );
+            for(int j = 0; j < (int)element.properties.size(); j++)
+            {
+                const PlyProperty & property = element.properties[j];
 
-            indices.push_back(
-                Vec3i(indexBuffer[bufferIndex + 2], indexBuffer[bufferIndex + 3], indexBuffer[bufferIndex])
-            );
+                if(property.isList && (property.name == "vertex_indices" || property.name == "vertex_index"))
+                    indexProperty = j;
+            }
+
+            if(indexProperty < 0)
+                throw plyError(fileName, "has no vertex indices");
         }
 
-        bufferIndex += numberPerElement;
+        if(header.format == PlyFormat::ASCII)
+        {
+            std::vector<PlyChunk> chunks;
+            p = splitAsciiElement(element, p, end, fileName, chunks);
+
+            if(!fields.empty())
+                parseAsciiVertices(element, chunks, fields, fileName, mesh);
+            else if(indexProperty >= 0)
+                parseAsciiFaces(element, chunks, indexProperty, numberOfVertices, fileName, mesh);
+        }
+        else
+        {
+            bool swapBytes = header.format == PlyFormat::BINARY_BIG_ENDIAN;
+
+            p = readBinaryElement(element, p, end, swapBytes, fileName, fields, indexProperty, numberOfVertices, mesh);
+        }
     }
 
-    return 
-    Triple<
-        std::vector<Vec3f>, std::vector<Vec3i>, std::vector<Vec2f>
-        > (vertices, indices, texCoordData);
-}
\ No newline at end of file
+    return mesh;
+}
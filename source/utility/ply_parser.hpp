@@ -1,13 +1,26 @@
 #ifndef __PLY_PARSER_H__
 #define __PLY_PARSER_H__
 
-#include "pair.hpp"
 #include "../geometry/headers/structs.hpp"
+#include "../geometry/headers/vertex.hpp"
 #include <vector>
 #include <string>
 
-// vertexData, meshVertexIndices, texCoordData(if applicable)
-Triple< std::vector<Vec3f>, std::vector<Vec3i>, std::vector<Vec2f> >
-parsePly(const std::string& fileName);
+// a mesh of a ply file, in the buffers the triangles are created from
+struct PlyMesh
+{
+    // the normals are the ones of the file, normalized, if it has them
+    std::vector<Vertex> vertices;
+    bool hasNormals = false;
 
-#endif
\ No newline at end of file
+    // the faces with more than three vertices are triangulated as fans
+    std::vector<Vec3i> faces;
+
+    // empty if the vertices do not have texture coordinates
+    std::vector<Vec2f> texCoords;
+};
+
+// reads an ascii or binary ply file, the ascii ones in parallel
+PlyMesh parsePly(const std::string& fileName);
+
+#endif
@@ -4,6 +4,9 @@
 #include <cstdlib>
 #include <iostream>
 #include <chrono>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
 
 /*float getRand()
 {
@@ -17,18 +20,42 @@ float getRandomBtw01()
 {
     return (rand() % 100) / 100.f;
 }
+
+void seedRandomNumberGenerator(unsigned int seed)
+{
+    // rand() is shared by all threads, per-thread sequences are not available
+    srand(seed);
+}
 #else
 
+// each thread owns its engine. it is seeded once from random_device and
+// .. may be reseeded by seedRandomNumberGenerator() for reproducible sampling
+std::mt19937& getEngine()
+{
+    thread_local static std::random_device rd;
+    thread_local static std::mt19937 engine(rd());
+
+    return engine;
+}
 
 float getRandomBtw01()
 {
-    thread_local static std::random_device rd;
-    
-    return rd() / (float)rd.max();
+    std::mt19937& engine = getEngine();
+
+    // the largest numbers round to 1 as floats, they are the largest float
+    // .. below 1 instead so that the interval is [0, 1)
+    static const float belowOne = std::nextafter(1.f, 0.f);
+
+    return std::min(engine() / (float)engine.max(), belowOne);
+}
+
+void seedRandomNumberGenerator(unsigned int seed)
+{
+    getEngine().seed(seed);
 }
 
 #endif
-// random number in interval [-0.5, 0.5]
+// random number in interval [-0.5, 0.5)
 float getRandom0_5()
 {
     return getRandomBtw01() - 0.5f;
@@ -37,7 +64,9 @@ float getRandom0_5()
 // get random [0, i)
 int getRand(int i)
 {
-    int val = (int)(getRandomBtw01() * RAND_MAX) % i;
+    // in 64 bits, since the product is 2^31 for the largest random numbers,
+    // .. which overflows an int
+    int val = (int)((int64_t)(getRandomBtw01() * RAND_MAX) % i);
 
     return val;
 }
\ No newline at end of file
@@ -3,11 +3,16 @@
 
 //float getRand();
 
+// random number in interval [0, 1)
 float getRandomBtw01();
 
-// random number in interval [-0.5, 0.5]
+// random number in interval [-0.5, 0.5)
 float getRandom0_5();
 
 int getRand(int i);
 
-#endif
\ No newline at end of file
+// reseeds the random number generator of the calling thread. after seeding,
+// .. the sequence returned by getRandomBtw01() is fully determined by the seed
+void seedRandomNumberGenerator(unsigned int seed);
+
+#endif
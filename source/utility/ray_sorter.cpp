@@ -0,0 +1,77 @@
+#include "ray_sorter.hpp"
+#include <algorithm>
+
+// spreads the lower 9 bits of the value to every third bit
+static uint32_t spreadBits(uint32_t value)
+{
+    value = (value | (value << 16)) & 0x030000FF;
+    value = (value | (value <<  8)) & 0x0300F00F;
+    value = (value | (value <<  4)) & 0x030C30C3;
+    value = (value | (value <<  2)) & 0x09249249;
+
+    return value;
+}
+
+uint32_t RaySorter::getMortonCode(const Position3& position, const Position3& minPosition, const Vector3& extent)
+{
+    Vector3 offset = minPosition.to(position);
+
+    auto quantize = [](float offset, float extent)
+    {
+        if(extent <= 0.f)
+            return 0u;
+
+        return (uint32_t)std::min(511.f, std::max(0.f, offset / extent * 512.f));
+    };
+
+    return (spreadBits(quantize(offset.getX(), extent.getX())) << 2) |
+           (spreadBits(quantize(offset.getY(), extent.getY())) << 1) |
+            spreadBits(quantize(offset.getZ(), extent.getZ()));
+}
+
+void RaySorter::setBounds(const Position3& minPosition, const Position3& maxPosition)
+{
+    this->minPosition = minPosition;
+    this->extent = maxPosition - minPosition;
+}
+
+void RaySorter::setRayKey(int index, const Ray& ray)
+{
+    const Vector3 & direction = ray.getDirection();
+
+    uint32_t octant = (direction.getX() < 0.f ? 4 : 0) |
+                      (direction.getY() < 0.f ? 2 : 0) |
+                      (direction.getZ() < 0.f ? 1 : 0);
+
+    keys[index] = (octant << 27) | getMortonCode(ray.getOrigin(), minPosition, extent);
+}
+
+const std::vector<int>& RaySorter::sort(int numberOfBits)
+{
+    int size = keys.size();
+
+    order.resize(size);
+    sortedOrder.resize(size);
+
+    for(int i = 0; i < size; i++)
+        order[i] = i;
+
+    // least significant digit radix sort, a byte at a time
+    for(int shift = 0; shift < numberOfBits; shift += 8)
+    {
+        int offsets[257] = {0};
+
+        for(int i = 0; i < size; i++)
+            offsets[((keys[order[i]] >> shift) & 0xFF) + 1]++;
+
+        for(int i = 0; i < 256; i++)
+            offsets[i + 1] += offsets[i];
+
+        for(int i = 0; i < size; i++)
+            sortedOrder[offsets[(keys[order[i]] >> shift) & 0xFF]++] = order[i];
+
+        order.swap(sortedOrder);
+    }
+
+    return order;
+}
@@ -0,0 +1,42 @@
+#ifndef __RAY_SORTER_H__
+#define __RAY_SORTER_H__
+
+#include "../geometry/headers/ray.hpp"
+#include "../geometry/headers/position3.hpp"
+#include "../geometry/headers/vector3.hpp"
+#include <vector>
+#include <cstdint>
+
+// Orders a batch of items, e.g. rays, by 32 bit keys.
+//
+// The key of a ray is the octant of its direction followed by the Morton code
+// .. of its origin within the bounds of the origins of the batch, so that the
+// .. consecutive rays traverse the same nodes of the bounding volume hiearchy.
+// The buffers are kept to be reused by the batches.
+class RaySorter
+{
+    private:
+        std::vector<uint32_t> keys;
+        std::vector<int> order, sortedOrder;
+
+        Position3 minPosition;
+        Vector3 extent;
+
+        // 27 bit Morton code of the position within the bounds
+        static uint32_t getMortonCode(const Position3& position, const Position3& minPosition, const Vector3& extent);
+
+    public:
+        void resize(int size) { this->keys.resize(size); }
+
+        // bounds of the ray origins, to be set before the keys of the rays
+        void setBounds(const Position3& minPosition, const Position3& maxPosition);
+
+        void setKey(int index, uint32_t key) { this->keys[index] = key; }
+        void setRayKey(int index, const Ray& ray);
+
+        // indices of the items ordered by their keys, only the lower
+        // .. numberOfBits of the keys are compared
+        const std::vector<int>& sort(int numberOfBits = 32);
+};
+
+#endif
@@ -0,0 +1,280 @@
+#include "render_checkpoint.hpp"
+#include "../image/color.hpp"
+#include "../config.h"
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+// file layout: magic, version, header fields, then per pixel
+// .. R G B (float), weight sum (float), sample count (int)
+static const char CHECKPOINT_MAGIC[8] = { 'R', 'T', 'C', 'K', 'P', 'T', '\0', '\0' };
+static const int CHECKPOINT_VERSION = 2;
+
+template<class T>
+void writeBinary(std::vector<char> & buffer, const T & value)
+{
+    const char* bytes = reinterpret_cast<const char*>(&value);
+
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template<class T>
+void readBinary(std::ifstream & stream, T & value)
+{
+    stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+RenderCheckpoint::RenderCheckpoint(
+    const std::string& filePath,
+    unsigned int seed,
+    int cameraIndex,
+    int width, int height,
+    const ImageRegion& bounds,
+    int numSamples,
+    int intervalInSeconds
+) : filePath(filePath),
+    seed(seed),
+    cameraIndex(cameraIndex),
+    width(width), height(height),
+    bounds(bounds),
+    numSamples(numSamples),
+    colorSums(bounds.getArea(), Color::Black()),
+    weightSums(bounds.getArea(), 0.f),
+    sampleCounts(bounds.getArea()),
+    interval(intervalInSeconds),
+    numberOfRecordedPixels(0),
+    lastSave(std::chrono::steady_clock::now())
+{ }
+
+bool RenderCheckpoint::load()
+{
+    std::ifstream stream(filePath.data(), std::ifstream::binary);
+
+    if(!stream)
+        return false;
+
+    char magic[8];
+    int version, fileCameraIndex, fileWidth, fileHeight, fileNumSamples;
+    unsigned int fileSeed;
+    ImageRegion fileBounds;
+
+    stream.read(magic, sizeof(magic));
+    readBinary(stream, version);
+    readBinary(stream, fileSeed);
+    readBinary(stream, fileCameraIndex);
+    readBinary(stream, fileWidth);
+    readBinary(stream, fileHeight);
+    readBinary(stream, fileBounds.x0);
+    readBinary(stream, fileBounds.y0);
+    readBinary(stream, fileBounds.x1);
+    readBinary(stream, fileBounds.y1);
+    readBinary(stream, fileNumSamples);
+
+    if(!stream || std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) || version != CHECKPOINT_VERSION)
+        throw std::runtime_error("Error: " + filePath + " is not a valid checkpoint file.");
+
+    if(fileSeed != seed || fileCameraIndex != cameraIndex || fileWidth != width ||
+       fileHeight != height || fileNumSamples != numSamples ||
+       fileBounds.x0 != bounds.x0 || fileBounds.y0 != bounds.y0 ||
+       fileBounds.x1 != bounds.x1 || fileBounds.y1 != bounds.y1)
+        throw std::runtime_error("Error: Checkpoint " + filePath + " does not belong to this render.");
+
+    std::lock_guard<std::mutex> guard(saveMutex);
+
+    for(int i = 0; i < bounds.getArea(); i++)
+    {
+        float r, g, b;
+        int sampleCount;
+
+        readBinary(stream, r);
+        readBinary(stream, g);
+        readBinary(stream, b);
+        readBinary(stream, weightSums[i]);
+        readBinary(stream, sampleCount);
+
+        colorSums[i] = Color(r, g, b);
+        sampleCounts[i].store(sampleCount, std::memory_order_release);
+    }
+
+    if(!stream)
+        throw std::runtime_error("Error: Checkpoint " + filePath + " is truncated.");
+
+    return true;
+}
+
+std::vector<char> RenderCheckpoint::serialize() const
+{
+    std::vector<char> contents;
+    contents.reserve(sizeof(CHECKPOINT_MAGIC) + 10 * sizeof(int) + bounds.getArea() * (4 * sizeof(float) + sizeof(int)));
+
+    contents.insert(contents.end(), CHECKPOINT_MAGIC, CHECKPOINT_MAGIC + sizeof(CHECKPOINT_MAGIC));
+    writeBinary(contents, CHECKPOINT_VERSION);
+    writeBinary(contents, seed);
+    writeBinary(contents, cameraIndex);
+    writeBinary(contents, width);
+    writeBinary(contents, height);
+    writeBinary(contents, bounds.x0);
+    writeBinary(contents, bounds.y0);
+    writeBinary(contents, bounds.x1);
+    writeBinary(contents, bounds.y1);
+    writeBinary(contents, numSamples);
+
+    for(int i = 0; i < bounds.getArea(); i++)
+    {
+        // the sums of a pixel not recorded yet are being written by its thread
+        int sampleCount = sampleCounts[i].load(std::memory_order_acquire);
+        Color colorSum = sampleCount > 0 ? colorSums[i] : Color::Black();
+        float weightSum = sampleCount > 0 ? weightSums[i] : 0.f;
+
+        writeBinary(contents, colorSum.getFR());
+        writeBinary(contents, colorSum.getFG());
+        writeBinary(contents, colorSum.getFB());
+        writeBinary(contents, weightSum);
+        writeBinary(contents, sampleCount);
+    }
+
+    return contents;
+}
+
+void RenderCheckpoint::write(const std::vector<char>& contents) const
+{
+    // write to a temporary file first, then rename it over the checkpoint.
+    // .. the file is synced before, as rename is atomic but the data of the
+    // .. renamed file may not have reached the disk when the node crashes
+    std::string tmpFilePath = filePath + ".tmp";
+
+    int fileDescriptor = open(tmpFilePath.data(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool isWritten = fileDescriptor >= 0;
+
+    size_t offset = 0;
+
+    while(isWritten && offset < contents.size())
+    {
+        ssize_t written = ::write(fileDescriptor, contents.data() + offset, contents.size() - offset);
+
+        if(written > 0)
+            offset += written;
+        else if(written < 0 && errno == EINTR)
+            continue;
+        else
+            isWritten = false;
+    }
+
+    isWritten = isWritten && fsync(fileDescriptor) == 0;
+
+    if(fileDescriptor >= 0 && close(fileDescriptor) != 0)
+        isWritten = false;
+
+    if(!isWritten)
+    {
+        // keep rendering, the previous checkpoint is still intact
+        std::cerr << "Warning: Checkpoint " << tmpFilePath << " could not be written." << std::endl;
+        return;
+    }
+
+    if(std::rename(tmpFilePath.data(), filePath.data()) != 0)
+    {
+        std::cerr << "Warning: Checkpoint " << filePath << " could not be replaced." << std::endl;
+        return;
+    }
+
+    // the rename is durable only once the directory entry is synced
+    size_t slash = filePath.find_last_of('/');
+    std::string directoryPath = slash == std::string::npos ? "." : slash == 0 ? "/" : filePath.substr(0, slash);
+
+    int directoryDescriptor = open(directoryPath.data(), O_RDONLY | O_DIRECTORY);
+
+    if(directoryDescriptor < 0 || fsync(directoryDescriptor) != 0)
+        std::cerr << "Warning: Directory of checkpoint " << filePath << " could not be synced." << std::endl;
+
+    if(directoryDescriptor >= 0)
+        close(directoryDescriptor);
+}
+
+void RenderCheckpoint::save()
+{
+    std::lock_guard<std::mutex> guard(saveMutex);
+
+    write(serialize());
+
+    lastSave = std::chrono::steady_clock::now();
+}
+
+unsigned int RenderCheckpoint::getPixelSeed(int x, int y) const
+{
+    // splitmix64 finalizer over seed, camera and pixel
+    unsigned long long z = seed;
+    z = z * 0x9E3779B97F4A7C15ULL + (unsigned long long)cameraIndex;
+    z = z * 0x9E3779B97F4A7C15ULL + (unsigned long long)(y * width + x);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+
+    return (unsigned int)z;
+}
+
+void RenderCheckpoint::recordPixel(int x, int y, const Color& colorSum, float weightSum, int sampleCount)
+{
+    int index = getIndex(x, y);
+
+    colorSums[index] = colorSum;
+    weightSums[index] = weightSum;
+    sampleCounts[index].store(sampleCount, std::memory_order_release);
+
+    // periodic save, checked by every CHECKPOINT_CHECK_PERIOD-th pixel
+    if((numberOfRecordedPixels.fetch_add(1, std::memory_order_relaxed) + 1) % CHECKPOINT_CHECK_PERIOD != 0)
+        return;
+
+    // a thread saving meanwhile is not waited for, the next check saves the
+    // .. pixels it has missed
+    std::unique_lock<std::mutex> lock(saveMutex, std::try_to_lock);
+
+    if(!lock.owns_lock())
+        return;
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    if(now - lastSave >= interval)
+    {
+        // the other threads keep recording while the pixels are copied and
+        // .. the file is written
+        write(serialize());
+        lastSave = now;
+    }
+}
+
+Color RenderCheckpoint::getPixelColor(int x, int y) const
+{
+    int index = getIndex(x, y);
+
+    Color colorSum = colorSums[index];
+
+    return colorSum / weightSums[index];
+}
+
+std::vector<bool> RenderCheckpoint::getCompletedPixels() const
+{
+    std::vector<bool> completedPixels(width * height, false);
+
+    for(int y = bounds.y0; y < bounds.y1; y++)
+        for(int x = bounds.x0; x < bounds.x1; x++)
+            completedPixels[y * width + x] = sampleCounts[getIndex(x, y)].load(std::memory_order_acquire) > 0;
+
+    return completedPixels;
+}
+
+int RenderCheckpoint::getNumberOfCompletedPixels() const
+{
+    int result = 0;
+
+    for(int i = 0; i < bounds.getArea(); i++)
+        if(sampleCounts[i].load(std::memory_order_acquire) > 0) result++;
+
+    return result;
+}
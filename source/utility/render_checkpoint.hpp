@@ -0,0 +1,98 @@
+#ifndef __RENDER_CHECKPOINT_H__
+#define __RENDER_CHECKPOINT_H__
+
+#include "../image/color.hpp"
+#include "image_region.hpp"
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+// Render state of a single camera, which can be written to and read from a
+// .. checkpoint file so that an interrupted render continues where it stopped.
+//
+// The state consists of the accumulation buffer (sum of weighted samples and
+// .. sum of weights per pixel), the number of samples taken per pixel and the
+// .. sampler state. The sampler of each pixel is reseeded by a seed derived
+// .. from the render seed, the camera and the pixel. Therefore, the render seed
+// .. is the whole sampler state and a resumed render produces exactly the same
+// .. output as an uninterrupted one, regardless of the order pixels are traced.
+//
+// Only the pixels inside the bounds are stored, so that a process rendering a
+// .. part of the frame keeps a checkpoint of its part only.
+class RenderCheckpoint
+{
+    private:
+        std::string filePath;
+
+        unsigned int seed;
+        int cameraIndex;
+        int width, height;
+        ImageRegion bounds;
+        int numSamples;
+
+        // accumulation buffer and per-pixel sample counts of the pixels in
+        // .. bounds, row-major. each pixel is recorded once, by the thread
+        // .. tracing it, without a lock: its sample count is stored last, so
+        // .. the sums of a pixel are complete once its count is read as set
+        std::vector<Color> colorSums;
+        std::vector<float> weightSums;
+        std::vector<std::atomic<int>> sampleCounts;
+
+        // periodic saving, the interval is checked once every
+        // .. CHECKPOINT_CHECK_PERIOD recorded pixels
+        std::chrono::seconds interval;
+        std::atomic<int> numberOfRecordedPixels;
+
+        // guards the saving, lastSave and the temporary file
+        std::mutex saveMutex;
+        std::chrono::steady_clock::time_point lastSave;
+
+        // the file contents, of the pixels recorded so far
+        std::vector<char> serialize() const;
+
+        // writes the contents to the temporary file, syncs it to the disk and
+        // .. renames it over the checkpoint. caller should hold saveMutex
+        void write(const std::vector<char>& contents) const;
+
+        int getIndex(int x, int y) const { return (y - bounds.y0) * bounds.getWidth() + (x - bounds.x0); }
+
+    public:
+        RenderCheckpoint(
+            const std::string& filePath,
+            unsigned int seed,
+            int cameraIndex,
+            int width, int height,
+            const ImageRegion& bounds,
+            int numSamples,
+            int intervalInSeconds
+        );
+
+        // reads the checkpoint file. returns false if there is no checkpoint
+        // .. to resume from, throws if it does not belong to this render
+        bool load();
+
+        // writes the checkpoint file atomically
+        void save();
+
+        // seed to be used for the sampler while tracing the given pixel
+        unsigned int getPixelSeed(int x, int y) const;
+
+        // records the accumulated samples of a completed pixel. the checkpoint
+        // .. is saved if the interval since the last save has passed, by this
+        // .. thread while the others keep recording
+        void recordPixel(int x, int y, const Color& colorSum, float weightSum, int sampleCount);
+
+        bool isPixelCompleted(int x, int y) const { return bounds.contains(x, y) && sampleCounts[getIndex(x, y)].load(std::memory_order_acquire) > 0; }
+
+        // normalized color of a completed pixel
+        Color getPixelColor(int x, int y) const;
+
+        // completion mask of the whole image, indexed as y * width + x
+        std::vector<bool> getCompletedPixels() const;
+
+        int getNumberOfCompletedPixels() const;
+};
+
+#endif
@@ -0,0 +1,224 @@
+#include "render_options.hpp"
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+// returns the value following the option at index i, advances i
+std::string getOptionValue(int argc, char* argv[], int & i)
+{
+    if(i + 1 >= argc)
+        throw std::runtime_error(std::string("Error: Missing value for ") + argv[i]);
+
+    return argv[++i];
+}
+
+// the integer following the option at index i, advances i
+int getIntegerOptionValue(int argc, char* argv[], int & i)
+{
+    std::string value = getOptionValue(argc, argv, i);
+
+    size_t length = 0;
+    int result = 0;
+
+    try
+    {
+        result = std::stoi(value, &length);
+    }
+    catch(const std::logic_error&)
+    {
+        length = 0;
+    }
+
+    if(length == 0 || length != value.size())
+        throw std::runtime_error("Error: Option value " + value + " is not an integer.");
+
+    return result;
+}
+
+RenderOptions parseRenderOptions(int argc, char* argv[])
+{
+    RenderOptions options;
+
+    std::vector<std::string> positionalArgs;
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if(arg == "--threads")
+        {
+            options.numberOfThreads = getIntegerOptionValue(argc, argv, i);
+        }
+        else if(arg == "--checkpoint")
+        {
+            options.checkpoint = true;
+        }
+        else if(arg == "--resume")
+        {
+            // resuming implies that the render keeps being checkpointed
+            options.checkpoint = true;
+            options.resume = true;
+        }
+        else if(arg == "--checkpoint-interval")
+        {
+            options.checkpointInterval = getIntegerOptionValue(argc, argv, i);
+        }
+        else if(arg == "--scene-cache")
+        {
+            options.sceneCache = true;
+        }
+        else if(arg == "--out-of-core")
+        {
+            int megabytes = getIntegerOptionValue(argc, argv, i);
+
+            if(megabytes <= 0)
+                throw std::runtime_error("Error: Geometry budget should be positive.");
+
+            options.outOfCore = true;
+            options.geometryBudget = (size_t)megabytes * 1024 * 1024;
+            options.sceneCache = true;
+        }
+        else if(arg == "--texture-cache")
+        {
+            int megabytes = getIntegerOptionValue(argc, argv, i);
+
+            if(megabytes <= 0)
+                throw std::runtime_error("Error: Texture budget should be positive.");
+
+            options.textureCache = true;
+            options.textureBudget = (size_t)megabytes * 1024 * 1024;
+        }
+        else if(arg == "--region")
+        {
+            options.renderRegion = true;
+            options.region.x0 = getIntegerOptionValue(argc, argv, i);
+            options.region.y0 = getIntegerOptionValue(argc, argv, i);
+            options.region.x1 = getIntegerOptionValue(argc, argv, i);
+            options.region.y1 = getIntegerOptionValue(argc, argv, i);
+
+            if(options.region.isEmpty())
+                throw std::runtime_error("Error: Region should satisfy X0 < X1 and Y0 < Y1.");
+        }
+        else if(arg == "--tiles")
+        {
+            options.renderTiles = true;
+            options.firstTile = getIntegerOptionValue(argc, argv, i);
+            options.lastTile = getIntegerOptionValue(argc, argv, i);
+
+            if(options.firstTile < 0 || options.lastTile < options.firstTile)
+                throw std::runtime_error("Error: Tile range should satisfy 0 <= FIRST <= LAST.");
+        }
+        else if(arg == "--tile-size")
+        {
+            options.tileSize = getIntegerOptionValue(argc, argv, i);
+
+            if(options.tileSize <= 0)
+                throw std::runtime_error("Error: Tile size should be positive.");
+        }
+        else if(arg == "--workers")
+        {
+            options.numberOfWorkers = getIntegerOptionValue(argc, argv, i);
+
+            if(options.numberOfWorkers < 0)
+                throw std::runtime_error("Error: Number of workers cannot be negative.");
+        }
+        else if(arg == "--tile-timeout")
+        {
+            options.tileTimeout = getIntegerOptionValue(argc, argv, i);
+
+            if(options.tileTimeout < 0)
+                throw std::runtime_error("Error: Tile timeout cannot be negative.");
+        }
+        else if(arg == "--worker-fd")
+        {
+            // internal, given by the coordinator to the worker processes
+            options.workerFd = getIntegerOptionValue(argc, argv, i);
+        }
+        else if(arg == "--merge")
+        {
+            options.merge = true;
+        }
+        else if(arg.compare(0, 2, "--") == 0)
+        {
+            throw std::runtime_error("Error: Unknown option " + arg);
+        }
+        else
+        {
+            positionalArgs.push_back(arg);
+        }
+    }
+
+    if(options.merge)
+    {
+        // every positional argument is a partial image
+        options.partialImagePaths = positionalArgs;
+
+        if(options.partialImagePaths.empty())
+            throw std::runtime_error("Error: No partial image is given to merge.");
+
+        return options;
+    }
+
+    if(positionalArgs.empty())
+        throw std::runtime_error("Error: No scene file is given.");
+
+    if(positionalArgs.size() > 1)
+        throw std::runtime_error("Error: More than one scene file is given.");
+
+    if(options.renderRegion && options.renderTiles)
+        throw std::runtime_error("Error: --region and --tiles cannot be used together.");
+
+    // the coordinator splits the images into tiles itself and does not
+    // .. keep a checkpoint of the results
+    if(options.numberOfWorkers > 0 && (options.isPartial() || options.checkpoint))
+        throw std::runtime_error("Error: --workers cannot be used with --region, --tiles or checkpointing.");
+
+    options.sceneFilePath = positionalArgs[0];
+
+    return options;
+}
+
+std::vector<ImageRegion> RenderOptions::getRenderRegions(int imageWidth, int imageHeight) const
+{
+    std::vector<ImageRegion> regions;
+
+    ImageRegion wholeImage(0, 0, imageWidth, imageHeight);
+
+    if(renderRegion)
+    {
+        // clip by the image, since the same region is used for every camera
+        ImageRegion clippedRegion = region.intersect(wholeImage);
+
+        if(!clippedRegion.isEmpty())
+            regions.push_back(clippedRegion);
+    }
+    else if(renderTiles)
+    {
+        int numberOfTiles = ImageRegion::getNumberOfTiles(imageWidth, imageHeight, tileSize);
+
+        for(int i = firstTile; i <= lastTile && i < numberOfTiles; i++)
+            regions.push_back(ImageRegion::getTile(imageWidth, imageHeight, tileSize, i));
+    }
+    else
+    {
+        regions.push_back(wholeImage);
+    }
+
+    return regions;
+}
+
+std::string RenderOptions::getPartialSuffix() const
+{
+    if(renderRegion)
+    {
+        return ".region_" + std::to_string(region.x0) + "_" + std::to_string(region.y0) + "_"
+                          + std::to_string(region.x1) + "_" + std::to_string(region.y1);
+    }
+    else if(renderTiles)
+    {
+        return ".tiles_" + std::to_string(firstTile) + "_" + std::to_string(lastTile)
+                         + "_" + std::to_string(tileSize);
+    }
+
+    return "";
+}
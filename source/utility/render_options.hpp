@@ -0,0 +1,82 @@
+#ifndef __RENDER_OPTIONS_H__
+#define __RENDER_OPTIONS_H__
+
+#include "../config.h"
+#include "image_region.hpp"
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// options given through the command line, which change how the scene is
+// .. rendered but not what is rendered
+struct RenderOptions
+{
+    std::string sceneFilePath;
+
+    unsigned short numberOfThreads = NUM_OF_THREADS;
+
+    // checkpointing: the render state of each camera is written periodically
+    // .. to "<ImageName>" CHECKPOINT_FILE_EXTENSION, resume continues from it
+    bool checkpoint = false;
+    bool resume = false;
+    int checkpointInterval = DEFAULT_CHECKPOINT_INTERVAL; // in seconds
+
+    // the loaded meshes are cached to "<scene.xml>" SCENE_CACHE_FILE_EXTENSION
+    // .. and read from it by the next renders of the same scene
+    bool sceneCache = false;
+
+    // out of core: the meshes are loaded from the scene cache while rendering,
+    // .. once a ray enters them, and the least recently used ones are evicted
+    // .. to keep them within the budget. implies the scene cache
+    bool outOfCore = false;
+    size_t geometryBudget = 0; // in bytes
+
+    // the images of the textures are converted to files of tiles next to them
+    // .. and their tiles are loaded while rendering, once a texel of them is
+    // .. looked up, within the budget. otherwise, the tiles are kept in memory
+    bool textureCache = false;
+    size_t textureBudget = 0; // in bytes
+
+    // partial rendering: only a region or a range of tiles of each image is
+    // .. rendered and written as a partial image, see partial_image.hpp
+    bool renderRegion = false;
+    ImageRegion region;
+
+    bool renderTiles = false;
+    int firstTile = 0, lastTile = 0; // inclusive
+    int tileSize = DEFAULT_TILE_SIZE;
+
+    // merging: no scene is rendered, partial images are merged instead
+    bool merge = false;
+    std::vector<std::string> partialImagePaths;
+
+    // distributed rendering: the tiles of the images are rendered by
+    // .. numberOfWorkers local worker processes, each using numberOfThreads.
+    // .. a worker taking longer than the timeout for a tile is killed and its
+    // .. tile is given to another one, 0 for no timeout
+    int numberOfWorkers = 0;
+    int tileTimeout = 0; // in seconds
+
+    // set for the worker processes only, socket to the coordinator
+    int workerFd = -1;
+
+    bool isPartial() const { return renderRegion || renderTiles; }
+
+    // regions of an image of the given size to be rendered
+    std::vector<ImageRegion> getRenderRegions(int imageWidth, int imageHeight) const;
+
+    // appended to the image name for the files of a partial render
+    std::string getPartialSuffix() const;
+};
+
+// usage: raytracer.out <scene.xml> [--threads N] [--checkpoint] [--resume]
+//                                  [--checkpoint-interval SECONDS]
+//                                  [--scene-cache] [--out-of-core MEGABYTES]
+//                                  [--texture-cache MEGABYTES]
+//                                  [--region X0 Y0 X1 Y1]
+//                                  [--tiles FIRST LAST] [--tile-size N]
+//                                  [--workers N] [--tile-timeout SECONDS]
+//        raytracer.out --merge <partial image>...
+RenderOptions parseRenderOptions(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,94 @@
+#include "render_protocol.hpp"
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <cerrno>
+#include <chrono>
+#include <algorithm>
+
+bool sendAll(int fd, const void * data, size_t size)
+{
+    const char * bytes = static_cast<const char*>(data);
+
+    while(size > 0)
+    {
+        // MSG_NOSIGNAL: a dead peer should not kill this process with SIGPIPE
+        ssize_t sent = send(fd, bytes, size, MSG_NOSIGNAL);
+
+        if(sent < 0 && errno == EINTR)
+            continue;
+
+        if(sent <= 0)
+            return false;
+
+        bytes += sent;
+        size -= sent;
+    }
+
+    return true;
+}
+
+bool receiveAll(int fd, void * data, size_t size, int timeoutSeconds)
+{
+    char * bytes = static_cast<char*>(data);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeoutSeconds);
+
+    while(size > 0)
+    {
+        // wait for the next bytes until the deadline
+        if(timeoutSeconds >= 0)
+        {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+
+            pollfd pollFd;
+            pollFd.fd = fd;
+            pollFd.events = POLLIN;
+            pollFd.revents = 0;
+
+            int ready = poll(&pollFd, 1, std::max((int)remaining.count(), 0));
+
+            if(ready < 0 && errno == EINTR)
+                continue;
+
+            if(ready <= 0)
+                return false;
+        }
+
+        ssize_t received = recv(fd, bytes, size, 0);
+
+        if(received < 0 && errno == EINTR)
+            continue;
+
+        // 0 means the other end is closed
+        if(received <= 0)
+            return false;
+
+        bytes += received;
+        size -= received;
+    }
+
+    return true;
+}
+
+bool sendRenderMessage(int fd, const RenderMessage & message)
+{
+    return sendAll(fd, &message, sizeof(message));
+}
+
+bool receiveRenderMessage(int fd, RenderMessage & message, int timeoutSeconds)
+{
+    return receiveAll(fd, &message, sizeof(message), timeoutSeconds);
+}
+
+bool sendColors(int fd, const std::vector<float> & colors)
+{
+    return sendAll(fd, colors.data(), colors.size() * sizeof(float));
+}
+
+bool receiveColors(int fd, std::vector<float> & colors, int numberOfPixels, int timeoutSeconds)
+{
+    colors.resize(numberOfPixels * 3);
+
+    return receiveAll(fd, colors.data(), colors.size() * sizeof(float), timeoutSeconds);
+}
@@ -0,0 +1,46 @@
+#ifndef __RENDER_PROTOCOL_H__
+#define __RENDER_PROTOCOL_H__
+
+#include "image_region.hpp"
+#include <cstddef>
+#include <vector>
+
+// Messages between the coordinator and the workers of a distributed render.
+// .. They are exchanged over a local stream socket, both ends are the same
+// .. executable, so the structs are sent as they are.
+//
+//  worker      -> coordinator: READY once the scene is loaded
+//  coordinator -> worker:      TILE (camera, region) to be rendered
+//  worker      -> coordinator: RESULT (camera, region) followed by the
+//                              R G B floats of the region, row-major
+//  coordinator -> worker:      QUIT when there is no tile left
+enum class RenderMessageType
+{
+    READY = 1,
+    TILE,
+    RESULT,
+    QUIT
+};
+
+struct RenderMessage
+{
+    RenderMessageType type;
+    int cameraIndex;
+    ImageRegion region;
+};
+
+// all return false if the other end is gone, e.g. the process died. the
+// .. receives also return false if the whole of the data does not arrive
+// .. within timeoutSeconds, e.g. the process hung while sending it, unless
+// .. it is negative
+
+bool sendAll(int fd, const void * data, size_t size);
+bool receiveAll(int fd, void * data, size_t size, int timeoutSeconds = -1);
+
+bool sendRenderMessage(int fd, const RenderMessage & message);
+bool receiveRenderMessage(int fd, RenderMessage & message, int timeoutSeconds = -1);
+
+bool sendColors(int fd, const std::vector<float> & colors);
+bool receiveColors(int fd, std::vector<float> & colors, int numberOfPixels, int timeoutSeconds = -1);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef __RUN_IN_PARALLEL_H__
+#define __RUN_IN_PARALLEL_H__
+
+#include <vector>
+#include <thread>
+#include <exception>
+
+// runs task(i) for each i on a thread of its own, rethrows the first error
+template<class Task>
+void runInParallel(int numberOfTasks, const Task& task)
+{
+    if(numberOfTasks == 1)
+    {
+        task(0);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> errors(numberOfTasks);
+
+    for(int i = 0; i < numberOfTasks; i++)
+    {
+        threads.push_back(std::thread([&task, &errors, i]()
+        {
+            try
+            {
+                task(i);
+            }
+            catch(...)
+            {
+                errors[i] = std::current_exception();
+            }
+        }));
+    }
+
+    for(int i = 0; i < numberOfTasks; i++)
+        threads[i].join();
+
+    for(int i = 0; i < numberOfTasks; i++)
+        if(errors[i])
+            std::rethrow_exception(errors[i]);
+}
+
+#endif
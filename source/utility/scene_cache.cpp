@@ -0,0 +1,310 @@
+#include "scene_cache.hpp"
+#include "../config.h"
+#include <iostream>
+#include <stdexcept>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// file layout: magic, version, number of meshes, key, then per mesh
+// .. number of triangles, number of splits, number of compiled nodes,
+// .. primitives and triangles, and the maximum depth of the compiled
+// .. hiearchy (int32), the minimum and the maximum position of the triangles
+// .. (float), the triangles, the sizes of the left children (int32), the
+// .. compiled nodes, primitives and triangles. every field is 4-byte aligned
+static const char SCENE_CACHE_MAGIC[8] = { 'R', 'T', 'S', 'C', 'N', 'C', '\0', '\0' };
+static const int32_t SCENE_CACHE_VERSION = 3;
+
+// the compiled arrays are read in place, as they are written
+static_assert(std::is_trivially_copyable<CompiledBVH::Node>::value && alignof(CompiledBVH::Node) <= 4, "CompiledBVH::Node is cached");
+static_assert(std::is_trivially_copyable<CompiledBVH::Primitive>::value && alignof(CompiledBVH::Primitive) <= 4, "CompiledBVH::Primitive is cached");
+static_assert(std::is_trivially_copyable<CompiledTriangle>::value && alignof(CompiledTriangle) <= 4, "CompiledTriangle is cached");
+
+struct SceneCacheHeader
+{
+    char magic[8];
+    int32_t version;
+    int32_t numberOfMeshes;
+    uint64_t key;
+};
+
+// 64-bit FNV-1a
+static void hashBytes(uint64_t & hash, const void* bytes, size_t size)
+{
+    const unsigned char* data = static_cast<const unsigned char*>(bytes);
+
+    for(size_t i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= 0x100000001B3ULL;
+    }
+}
+
+template<class T>
+static void hashValue(uint64_t & hash, const T & value)
+{
+    hashBytes(hash, &value, sizeof(T));
+}
+
+uint64_t SceneCache::computeKey(const std::string& sceneFilePath, const std::vector<std::string>& referencedFilePaths)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    hashValue(hash, SCENE_CACHE_VERSION);
+
+    // the hiearchies are partitioned differently by the division methods
+    #ifdef __BVH_DIVISION_BY_GEOMETRIC_CENTER__
+    hashValue(hash, 1);
+    #else
+    hashValue(hash, 0);
+    #endif
+
+    // the whole scene file, since a change of a mesh in it may be of a few
+    // .. characters without changing its size
+    {
+        std::ifstream sceneStream(sceneFilePath.data(), std::ifstream::binary);
+        char buffer[1 << 16];
+
+        while(sceneStream.read(buffer, sizeof(buffer)) || sceneStream.gcount() > 0)
+            hashBytes(hash, buffer, sceneStream.gcount());
+    }
+
+    // the referenced files are large, they are identified by their metadata
+    for(int i = 0; i < (int)referencedFilePaths.size(); i++)
+    {
+        const std::string & path = referencedFilePaths[i];
+        struct stat fileStat;
+
+        hashBytes(hash, path.data(), path.size() + 1);
+
+        if(stat(path.data(), &fileStat) == 0)
+        {
+            hashValue(hash, (int64_t)fileStat.st_size);
+            hashValue(hash, (int64_t)fileStat.st_mtim.tv_sec);
+            hashValue(hash, (int64_t)fileStat.st_mtim.tv_nsec);
+        }
+    }
+
+    return hash;
+}
+
+SceneCache::~SceneCache()
+{
+    unmap();
+
+    // an incomplete cache is not renamed over the previous one
+    if(isWriting())
+    {
+        stream.close();
+        std::remove(tmpFilePath.data());
+    }
+}
+
+bool SceneCache::open(const std::string& sceneFilePath, uint64_t key)
+{
+    if(openForReading(sceneFilePath, key))
+        return true;
+
+    // write the cache while the meshes are loaded
+    SceneCacheHeader header;
+    std::memcpy(header.magic, SCENE_CACHE_MAGIC, sizeof(header.magic));
+    header.version = SCENE_CACHE_VERSION;
+    header.numberOfMeshes = 0; // set when it is completed
+    header.key = key;
+
+    tmpFilePath = filePath + ".tmp." + std::to_string(getpid());
+
+    stream.open(tmpFilePath.data(), std::ofstream::binary | std::ofstream::trunc);
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    if(!stream)
+    {
+        std::cerr << "Warning: Scene cache " << filePath << " could not be written." << std::endl;
+        stream.close();
+        std::remove(tmpFilePath.data());
+    }
+
+    numberOfWrittenMeshes = 0;
+
+    return false;
+}
+
+bool SceneCache::openForReading(const std::string& sceneFilePath, uint64_t key, MappedFile::Access access)
+{
+    this->filePath = sceneFilePath + SCENE_CACHE_FILE_EXTENSION;
+    this->key = key;
+
+    return map(access);
+}
+
+// points the array to the count elements at the offset of the mapping, and
+// .. moves the offset after them. returns false unless they are within it
+template<class T>
+static bool placeArray(const char* data, size_t mappingSize, size_t & offset, int32_t count, const T* & array)
+{
+    if(count < 0 || (mappingSize - offset) / sizeof(T) < (size_t)count)
+        return false;
+
+    array = reinterpret_cast<const T*>(data + offset);
+    offset += count * sizeof(T);
+
+    return true;
+}
+
+bool SceneCache::map(MappedFile::Access access)
+{
+    if(!mappedFile.open(filePath, access))
+        return false;
+
+    const char* data = mappedFile.getData();
+    size_t mappingSize = mappedFile.getSize();
+
+    if(mappingSize < sizeof(SceneCacheHeader))
+    {
+        unmap();
+        return false;
+    }
+
+    const SceneCacheHeader* header = reinterpret_cast<const SceneCacheHeader*>(data);
+
+    if(std::memcmp(header->magic, SCENE_CACHE_MAGIC, sizeof(header->magic)) ||
+       header->version != SCENE_CACHE_VERSION || header->key != key || header->numberOfMeshes < 0)
+    {
+        unmap();
+        return false;
+    }
+
+    // index the meshes, the cache is broken unless they fill the file exactly
+    size_t offset = sizeof(SceneCacheHeader);
+    bool isBroken = false;
+
+    meshes.resize(header->numberOfMeshes);
+
+    for(int i = 0; i < header->numberOfMeshes && !isBroken; i++)
+    {
+        Mesh & mesh = meshes[i];
+        int32_t counts[6];
+
+        if(mappingSize - offset < sizeof(counts) + sizeof(mesh.minPosition) + sizeof(mesh.maxPosition))
+        {
+            isBroken = true;
+            break;
+        }
+
+        std::memcpy(counts, data + offset, sizeof(counts));
+        offset += sizeof(counts);
+
+        std::memcpy(mesh.minPosition, data + offset, sizeof(mesh.minPosition));
+        offset += sizeof(mesh.minPosition);
+        std::memcpy(mesh.maxPosition, data + offset, sizeof(mesh.maxPosition));
+        offset += sizeof(mesh.maxPosition);
+
+        mesh.numberOfTriangles = counts[0];
+        mesh.numberOfSplits = counts[1];
+        mesh.compiled.numberOfNodes = counts[2];
+        mesh.compiled.numberOfPrimitives = counts[3];
+        mesh.compiled.numberOfTriangles = counts[4];
+        mesh.compiled.maxDepth = counts[5];
+
+        isBroken =
+            mesh.compiled.numberOfTriangles != mesh.compiled.numberOfPrimitives || mesh.compiled.maxDepth < 0 ||
+            !placeArray(data, mappingSize, offset, mesh.numberOfTriangles, mesh.triangles) ||
+            !placeArray(data, mappingSize, offset, mesh.numberOfSplits, mesh.leftSizes) ||
+            !placeArray(data, mappingSize, offset, mesh.compiled.numberOfNodes, mesh.compiled.nodes) ||
+            !placeArray(data, mappingSize, offset, mesh.compiled.numberOfPrimitives, mesh.compiled.primitives) ||
+            !placeArray(data, mappingSize, offset, mesh.compiled.numberOfTriangles, mesh.compiled.triangles);
+    }
+
+    if(!isBroken && offset == mappingSize)
+        return true;
+
+    std::cerr << "Warning: Scene cache " << filePath << " is broken, it is written again." << std::endl;
+
+    unmap();
+    return false;
+}
+
+void SceneCache::unmap()
+{
+    mappedFile.close();
+
+    meshes.clear();
+    nextMesh = 0;
+}
+
+const SceneCache::Mesh& SceneCache::readMesh()
+{
+    if(nextMesh >= (int)meshes.size())
+        throw std::runtime_error("Error: Scene cache " + filePath + " has fewer meshes than the scene.");
+
+    return meshes[nextMesh++];
+}
+
+void SceneCache::writeMesh(
+    const std::vector<Triangle>& triangles, const std::vector<int32_t>& leftSizes,
+    const float minPosition[3], const float maxPosition[3],
+    const CompiledBVH::MeshArrays& compiled
+)
+{
+    if(!isWriting())
+        return;
+
+    int32_t counts[6] = {
+        (int32_t)triangles.size(), (int32_t)leftSizes.size(),
+        compiled.numberOfNodes, compiled.numberOfPrimitives, compiled.numberOfTriangles, compiled.maxDepth
+    };
+
+    stream.write(reinterpret_cast<const char*>(counts), sizeof(counts));
+    stream.write(reinterpret_cast<const char*>(minPosition), 3 * sizeof(float));
+    stream.write(reinterpret_cast<const char*>(maxPosition), 3 * sizeof(float));
+    stream.write(reinterpret_cast<const char*>(triangles.data()), triangles.size() * sizeof(Triangle));
+    stream.write(reinterpret_cast<const char*>(leftSizes.data()), leftSizes.size() * sizeof(int32_t));
+    stream.write(reinterpret_cast<const char*>(compiled.nodes), compiled.numberOfNodes * sizeof(CompiledBVH::Node));
+    stream.write(reinterpret_cast<const char*>(compiled.primitives), compiled.numberOfPrimitives * sizeof(CompiledBVH::Primitive));
+    stream.write(reinterpret_cast<const char*>(compiled.triangles), compiled.numberOfTriangles * sizeof(CompiledTriangle));
+
+    numberOfWrittenMeshes++;
+}
+
+void SceneCache::releaseCompiledMesh(int index) const
+{
+    const CompiledBVH::MeshArrays & compiled = meshes[index].compiled;
+
+    // the arrays are one after another
+    const char* begin = reinterpret_cast<const char*>(compiled.nodes);
+    const char* end = reinterpret_cast<const char*>(compiled.triangles + compiled.numberOfTriangles);
+
+    mappedFile.release(begin, end - begin);
+}
+
+void SceneCache::close()
+{
+    if(isReading())
+    {
+        if(nextMesh != (int)meshes.size())
+            std::cerr << "Warning: Scene cache " << filePath << " has more meshes than the scene." << std::endl;
+
+        unmap();
+    }
+
+    if(!isWriting())
+        return;
+
+    int32_t numberOfMeshes = numberOfWrittenMeshes;
+
+    stream.seekp(offsetof(SceneCacheHeader, numberOfMeshes));
+    stream.write(reinterpret_cast<const char*>(&numberOfMeshes), sizeof(numberOfMeshes));
+    stream.flush();
+
+    bool isWritten = (bool)stream;
+    stream.close();
+
+    // the previous cache, if any, is replaced at once
+    if(!isWritten || std::rename(tmpFilePath.data(), filePath.data()) != 0)
+    {
+        std::cerr << "Warning: Scene cache " << filePath << " could not be written." << std::endl;
+        std::remove(tmpFilePath.data());
+    }
+}
@@ -0,0 +1,130 @@
+#ifndef __SCENE_CACHE_H__
+#define __SCENE_CACHE_H__
+
+#include "mapped_file.hpp"
+#include "../geometry/headers/compiled_bvh.hpp"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+
+// Cache of the loaded meshes of a scene, written next to the scene file as
+// .. "<scene.xml>" SCENE_CACHE_FILE_EXTENSION.
+//
+// A mesh is cached as its triangles after the smooth normals are computed and
+// .. the transformation is baked, in the order they are in the leaves of its
+// .. bounding volume hiearchy, and the sizes of the left children of its
+// .. bounding volumes. Therefore, a cached mesh is loaded without reading the
+// .. faces, the ply or binary files, or partitioning the triangles again, and
+// .. it is exactly the mesh that would be loaded otherwise.
+//
+// The compiled hiearchy of a mesh is cached as well, as its mesh arrays, see
+// .. CompiledBVH. A mesh loaded out of core is rendered from them in place,
+// .. without creating its triangles or its hiearchy, see GeometryCache.
+//
+// The cache is valid for the scene file, the files it refers to and the
+// .. version of the cache it was written from, see computeKey(). It is mapped
+// .. to the memory while the scene is loaded and the meshes are read in place.
+// .. The materials, the textures and the shapes other than the meshes are
+// .. loaded from the scene file in every render.
+class SceneCache
+{
+    public:
+        struct Triangle
+        {
+            float positions[3][3];
+            float normals[3][3];
+            float texCoords[3][2];
+        };
+
+        // a mesh as it is in the mapped file
+        struct Mesh
+        {
+            int numberOfTriangles;
+            const Triangle* triangles;
+
+            // bounds of the triangles, so that a mesh loaded out of core is
+            // .. placed without reading them, see GeometryCache
+            float minPosition[3];
+            float maxPosition[3];
+
+            // sizes of the left children of the bounding volumes, in preorder
+            int numberOfSplits;
+            const int32_t* leftSizes;
+
+            // of the compiled hiearchy of the mesh
+            CompiledBVH::MeshArrays compiled;
+        };
+
+    private:
+        std::string filePath;
+        uint64_t key;
+
+        // reading
+        MappedFile mappedFile;
+        std::vector<Mesh> meshes;
+        int nextMesh = 0;
+
+        // writing, to a temporary file renamed over the cache when done. its
+        // .. name has the process id, so that the processes rendering the
+        // .. same scene, e.g. the regions of a frame, do not write to the
+        // .. same one
+        std::string tmpFilePath;
+        std::ofstream stream;
+        int numberOfWrittenMeshes = 0;
+
+        // maps the cache and indexes its meshes, returns false if it is
+        // .. missing, broken or of other inputs
+        bool map(MappedFile::Access access);
+        void unmap();
+
+    public:
+        SceneCache() = default;
+        SceneCache(const SceneCache&) = delete;
+        SceneCache& operator=(const SceneCache&) = delete;
+        ~SceneCache();
+
+        // the key of the scene file and the files it refers to, by their
+        // .. paths, sizes and modification times
+        static uint64_t computeKey(const std::string& sceneFilePath, const std::vector<std::string>& referencedFilePaths);
+
+        // opens the cache of the scene. returns true if it is valid and the
+        // .. meshes are to be read from it, otherwise they are to be written
+        bool open(const std::string& sceneFilePath, uint64_t key);
+
+        // opens the cache of the scene only to read it, returns false unless
+        // .. it is valid. the meshes are read in any order if they are read by
+        // .. index, e.g. by a GeometryCache
+        bool openForReading(const std::string& sceneFilePath, uint64_t key, MappedFile::Access access = MappedFile::SEQUENTIAL);
+
+        bool isReading() const { return this->mappedFile.isOpen(); }
+        bool isWriting() const { return this->stream.is_open(); }
+
+        // the next mesh, in the order they are written
+        const Mesh& readMesh();
+
+        // any of the meshes, e.g. the one a ray enters while rendering
+        const Mesh& getMesh(int index) const { return this->meshes[index]; }
+
+        // compiled is of the hiearchy of the triangles, see
+        // .. CompiledBVH::isTriangleMesh()
+        void writeMesh(
+            const std::vector<Triangle>& triangles, const std::vector<int32_t>& leftSizes,
+            const float minPosition[3], const float maxPosition[3],
+            const CompiledBVH::MeshArrays& compiled
+        );
+
+        // drops the compiled hiearchy of a mesh from the memory of the
+        // .. process, it is read from the file again if it is read again
+        void releaseCompiledMesh(int index) const;
+
+        // unmaps the cache, or completes writing it
+        void close();
+
+        int getNumberOfMeshes() const { return this->isReading() ? this->meshes.size() : this->numberOfWrittenMeshes; }
+        const std::string& getFilePath() const { return this->filePath; }
+        uint64_t getKey() const { return this->key; }
+};
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef __SHADING_MATH_H__
+#define __SHADING_MATH_H__
+
+#include "../config.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Math of the hot shading and sampling paths.
+//
+// The integer powers are products and the trigonometric round trips are
+// .. replaced by identities, e.g. sin(acos(x)) = sqrt(1 - x^2), in any case.
+// The remaining pow, exp, sin and cos calls are the standard functions, unless
+// .. __FAST_SHADING_MATH__ is defined (see config.h), in which case they are
+// .. polynomial approximations:
+//  - log2, exp2: relative error below 1e-6, of log2 relative to max(1, |log2|)
+//  - pow: exact up to the rounding of the products for the integer exponents,
+// ..   otherwise the relative error grows with the exponent, below 2e-5 for
+// ..   the exponents up to 200 and the bases in [0, 1]
+//  - exp: relative error below 1e-5 in [-80, 80]
+//  - sin, cos: absolute error below 1e-6 for the angles in [-4pi, 4pi]
+// The bounds are checked by "make test-shading-math", see
+// .. tests/shading_math_test.cpp.
+
+inline float square(float x)
+{
+    return x * x;
+}
+
+inline float powFive(float x)
+{
+    float xSq = x * x;
+
+    return xSq * xSq * x;
+}
+
+// log2 of a positive finite x
+inline float fastLog2(float x)
+{
+    // x = m * 2^e, where m is in [sqrt(1/2), sqrt(2))
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(float));
+
+    int e = (int)((bits >> 23) & 0xFF) - 127;
+    bits = (bits & 0x007FFFFF) | 0x3F800000;
+
+    float m;
+    std::memcpy(&m, &bits, sizeof(float));
+
+    if(m > 1.41421356f)
+    {
+        m *= 0.5f;
+        e++;
+    }
+
+    // log2(m) = 2 / ln2 * atanh(t), t = (m - 1) / (m + 1) is in [-0.172, 0.172]
+    float t = (m - 1.f) / (m + 1.f);
+    float tSq = t * t;
+
+    float log2m = t * (2.88539008f + tSq * (0.961796694f + tSq * (0.577078016f + tSq * 0.412198583f)));
+
+    return e + log2m;
+}
+
+inline float fastExp2(float x)
+{
+    if(x < -126.f)
+        return 0.f;
+
+    if(x > 127.f)
+        return INFINITY;
+
+    // x = i + f, where f is in [-0.5, 0.5]
+    float i = std::floor(x + 0.5f);
+    float y = (x - i) * 0.693147181f;
+
+    // e^y, y is in [-0.347, 0.347]
+    float expY = 1.f + y * (1.f + y * (0.5f + y * (0.166666667f + y * (0.0416666667f + y * (0.00833333333f + y * 0.00138888889f)))));
+
+    uint32_t bits = (uint32_t)((int)i + 127) << 23;
+
+    float twoPowI;
+    std::memcpy(&twoPowI, &bits, sizeof(float));
+
+    return expY * twoPowI;
+}
+
+inline void fastSinCos(float angle, float& sine, float& cosine)
+{
+    auto sinOfReduced = [](float x)
+    {
+        // x in [-pi, pi], then folded to [-pi / 2, pi / 2] by sin(pi - x) = sin(x)
+        if(x > 1.57079633f)
+            x = 3.14159265f - x;
+        else if(x < -1.57079633f)
+            x = -3.14159265f - x;
+
+        float xSq = x * x;
+
+        return x * (1.f + xSq * (-0.166666667f + xSq * (0.00833333333f + xSq * (-1.98412698e-4f + xSq * (2.75573192e-6f + xSq * -2.50521084e-8f)))));
+    };
+
+    // reduce to [-pi, pi]
+    float turns = std::floor(angle * 0.159154943f + 0.5f);
+    float reduced = angle - turns * 6.28318531f;
+
+    sine = sinOfReduced(reduced);
+
+    // cos(x) = sin(x + pi / 2)
+    float shifted = reduced + 1.57079633f;
+    cosine = sinOfReduced(shifted > 3.14159265f ? shifted - 6.28318531f : shifted);
+}
+
+// x raised to the exponent, e.g. a phong exponent
+inline float shadingPow(float x, float exponent)
+{
+#ifdef __FAST_SHADING_MATH__
+    // the integer exponents by repeated squaring, which is defined for the
+    // .. negative bases as well
+    if(exponent >= 0.f && exponent <= 1024.f && exponent == (float)(int)exponent)
+    {
+        int n = (int)exponent;
+        float result = 1.f;
+
+        while(n > 0)
+        {
+            if(n & 1)
+                result *= x;
+
+            x *= x;
+            n >>= 1;
+        }
+
+        return result;
+    }
+
+    if(x <= 0.f)
+        return x == 0.f ? (exponent > 0.f ? 0.f : INFINITY) : NAN;
+
+    return fastExp2(exponent * fastLog2(x));
+#else
+    return std::pow(x, exponent);
+#endif
+}
+
+inline float shadingExp(float x)
+{
+#ifdef __FAST_SHADING_MATH__
+    return fastExp2(x * 1.44269504f);
+#else
+    return std::exp(x);
+#endif
+}
+
+inline void shadingSinCos(float angle, float& sine, float& cosine)
+{
+#ifdef __FAST_SHADING_MATH__
+    fastSinCos(angle, sine, cosine);
+#else
+    sine = std::sin(angle);
+    cosine = std::cos(angle);
+#endif
+}
+
+#endif
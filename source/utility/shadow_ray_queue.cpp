@@ -0,0 +1,51 @@
+#include "shadow_ray_queue.hpp"
+
+void ShadowRayQueue::push(const IncidentLight& incidentLight, const Color& contribution)
+{
+    ShadowRay shadowRay;
+
+    shadowRay.ray = incidentLight.getShadowRay();
+    shadowRay.maxT = incidentLight.shadowRayMaxT;
+    shadowRay.backfaceCulling = incidentLight.shadowRayBackfaceCulling;
+    shadowRay.contribution = contribution;
+    shadowRay.contribution.intensify(this->weight);
+    shadowRay.target = this->target;
+
+    shadowRays.push_back(shadowRay);
+}
+
+void ShadowRayQueue::trace(const CompiledBVH& BVH, std::vector<Color>& targets)
+{
+    if(shadowRays.empty())
+        return;
+
+    // bounds of the origins
+    Position3 minPosition = shadowRays[0].ray.getOrigin();
+    Position3 maxPosition = minPosition;
+
+    for(int i = 1; i < (int)shadowRays.size(); i++)
+    {
+        minPosition = Position3::generateMinPosition(minPosition, shadowRays[i].ray.getOrigin());
+        maxPosition = Position3::generateMaxPosition(maxPosition, shadowRays[i].ray.getOrigin());
+    }
+
+    raySorter.setBounds(minPosition, maxPosition);
+
+    // sort keys: octant of the direction, then the Morton code of the origin
+    raySorter.resize(shadowRays.size());
+
+    for(int i = 0; i < (int)shadowRays.size(); i++)
+        raySorter.setRayKey(i, shadowRays[i].ray);
+
+    const std::vector<int> & order = raySorter.sort();
+
+    for(int i = 0; i < (int)order.size(); i++)
+    {
+        const ShadowRay & shadowRay = shadowRays[order[i]];
+
+        if(!BVH.isOccluding(shadowRay.ray, shadowRay.maxT, shadowRay.backfaceCulling))
+            targets[shadowRay.target] += shadowRay.contribution;
+    }
+
+    shadowRays.clear();
+}
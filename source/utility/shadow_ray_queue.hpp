@@ -0,0 +1,52 @@
+#ifndef __SHADOW_RAY_QUEUE_H__
+#define __SHADOW_RAY_QUEUE_H__
+
+#include "../geometry/headers/light.hpp"
+#include "../geometry/headers/ray.hpp"
+#include "../geometry/headers/compiled_bvh.hpp"
+#include "../image/color.hpp"
+#include "ray_sorter.hpp"
+#include <vector>
+
+// Shadow rays deferred by the shading of a thread, traced together.
+//
+// Each ray carries the light it would bring to its target, e.g. a pixel, if it
+// .. is not occluded. The rays are traced sorted by the octant of their direction
+// .. and the Morton code of their origin, see RaySorter.
+class ShadowRayQueue
+{
+    private:
+        struct ShadowRay
+        {
+            Ray ray;
+            float maxT;
+            bool backfaceCulling;
+
+            Color contribution;
+            int target;
+        };
+
+        std::vector<ShadowRay> shadowRays;
+
+        RaySorter raySorter;
+
+        // target and weight of the rays pushed next
+        int target = 0;
+        float weight = 1.f;
+
+    public:
+        void setTarget(int target, float weight) { this->target = target; this->weight = weight; }
+
+        // queues the shadow ray of the incident light, contribution is the light
+        // .. it brings unless it is in shadow
+        void push(const IncidentLight& incidentLight, const Color& contribution);
+
+        int getSize() const { return this->shadowRays.size(); }
+        bool isEmpty() const { return this->shadowRays.empty(); }
+
+        // traces the rays, adds the contributions of the unoccluded ones to their
+        // .. targets and empties the queue
+        void trace(const CompiledBVH& BVH, std::vector<Color>& targets);
+};
+
+#endif
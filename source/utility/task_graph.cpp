@@ -0,0 +1,243 @@
+#include "task_graph.hpp"
+#include <iomanip>
+#include <algorithm>
+
+TaskGraph::TaskGraph(int numberOfThreads)
+{
+    for(int i = 0; i < numberOfThreads; i++)
+        threads.push_back(std::thread(&TaskGraph::work, this));
+}
+
+TaskGraph::~TaskGraph()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        isStopping = true;
+        readyTasks.clear();
+    }
+
+    taskReady.notify_all();
+
+    for(int i = 0; i < (int)threads.size(); i++)
+        threads[i].join();
+}
+
+void TaskGraph::work()
+{
+    while(true)
+    {
+        TaskId id;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskReady.wait(lock, [this]() { return isStopping || !readyTasks.empty(); });
+
+            if(isStopping)
+                return;
+
+            id = readyTasks.front();
+            readyTasks.pop_front();
+        }
+
+        run(id);
+    }
+}
+
+void TaskGraph::run(TaskId id)
+{
+    std::function<void()> function;
+    std::exception_ptr error;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        function = std::move(tasks[id].function);
+        error = tasks[id].error;
+    }
+
+    bool isRun = !error;
+    Clock::time_point start = Clock::now();
+
+    if(isRun)
+    {
+        try
+        {
+            function();
+        }
+        catch(...)
+        {
+            error = std::current_exception();
+        }
+    }
+
+    Clock::time_point end = Clock::now();
+
+    // the captures of the task are released before its dependents are run
+    function = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        Task& task = tasks[id];
+        task.isDone = true;
+        task.error = error;
+        numberOfDoneTasks++;
+
+        if(isRun)
+            recordStageTime(task.stage, start, end);
+
+        for(int i = 0; i < (int)task.dependents.size(); i++)
+        {
+            Task& dependent = tasks[task.dependents[i]];
+
+            if(error && !dependent.error)
+                dependent.error = error;
+
+            if(--dependent.numberOfPendingDependencies == 0)
+                readyTasks.push_back(task.dependents[i]);
+        }
+    }
+
+    taskReady.notify_all();
+    taskDone.notify_all();
+}
+
+TaskGraph::TaskId TaskGraph::add(const std::string& stage, std::function<void()> function, const std::vector<TaskId>& dependencies)
+{
+    TaskId id;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        id = tasks.size();
+        tasks.push_back(Task());
+
+        Task& task = tasks.back();
+        task.stage = getStage(stage);
+        task.function = std::move(function);
+
+        for(int i = 0; i < (int)dependencies.size(); i++)
+        {
+            Task& dependency = tasks[dependencies[i]];
+
+            if(!dependency.isDone)
+            {
+                task.numberOfPendingDependencies++;
+                dependency.dependents.push_back(id);
+            }
+            else if(dependency.error && !task.error)
+            {
+                task.error = dependency.error;
+            }
+        }
+
+        if(task.numberOfPendingDependencies > 0)
+            return id;
+
+        if(!threads.empty())
+        {
+            readyTasks.push_back(id);
+            taskReady.notify_one();
+
+            return id;
+        }
+    }
+
+    // without threads, the dependencies are done already
+    run(id);
+
+    return id;
+}
+
+void TaskGraph::wait(TaskId id)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    taskDone.wait(lock, [this, id]() { return tasks[id].isDone; });
+
+    if(tasks[id].error)
+        std::rethrow_exception(tasks[id].error);
+}
+
+void TaskGraph::wait(const std::vector<TaskId>& ids)
+{
+    for(int i = 0; i < (int)ids.size(); i++)
+        wait(ids[i]);
+}
+
+void TaskGraph::waitAll()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    taskDone.wait(lock, [this]() { return numberOfDoneTasks == (int)tasks.size(); });
+
+    for(int i = 0; i < (int)tasks.size(); i++)
+        if(tasks[i].error)
+            std::rethrow_exception(tasks[i].error);
+}
+
+int TaskGraph::getStage(const std::string& name)
+{
+    for(int i = 0; i < (int)stageTimes.size(); i++)
+        if(stageTimes[i].name == name)
+            return i;
+
+    stageTimes.push_back(StageTime());
+    stageTimes.back().name = name;
+
+    return stageTimes.size() - 1;
+}
+
+void TaskGraph::recordStageTime(int stage, Clock::time_point start, Clock::time_point end)
+{
+    StageTime& stageTime = stageTimes[stage];
+
+    if(stageTime.numberOfTasks == 0)
+    {
+        stageTime.start = start;
+        stageTime.end = end;
+    }
+    else
+    {
+        stageTime.start = std::min(stageTime.start, start);
+        stageTime.end = std::max(stageTime.end, end);
+    }
+
+    stageTime.numberOfTasks++;
+    stageTime.busySeconds += std::chrono::duration<double>(end - start).count();
+}
+
+void TaskGraph::addStageTime(const std::string& stage, Clock::time_point start)
+{
+    Clock::time_point end = Clock::now();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    recordStageTime(getStage(stage), start, end);
+}
+
+void TaskGraph::printStageTimes(std::ostream& stream)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::streamsize precision = stream.precision();
+
+    // in the order they are started
+    std::vector<StageTime> sortedStageTimes(stageTimes);
+    std::stable_sort(sortedStageTimes.begin(), sortedStageTimes.end(), [](const StageTime& a, const StageTime& b) { return a.start < b.start; });
+
+    for(int i = 0; i < (int)sortedStageTimes.size(); i++)
+    {
+        const StageTime& stageTime = sortedStageTimes[i];
+
+        if(stageTime.numberOfTasks == 0)
+            continue;
+
+        stream << "    " << std::left << std::setw(20) << stageTime.name << std::right
+               << std::setw(6) << stageTime.numberOfTasks << (stageTime.numberOfTasks == 1 ? " task " : " tasks")
+               << std::fixed << std::setprecision(3)
+               << std::setw(10) << stageTime.busySeconds << " s busy"
+               << std::setw(10) << std::chrono::duration<double>(stageTime.end - stageTime.start).count() << " s wall"
+               << std::defaultfloat << std::endl;
+    }
+
+    stream.precision(precision);
+}
@@ -0,0 +1,95 @@
+#ifndef __TASK_GRAPH_H__
+#define __TASK_GRAPH_H__
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <exception>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <ostream>
+
+// Tasks run by a pool of threads, each once the tasks it depends on are done.
+//
+// A task that throws does not stop the others, its error is rethrown by the
+// .. waits for it, and the tasks depending on it are not run but fail with
+// .. the same error. Without threads, a task is run as soon as it is added.
+//
+// The time of each stage, i.e. of the tasks added with the same stage name,
+// .. is recorded: the number of its tasks, the time they are run for in total
+// .. and the time from the start of its first task to the end of its last.
+// .. A stage run by the caller itself is recorded by addStageTime().
+class TaskGraph
+{
+    public:
+        typedef int TaskId;
+        typedef std::chrono::steady_clock Clock;
+
+    private:
+        struct Task
+        {
+            int stage;
+            std::function<void()> function;
+
+            int numberOfPendingDependencies = 0;
+            std::vector<TaskId> dependents;
+
+            bool isDone = false;
+            std::exception_ptr error;
+        };
+
+        struct StageTime
+        {
+            std::string name;
+            int numberOfTasks = 0;
+            double busySeconds = 0;
+            Clock::time_point start, end;
+        };
+
+        std::vector<std::thread> threads;
+
+        // a deque, so that the tasks are not moved when one is added
+        std::deque<Task> tasks;
+        std::deque<TaskId> readyTasks;
+        std::vector<StageTime> stageTimes;
+        int numberOfDoneTasks = 0;
+
+        std::mutex mutex;
+        std::condition_variable taskReady, taskDone;
+        bool isStopping = false;
+
+        void work();
+
+        // runs the task unless one of its dependencies failed, then marks it
+        // .. done and readies its dependents. called without the lock
+        void run(TaskId id);
+
+        int getStage(const std::string& name);
+        void recordStageTime(int stage, Clock::time_point start, Clock::time_point end);
+
+    public:
+        explicit TaskGraph(int numberOfThreads);
+        TaskGraph(const TaskGraph&) = delete;
+        TaskGraph& operator=(const TaskGraph&) = delete;
+
+        // the tasks that are not started yet are dropped, the running ones
+        // .. are waited for
+        ~TaskGraph();
+
+        TaskId add(const std::string& stage, std::function<void()> function, const std::vector<TaskId>& dependencies = std::vector<TaskId>());
+
+        // rethrow the error of the task, or the first one of the tasks
+        void wait(TaskId id);
+        void wait(const std::vector<TaskId>& ids);
+        void waitAll();
+
+        // records a stage run by the caller, from start to now
+        void addStageTime(const std::string& stage, Clock::time_point start);
+
+        void printStageTimes(std::ostream& stream);
+};
+
+#endif